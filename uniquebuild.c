@@ -1,4 +1,5 @@
 #include <stdio.h>
+#define UNIQUEBUILD_IMPLEMENTATION
 #include "uniquebuild.h"
 
 // Function to calculate the factorial of a number as unsigned long long
@@ -1,17 +1,8 @@
 #include <iostream> // Needed for printArray and std::cout
 #include <string>   // Needed for std::string printing
+#define UNIQUEBUILD_IMPLEMENTATION
 #include "uniquebuild.h"
 
-// Print function for std::string
-void print(const std::string& str) {
-    std::cout << str << std::endl;
-}
-
-// Print function for int
-void print(int value) {
-    std::cout << value << std::endl;
-}
-
 // Function to calculate the factorial of a number as unsigned long long
 unsigned long long factorial_ull(int n) {
     if (n < 0) {
@@ -0,0 +1,504 @@
+/***************************************
+ * uniquebuild_config.h
+ * Key/value configuration files (CONFIG_FILE_PATH by default), parsed
+ * into a flat hash table and cached as a binary snapshot that later
+ * starts map directly.
+ *
+ * Part of uniquebuild; see uniquebuild.h.
+ ***************************************/
+
+#ifndef UNIQUEBUILD_CONFIG_H
+#define UNIQUEBUILD_CONFIG_H
+
+#include "uniquebuild_core.h"
+#include "uniquebuild_strings.h"
+#include "uniquebuild_fs.h"
+#include "uniquebuild_hash.h"
+
+#include <cctype>       // Required for std::tolower
+
+/***************************************
+ * SECTION: Config Files
+ * Format: one "key = value" per line. Whitespace around keys and values
+ * is ignored, lines starting with '#' or ';' are comments, and a
+ * "[section]" line prefixes the keys after it with "section.". A value
+ * wrapped in double quotes keeps its inner text verbatim, including
+ * leading or trailing blanks. A later duplicate key replaces the earlier
+ * value.
+ *
+ * The parsed table is one contiguous image: a header, an open-addressing
+ * slot array, fixed-size entries and a string block, with no allocation
+ * per entry. The same image is the snapshot file, written next to the
+ * user's cache and keyed by the source's mtime, size and hash64. A start
+ * whose source mtime and size match just maps the snapshot; one whose
+ * mtime changed but content did not only hashes the source.
+ ***************************************/
+
+/**
+ * CONFIG_SNAPSHOT_VERSION: Version of the snapshot layout; snapshots
+ * of other versions are ignored and rewritten.
+ */
+#define CONFIG_SNAPSHOT_VERSION 1
+
+/**
+ * CONFIG_SNAPSHOT_DIRECTORY: Directory under the user's cache
+ * ($XDG_CACHE_HOME, else $HOME/.cache) that holds snapshots.
+ */
+#define CONFIG_SNAPSHOT_DIRECTORY "uniquebuild"
+
+namespace UniqueBuild {
+
+/**
+ * @namespace Config
+ * ConfigFile and its snapshot format.
+ */
+namespace Config {
+
+namespace detail {
+
+/**
+ * @struct SnapshotHeader
+ * First 64 bytes of an image. Snapshots are a per-machine cache and use
+ * the native byte order; a foreign one fails the magic check.
+ */
+struct SnapshotHeader {
+    char magic[8];  // "UBCONFIG"
+    uint32_t version;  // CONFIG_SNAPSHOT_VERSION
+    uint32_t entryCount;  // Number of entries
+    uint32_t slotCount;  // Hash slots; a power of two
+    uint32_t stringsSize;  // Bytes of the string block
+    int64_t sourceMtimeNs;  // Source modification time when parsed
+    uint64_t sourceSize;  // Source size in bytes
+    uint64_t sourceHash;  // hash64 of the source
+    uint64_t bodyHash;  // hash64 of everything after the header
+    uint64_t headerHash;  // hash64 of the header bytes before this field
+};
+
+static_assert(sizeof(SnapshotHeader) == 64, "SnapshotHeader must stay 64 bytes");
+
+/**
+ * @struct Entry
+ * One key/value pair; offsets are into the string block.
+ */
+struct Entry {
+    uint64_t hash;  // hash64 of the key
+    uint32_t keyOffset;  // Start of the key
+    uint32_t keyLength;  // Key length
+    uint32_t valueOffset;  // Start of the value
+    uint32_t valueLength;  // Value length
+};
+
+static_assert(sizeof(Entry) == 24, "Entry must stay 24 bytes");
+
+const char SNAPSHOT_MAGIC[8] = {'U', 'B', 'C', 'O', 'N', 'F', 'I', 'G'};
+
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline std::string_view trimBlanks(std::string_view text) {
+    size_t begin = 0;
+    size_t end = text.size();
+    while (begin < end && isBlank(text[begin])) ++begin;
+    while (end > begin && isBlank(text[end - 1])) --end;
+    return text.substr(begin, end - begin);
+}
+
+/**
+ * Total image size for the given table shape.
+ */
+inline size_t imageSize(size_t slotCount, size_t entryCount, size_t stringsSize) {
+    return sizeof(SnapshotHeader) + ALIGN_UP(slotCount * sizeof(uint32_t), size_t(8)) + entryCount * sizeof(Entry) +
+           stringsSize;
+}
+
+}  // namespace detail
+
+/**
+ * @class ConfigFile
+ * Read-only view of a parsed config file. Values are string_views into
+ * the table image and stay valid until the next load or parse.
+ */
+class ConfigFile {
+public:
+    ConfigFile() : header_(nullptr), slots_(nullptr), entries_(nullptr), strings_(nullptr), fromSnapshot_(false) {}
+
+    ConfigFile(const ConfigFile&) = delete;
+    ConfigFile& operator=(const ConfigFile&) = delete;
+
+    /**
+     * Loads a config file, through its snapshot when that is current.
+     * @param path: The config file.
+     * @param snapshotPath: Where to keep the snapshot; empty for the
+     *                      default under the user's cache directory.
+     * @return: True on success; on failure error() says why and the
+     *          table is empty.
+     */
+    bool load(const std::string& path = CONFIG_FILE_PATH, const std::string& snapshotPath = std::string()) {
+        clear();
+        int64_t mtimeNs = 0;
+        uint64_t size = 0;
+        if (!statSource(path, mtimeNs, size)) {
+            error_ = path + ": cannot stat";
+            return false;
+        }
+        const std::string snapshot = snapshotPath.empty() ? defaultSnapshotPath(path) : snapshotPath;
+        FileUtils::MappedFile cached;
+        const detail::SnapshotHeader* cachedHeader = nullptr;
+        if (!snapshot.empty() && cached.open(snapshot)) cachedHeader = validate(cached.data(), cached.size());
+        if (cachedHeader && cachedHeader->sourceMtimeNs == mtimeNs && cachedHeader->sourceSize == size) {
+            snapshot_ = std::move(cached);
+            attach(snapshot_.data());
+            fromSnapshot_ = true;
+            return true;
+        }
+
+        FileUtils::MappedFile source;
+        if (!source.open(path)) {
+            error_ = path + ": cannot read";
+            return false;
+        }
+        const uint64_t sourceHash = Hash::hash64(source.data(), source.size());
+        if (cachedHeader && cachedHeader->sourceSize == source.size() && cachedHeader->sourceHash == sourceHash) {
+            // Touched but unchanged: reuse the table, record the new mtime.
+            image_.assign(cached.data(), cached.data() + cached.size());
+            reinterpret_cast<detail::SnapshotHeader*>(image_.data())->sourceMtimeNs = mtimeNs;
+            sealHeader(image_.data());
+        } else if (!build(source.view(), path)) {
+            return false;
+        } else {
+            detail::SnapshotHeader* header = reinterpret_cast<detail::SnapshotHeader*>(image_.data());
+            header->sourceMtimeNs = mtimeNs;
+            header->sourceSize = source.size();
+            header->sourceHash = sourceHash;
+            sealHeader(image_.data());
+        }
+        attach(image_.data());
+        if (!snapshot.empty()) {
+            const size_t slash = snapshot.find_last_of('/');
+            if (slash != std::string::npos && slash > 0) FileUtils::createDirectories(snapshot.substr(0, slash));
+            FileUtils::writeFileIfChanged(
+                snapshot, std::string_view(reinterpret_cast<const char*>(image_.data()), image_.size()));
+        }
+        return true;
+    }
+
+    /**
+     * Parses config text held in memory; no snapshot is involved.
+     * @param text: The config text.
+     * @param name: Name used in error messages.
+     * @return: True on success; on failure error() names the line.
+     */
+    bool parse(std::string_view text, const std::string& name = "config") {
+        clear();
+        if (!build(text, name)) return false;
+        sealHeader(image_.data());
+        attach(image_.data());
+        return true;
+    }
+
+    /**
+     * Looks up a key.
+     * @param value: Receives the value if the key is present.
+     * @return: Whether the key is present.
+     */
+    bool find(std::string_view key, std::string_view& value) const {
+        const detail::Entry* entry = lookup(key);
+        if (entry == nullptr) return false;
+        value = std::string_view(strings_ + entry->valueOffset, entry->valueLength);
+        return true;
+    }
+
+    bool has(std::string_view key) const { return lookup(key) != nullptr; }
+
+    /**
+     * @return: The value of key, or fallback when it is missing.
+     */
+    std::string_view get(std::string_view key, std::string_view fallback = std::string_view()) const {
+        std::string_view value;
+        return find(key, value) ? value : fallback;
+    }
+
+    /**
+     * @return: The value of key as an integer, or fallback when it is
+     *          missing or not entirely a number.
+     */
+    int64_t getInt(std::string_view key, int64_t fallback) const {
+        std::string_view text;
+        int64_t value = 0;
+        if (!find(key, text)) return fallback;
+        const Parse::ParseResult result = Parse::parseInt64(text, value);
+        return result.ok() && result.consumed == text.size() ? value : fallback;
+    }
+
+    /**
+     * @return: The value of key as a double, or fallback when it is
+     *          missing or not entirely a number.
+     */
+    double getDouble(std::string_view key, double fallback) const {
+        std::string_view text;
+        double value = 0;
+        if (!find(key, text)) return fallback;
+        const Parse::ParseResult result = Parse::parseDouble(text, value);
+        return result.ok() && result.consumed == text.size() ? value : fallback;
+    }
+
+    /**
+     * @return: true for "true", "yes", "on" and "1", false for "false",
+     *          "no", "off" and "0" (any case), fallback otherwise.
+     */
+    bool getBool(std::string_view key, bool fallback) const {
+        std::string_view text;
+        if (!find(key, text) || text.size() > 5) return fallback;
+        char lower[5];
+        for (size_t i = 0; i < text.size(); ++i) lower[i] = char(std::tolower(static_cast<unsigned char>(text[i])));
+        const std::string_view word(lower, text.size());
+        if (word == "true" || word == "yes" || word == "on" || word == "1") return true;
+        if (word == "false" || word == "no" || word == "off" || word == "0") return false;
+        return fallback;
+    }
+
+    /**
+     * Calls fn(key, value) for every entry, in file order of first
+     * appearance.
+     */
+    template <typename F>
+    void forEach(F&& fn) const {
+        for (uint32_t i = 0; header_ && i < header_->entryCount; ++i) {
+            const detail::Entry& entry = entries_[i];
+            fn(std::string_view(strings_ + entry.keyOffset, entry.keyLength),
+               std::string_view(strings_ + entry.valueOffset, entry.valueLength));
+        }
+    }
+
+    size_t size() const { return header_ ? header_->entryCount : 0; }
+
+    /**
+     * @return: Whether the last load() was served from the snapshot alone.
+     */
+    bool fromSnapshot() const { return fromSnapshot_; }
+
+    const std::string& error() const { return error_; }
+
+    /**
+     * @return: The snapshot path used for a config file when none is
+     *          given, or empty when there is no cache directory.
+     */
+    static std::string defaultSnapshotPath(const std::string& path) {
+        const char* cache = std::getenv("XDG_CACHE_HOME");
+        std::string directory;
+        if (cache && *cache) {
+            directory = cache;
+        } else if (const char* home = std::getenv("HOME")) {
+            if (!*home) return std::string();
+            directory = std::string(home) + "/.cache";
+        } else {
+            return std::string();
+        }
+        std::string absolute = path;
+        if (absolute.empty() || absolute[0] != '/') absolute = FileUtils::currentDirectory() + "/" + path;
+        char name[32];
+        snprintf(name, sizeof(name), "config-%016llx.snap", static_cast<unsigned long long>(Hash::hash64(absolute)));
+        return directory + "/" CONFIG_SNAPSHOT_DIRECTORY "/" + name;
+    }
+
+private:
+    void clear() {
+        snapshot_.close();
+        image_.clear();
+        header_ = nullptr;
+        slots_ = nullptr;
+        entries_ = nullptr;
+        strings_ = nullptr;
+        fromSnapshot_ = false;
+        error_.clear();
+    }
+
+    static bool statSource(const std::string& path, int64_t& mtimeNs, uint64_t& size) {
+#ifdef UNIQUEBUILD_POSIX
+        struct stat st;
+        if (::stat(path.c_str(), &st) != 0) return false;
+#if defined(OS_MAC)
+        mtimeNs = int64_t(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+        mtimeNs = int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+        size = uint64_t(st.st_size);
+        return true;
+#else
+        std::error_code ec;
+        const auto time = std::filesystem::last_write_time(path, ec);
+        if (ec) return false;
+        size = std::filesystem::file_size(path, ec);
+        if (ec) return false;
+        mtimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+        return true;
+#endif
+    }
+
+    /**
+     * Checks that an image is a complete, intact snapshot.
+     * @return: Its header, or null.
+     */
+    static const detail::SnapshotHeader* validate(const uint8_t* data, size_t size) {
+        if (size < sizeof(detail::SnapshotHeader)) return nullptr;
+        const detail::SnapshotHeader* header = reinterpret_cast<const detail::SnapshotHeader*>(data);
+        if (std::memcmp(header->magic, detail::SNAPSHOT_MAGIC, 8) != 0 ||
+            header->version != CONFIG_SNAPSHOT_VERSION ||
+            header->headerHash != Hash::hash64(data, offsetof(detail::SnapshotHeader, headerHash))) {
+            return nullptr;
+        }
+        if (header->slotCount == 0 || (header->slotCount & (header->slotCount - 1)) != 0 ||
+            header->entryCount >= header->slotCount ||
+            size != detail::imageSize(header->slotCount, header->entryCount, header->stringsSize)) {
+            return nullptr;
+        }
+        const size_t body = sizeof(detail::SnapshotHeader);
+        if (header->bodyHash != Hash::hash64(data + body, size - body)) return nullptr;
+        return header;
+    }
+
+    /**
+     * Fills in magic, version and the hashes of a built image.
+     */
+    static void sealHeader(uint8_t* image) {
+        detail::SnapshotHeader* header = reinterpret_cast<detail::SnapshotHeader*>(image);
+        std::memcpy(header->magic, detail::SNAPSHOT_MAGIC, 8);
+        header->version = CONFIG_SNAPSHOT_VERSION;
+        const size_t size = detail::imageSize(header->slotCount, header->entryCount, header->stringsSize);
+        header->bodyHash = Hash::hash64(image + sizeof(detail::SnapshotHeader), size - sizeof(detail::SnapshotHeader));
+        header->headerHash = Hash::hash64(image, offsetof(detail::SnapshotHeader, headerHash));
+    }
+
+    void attach(const uint8_t* image) {
+        header_ = reinterpret_cast<const detail::SnapshotHeader*>(image);
+        slots_ = reinterpret_cast<const uint32_t*>(image + sizeof(detail::SnapshotHeader));
+        entries_ = reinterpret_cast<const detail::Entry*>(
+            image + sizeof(detail::SnapshotHeader) + ALIGN_UP(header_->slotCount * sizeof(uint32_t), size_t(8)));
+        strings_ = reinterpret_cast<const char*>(entries_ + header_->entryCount);
+    }
+
+    const detail::Entry* lookup(std::string_view key) const {
+        if (header_ == nullptr) return nullptr;
+        const uint64_t hash = Hash::hash64(key);
+        const uint32_t mask = header_->slotCount - 1;
+        for (uint32_t slot = uint32_t(hash) & mask;; slot = (slot + 1) & mask) {
+            const uint32_t index = slots_[slot];
+            if (index == 0) return nullptr;
+            const detail::Entry& entry = entries_[index - 1];
+            if (entry.hash == hash && std::string_view(strings_ + entry.keyOffset, entry.keyLength) == key) {
+                return &entry;
+            }
+        }
+    }
+
+    /**
+     * Parses text into image_. Three buffers (slots, entries, strings)
+     * are sized from the line count up front and copied into the image
+     * once at the end.
+     */
+    bool build(std::string_view text, const std::string& name) {
+        size_t lines = 1;
+        // An empty view may have a null data(), which memchr must not see.
+        if (!text.empty()) {
+            const char* end = text.data() + text.size();
+            for (const char* p = text.data(); (p = static_cast<const char*>(std::memchr(p, '\n', size_t(end - p))));
+                 ++p) {
+                ++lines;
+            }
+        }
+        uint32_t slotCount = 8;
+        while (slotCount < 2 * lines) slotCount <<= 1;
+        std::vector<uint32_t> slots(slotCount, 0);
+        std::vector<detail::Entry> entries;
+        entries.reserve(lines);
+        std::string strings;
+        strings.reserve(text.size());
+
+        std::string_view section;
+        size_t lineNumber = 0;
+        size_t position = 0;
+        while (position < text.size()) {
+            size_t end = text.find('\n', position);
+            if (end == std::string_view::npos) end = text.size();
+            const std::string_view line = detail::trimBlanks(text.substr(position, end - position));
+            position = end + 1;
+            ++lineNumber;
+            if (line.empty() || line[0] == '#' || line[0] == ';') continue;
+            if (line[0] == '[') {
+                if (line.back() != ']') return fail(name, lineNumber, "unterminated section");
+                section = detail::trimBlanks(line.substr(1, line.size() - 2));
+                continue;
+            }
+            const size_t equals = line.find('=');
+            const std::string_view key = detail::trimBlanks(line.substr(0, MIN(equals, line.size())));
+            if (equals == std::string_view::npos || key.empty()) return fail(name, lineNumber, "expected key = value");
+            std::string_view value = detail::trimBlanks(line.substr(equals + 1));
+            if (value.size() >= 2 && value.front() == '"' && value.back() == '"') value = value.substr(1, value.size() - 2);
+
+            detail::Entry entry;
+            entry.keyOffset = uint32_t(strings.size());
+            if (!section.empty()) {
+                strings.append(section.data(), section.size());
+                strings.push_back('.');
+            }
+            strings.append(key.data(), key.size());
+            entry.keyLength = uint32_t(strings.size() - entry.keyOffset);
+            entry.valueOffset = uint32_t(strings.size());
+            entry.valueLength = uint32_t(value.size());
+            strings.append(value.data(), value.size());
+            const std::string_view fullKey(strings.data() + entry.keyOffset, entry.keyLength);
+            entry.hash = Hash::hash64(fullKey);
+
+            for (uint32_t slot = uint32_t(entry.hash) & (slotCount - 1);; slot = (slot + 1) & (slotCount - 1)) {
+                if (slots[slot] == 0) {
+                    entries.push_back(entry);
+                    slots[slot] = uint32_t(entries.size());
+                    break;
+                }
+                detail::Entry& existing = entries[slots[slot] - 1];
+                if (existing.hash == entry.hash &&
+                    std::string_view(strings.data() + existing.keyOffset, existing.keyLength) == fullKey) {
+                    existing.valueOffset = entry.valueOffset;
+                    existing.valueLength = entry.valueLength;
+                    break;
+                }
+            }
+        }
+        if (strings.size() > UINT32_MAX) return fail(name, lineNumber, "file too large");
+
+        image_.assign(detail::imageSize(slotCount, entries.size(), strings.size()), 0);
+        detail::SnapshotHeader* header = reinterpret_cast<detail::SnapshotHeader*>(image_.data());
+        header->entryCount = uint32_t(entries.size());
+        header->slotCount = slotCount;
+        header->stringsSize = uint32_t(strings.size());
+        uint8_t* out = image_.data() + sizeof(detail::SnapshotHeader);
+        std::memcpy(out, slots.data(), slotCount * sizeof(uint32_t));
+        out += ALIGN_UP(slotCount * sizeof(uint32_t), size_t(8));
+        if (!entries.empty()) std::memcpy(out, entries.data(), entries.size() * sizeof(detail::Entry));
+        out += entries.size() * sizeof(detail::Entry);
+        if (!strings.empty()) std::memcpy(out, strings.data(), strings.size());
+        return true;
+    }
+
+    bool fail(const std::string& name, size_t line, const char* message) {
+        image_.clear();
+        error_ = name + ":" + std::to_string(line) + ": " + message;
+        return false;
+    }
+
+    FileUtils::MappedFile snapshot_;  // Mapped snapshot when loaded from one
+    std::vector<uint8_t> image_;  // Built or refreshed image otherwise
+    const detail::SnapshotHeader* header_;  // Header of the active image
+    const uint32_t* slots_;  // Slot array: entry index + 1, or 0 when empty
+    const detail::Entry* entries_;  // Entries in order of first appearance
+    const char* strings_;  // Keys and values
+    bool fromSnapshot_;  // Whether load() only mapped the snapshot
+    std::string error_;  // Why the last load or parse failed
+};
+
+}  // namespace Config
+
+}  // namespace UniqueBuild
+
+#endif  // UNIQUEBUILD_CONFIG_H
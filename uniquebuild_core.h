@@ -0,0 +1,954 @@
+/***************************************
+ * uniquebuild_core.h
+ * Platform detection, configuration switches, constants and macros,
+ * the shared structs and enums, parallel chunking and the arena allocator.
+ * Every other uniquebuild header includes this one.
+ *
+ * Part of uniquebuild; see uniquebuild.h.
+ ***************************************/
+
+#ifndef UNIQUEBUILD_CORE_H
+#define UNIQUEBUILD_CORE_H
+
+#include <cstddef>      // Required for std::size_t, std::max_align_t
+#include <cstdint>      // Required for fixed-width integers (uint32_t, uint64_t)
+#include <cstdio>       // Required for std::FILE, std::fwrite, std::snprintf
+#include <cstdlib>      // Required for std::malloc, std::free, exit
+#include <cstring>      // Required for std::memcpy
+#include <limits>       // Required for std::numeric_limits
+#include <type_traits>  // Required for std::is_integral, std::make_unsigned
+#include <atomic>       // Required for std::atomic
+#include <string>       // Required for std::string
+#include <string_view>  // Required for std::string_view
+#include <vector>       // Required for std::vector
+#include <memory>       // Required for std::unique_ptr
+
+// Platform-specific code
+#ifdef _WIN32
+    #define OS_WINDOWS
+    #include <windows.h>
+#elif __linux__
+    #define OS_LINUX
+    #include <unistd.h>
+#elif __APPLE__
+    #define OS_MAC
+    #include <TargetConditionals.h>
+    #if TARGET_OS_MAC
+        #include <sys/types.h>
+        #include <sys/stat.h>
+    #endif
+#endif
+
+
+#if defined(OS_LINUX) || defined(OS_MAC) || defined(__unix__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define UNIQUEBUILD_POSIX 1
+#endif
+
+// Define architecture-specific macros
+#ifdef __x86_64__
+    #define ARCH_X64
+#elif __i386__
+    #define ARCH_X86
+#elif __arm__
+    #define ARCH_ARM
+#elif __aarch64__
+    #define ARCH_ARM64
+#endif
+
+// Fix for architecture preprocessor directive
+#if defined(ARCH_X64)
+    #define ARCHITECTURE "x64"
+#elif defined(ARCH_X86)
+    #define ARCHITECTURE "x86"
+#elif defined(ARCH_ARM)
+    #define ARCHITECTURE "ARM"
+#elif defined(ARCH_ARM64)
+    #define ARCHITECTURE "ARM64"
+#endif
+
+// Maximum values used in the build system
+#define MAX_PATH_LENGTH 4096
+#define MAX_FILENAME_LENGTH 256
+#define MAX_THREADS 16
+
+// Version information
+#define UNIQUEBUILD_VERSION_MAJOR 1
+#define UNIQUEBUILD_VERSION_MINOR 0
+#define UNIQUEBUILD_VERSION_PATCH 3
+
+// Functionality switches
+#define ENABLE_LOGGING 1
+#define ENABLE_MULTITHREADING 1
+#define ENABLE_CACHE 0
+
+
+#if ENABLE_MULTITHREADING
+    #include <thread>
+    #define THREAD_POOL_SIZE 4
+#else
+    #define THREAD_POOL_SIZE 1
+#endif
+
+#if ENABLE_CACHE
+    #include <unordered_map>
+#endif
+
+// Add additional preprocessor directives
+#ifdef OS_LINUX
+    #include <sys/time.h>
+    #include <sys/resource.h>
+#endif
+
+// File handling constants
+#define MAX_OPEN_FILES 100
+
+// File opening modes
+#define FILE_MODE_READ_BINARY "rb"
+#define FILE_MODE_WRITE_BINARY "wb"
+#define FILE_MODE_APPEND_BINARY "ab"
+
+// HTTP status codes
+#define HTTP_OK 200
+#define HTTP_BAD_REQUEST 400
+#define HTTP_UNAUTHORIZED 401
+#define HTTP_FORBIDDEN 403
+#define HTTP_NOT_FOUND 404
+#define HTTP_INTERNAL_SERVER_ERROR 500
+
+// Color codes (hex values)
+#define COLOR_RED 0xFF0000
+#define COLOR_GREEN 0x00FF00
+#define COLOR_BLUE 0x0000FF
+#define COLOR_WHITE 0xFFFFFF
+#define COLOR_BLACK 0x000000
+#define COLOR_YELLOW 0xFFFF00
+#define COLOR_CYAN 0x00FFFF
+#define COLOR_MAGENTA 0xFF00FF
+
+// Utility macros for arrays
+#define ARRAY_LENGTH(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+// Error handling macros
+#define CHECK_ERROR(cond, err_code) if (!(cond)) { return err_code; }
+#define ASSERT(cond, msg) if (!(cond)) { fprintf(stderr, "%s\n", msg); exit(EXIT_FAILURE); }
+
+// String manipulation macros
+#define STRINGIFY(x) #x
+#define CONCAT(a, b) a ## b
+#define TO_UPPER(c) (((c) >= 'a' && (c) <= 'z') ? (c) - 32 : (c))
+#define TO_LOWER(c) (((c) >= 'A' && (c) <= 'Z') ? (c) + 32 : (c))
+
+// Threading constants
+#define THREAD_STACK_SIZE 8192
+#define MAX_THREAD_COUNT 16
+#define DEFAULT_THREAD_PRIORITY 5
+
+// Network-related constants
+#define MAX_CONNECTIONS 100
+#define DEFAULT_PORT 8080
+#define MAX_PACKET_SIZE 4096
+#define TIMEOUT_MS 5000
+
+// Endian conversion macros; TO_LITTLE_ENDIAN_* and TO_BIG_ENDIAN_* convert
+// between host order and the named order in either direction. C++ code
+// should prefer the typed functions in uniquebuild_endian.h.
+#define BYTE_SWAP_16(x) ((uint16_t)((((uint16_t)(x) & 0x00FFu) << 8) | (((uint16_t)(x) & 0xFF00u) >> 8)))
+#define BYTE_SWAP_32(x) ((uint32_t)((((uint32_t)(x) & 0x000000FFu) << 24) | (((uint32_t)(x) & 0x0000FF00u) << 8) | \
+                                    (((uint32_t)(x) & 0x00FF0000u) >> 8) | (((uint32_t)(x) & 0xFF000000u) >> 24)))
+#define BYTE_SWAP_64(x) ((uint64_t)(((uint64_t)BYTE_SWAP_32((uint64_t)(x) & 0xFFFFFFFFu) << 32) | \
+                                    (uint64_t)BYTE_SWAP_32((uint64_t)(x) >> 32)))
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    #define TO_LITTLE_ENDIAN_16(x) BYTE_SWAP_16(x)
+    #define TO_LITTLE_ENDIAN_32(x) BYTE_SWAP_32(x)
+    #define TO_LITTLE_ENDIAN_64(x) BYTE_SWAP_64(x)
+    #define TO_BIG_ENDIAN_16(x) ((uint16_t)(x))
+    #define TO_BIG_ENDIAN_32(x) ((uint32_t)(x))
+    #define TO_BIG_ENDIAN_64(x) ((uint64_t)(x))
+#else
+    #define TO_LITTLE_ENDIAN_16(x) ((uint16_t)(x))
+    #define TO_LITTLE_ENDIAN_32(x) ((uint32_t)(x))
+    #define TO_LITTLE_ENDIAN_64(x) ((uint64_t)(x))
+    #define TO_BIG_ENDIAN_16(x) BYTE_SWAP_16(x)
+    #define TO_BIG_ENDIAN_32(x) BYTE_SWAP_32(x)
+    #define TO_BIG_ENDIAN_64(x) BYTE_SWAP_64(x)
+#endif
+
+// Limits
+#define MAX_BUFFER_SIZE 8192
+#define MAX_LOG_LENGTH 1024
+#define MAX_INPUT_SIZE 512
+#define MAX_OUTPUT_SIZE 512
+
+// Common file paths
+#define CONFIG_FILE_PATH "/etc/myapp/config.cfg"
+#define LOG_FILE_PATH "/var/log/myapp.log"
+#define TEMP_FILE_PATH "/tmp/myapp.tmp"
+
+// Default values
+#define DEFAULT_TIMEOUT 3000  // 3 seconds
+#define DEFAULT_BUFFER_SIZE 1024
+#define DEFAULT_PORT_NUMBER 80
+
+// Signal handling macros
+#define CATCH_SIGNAL(sig, handler) signal(sig, handler)
+#define IGNORE_SIGNAL(sig) signal(sig, SIG_IGN)
+#define DEFAULT_SIGNAL_HANDLER SIG_DFL
+
+// Debugging utility macros
+#ifdef DEBUG
+    #define DEBUG_PRINT_VAR(var) printf(#var " = %d\n", var)
+    #define DEBUG_PRINT_STR(var) printf(#var " = %s\n", var)
+#else
+    #define DEBUG_PRINT_VAR(var)
+    #define DEBUG_PRINT_STR(var)
+#endif
+
+// Exit codes
+#define EXIT_CODE_SUCCESS 0
+#define EXIT_CODE_FAILURE 1
+#define EXIT_CODE_INVALID_ARGUMENTS 2
+#define EXIT_CODE_OUT_OF_MEMORY 3
+#define EXIT_CODE_FILE_ERROR 4
+
+// Common mathematical constants
+#define MAX_INT 2147483647
+#define MIN_INT (-2147483647 - 1)
+#define MAX_FLOAT 3.402823466e+38F
+#define MIN_FLOAT 1.175494351e-38F
+
+// File access permissions
+#define PERM_READ 0x01
+#define PERM_WRITE 0x02
+#define PERM_EXECUTE 0x04
+
+// Process control macros
+#define FORK_PROCESS fork()
+#define KILL_PROCESS(pid, sig) kill(pid, sig)
+
+// Example use of a build-related macro
+#define BUILD_WITH_DEBUG 1
+#define BUILD_VERSION_MAJOR 1
+#define BUILD_VERSION_MINOR 0
+#define BUILD_VERSION_PATCH 0
+
+// Time macros
+#define MS_TO_S(ms) ((ms) / 1000)
+#define S_TO_MS(s) ((s) * 1000)
+#define MS_TO_MIN(ms) ((ms) / (1000 * 60))
+#define MIN_TO_MS(min) ((min) * (1000 * 60))
+
+/***************************************
+ * Project: Uniquebuild.h 
+ * Description: A robust header file containing common macros, constants, and utilities.
+ * 
+ * Author: Rajdeep Chatterjee
+ * Date: October 2024
+ ***************************************/
+
+/***************************************
+ * SECTION: Buffer Sizes
+ * These macros define the standard buffer sizes used for memory allocation,
+ * file operations, or network communication.
+ ***************************************/
+
+/**
+ * BUFFER_SIZE_256: Represents a 256-byte buffer.
+ * Commonly used for small I/O operations.
+ */
+#define BUFFER_SIZE_256 256
+
+/**
+ * BUFFER_SIZE_512: Represents a 512-byte buffer.
+ * Frequently used for intermediate size file operations.
+ */
+#define BUFFER_SIZE_512 512
+
+/**
+ * BUFFER_SIZE_1024: 1024-byte buffer, used in situations where moderate
+ * data transfer (like reading lines from files) is needed.
+ */
+#define BUFFER_SIZE_1024 1024
+
+/**
+ * BUFFER_SIZE_2048: 2048-byte buffer, commonly used for larger data
+ * handling like copying data from large files or packets in network communication.
+ */
+#define BUFFER_SIZE_2048 2048
+
+/***************************************
+ * SECTION: Time Units
+ * These constants help convert time units, from milliseconds to hours.
+ * Useful when dealing with timeouts, delays, or any time-based calculation.
+ ***************************************/
+
+/**
+ * SECOND_MS: Number of milliseconds in one second.
+ * Useful for converting time durations into milliseconds.
+ */
+#define SECOND_MS 1000
+
+/**
+ * MINUTE_MS: Number of milliseconds in one minute.
+ * Can be used to set long-term timeouts or delays.
+ */
+#define MINUTE_MS (60 * SECOND_MS)
+
+/**
+ * HOUR_MS: Number of milliseconds in one hour.
+ * Useful in long-running processes or periodic jobs.
+ */
+#define HOUR_MS (60 * MINUTE_MS)
+
+/**
+ * DAY_MS: Number of milliseconds in one day.
+ * Typically used in applications that deal with scheduling.
+ */
+#define DAY_MS (24 * HOUR_MS)
+
+/***************************************
+ * SECTION: Mathematical Constants
+ * These are standard constants like PI and the Euler number (E) used in various
+ * mathematical operations.
+ ***************************************/
+
+/**
+ * PI: Defines the mathematical constant PI (3.14159).
+ * Essential for trigonometric operations in geometry.
+ */
+#define PI 3.14159265358979323846
+
+/**
+ * E: Defines Euler's number (e ~ 2.71828).
+ * Commonly used in exponential and logarithmic calculations.
+ */
+#define E 2.71828182845904523536
+
+/**
+ * GOLDEN_RATIO: Approximate value of the golden ratio (1.618...).
+ * Useful in various design and aesthetic calculations.
+ */
+#define GOLDEN_RATIO 1.618033988749895
+
+/**
+ * DEG_TO_RAD(deg): Converts degrees to radians.
+ * Useful when dealing with angular values in trigonometry.
+ * @param deg: Angle in degrees.
+ * @return: Angle in radians.
+ */
+#define DEG_TO_RAD(deg) ((deg) * (PI / 180.0))
+
+/**
+ * RAD_TO_DEG(rad): Converts radians to degrees.
+ * Used when you need to convert angles from radian-based calculations
+ * to degrees.
+ * @param rad: Angle in radians.
+ * @return: Angle in degrees.
+ */
+#define RAD_TO_DEG(rad) ((rad) * (180.0 / PI))
+
+/***************************************
+ * SECTION: Return Codes
+ * Standard return codes for functions indicating success or different
+ * kinds of failures.
+ ***************************************/
+
+/**
+ * SUCCESS: Indicates that the function has completed successfully.
+ * It is generally used as a return value from functions.
+ */
+#define SUCCESS 0
+
+/**
+ * ERROR_INVALID_ARG: Returned when an invalid argument is passed to a function.
+ * Helps in argument validation logic.
+ */
+#define ERROR_INVALID_ARG 1
+
+/**
+ * ERROR_OUT_OF_MEMORY: Indicates that the system has run out of memory.
+ * Useful in memory allocation functions.
+ */
+#define ERROR_OUT_OF_MEMORY 2
+
+/**
+ * ERROR_FILE_NOT_FOUND: Returned when a file is not found in file system operations.
+ */
+#define ERROR_FILE_NOT_FOUND 3
+
+/**
+ * ERROR_PERMISSION_DENIED: Indicates that the user does not have permission
+ * to access the file or resource.
+ */
+#define ERROR_PERMISSION_DENIED 4
+
+/***************************************
+ * SECTION: Boolean Constants
+ * Defines TRUE and FALSE constants for logical operations.
+ ***************************************/
+
+/**
+ * TRUE: Boolean value for 'true'.
+ */
+#define TRUE 1
+
+/**
+ * FALSE: Boolean value for 'false'.
+ */
+#define FALSE 0
+
+/***************************************
+ * SECTION: Safe Memory Management
+ * A macro that safely deletes a pointer and sets it to nullptr.
+ * Prevents dangling pointers.
+ ***************************************/
+
+/**
+ * SAFE_DELETE(ptr): Deletes a pointer if it is not null and sets it to null.
+ * This helps to prevent memory leaks and dangling pointers.
+ * @param ptr: The pointer to delete.
+ */
+#define SAFE_DELETE(ptr) if (ptr) { delete ptr; ptr = nullptr; }
+
+/***************************************
+ * SECTION: File Handling Constants
+ * These constants help define file handling modes and limits for file sizes.
+ ***************************************/
+
+/**
+ * MAX_FILE_SIZE: Defines the maximum file size that can be handled (100 MB).
+ * Adjust this if the program needs to handle larger files.
+ */
+#define MAX_FILE_SIZE 104857600  // 100 MB
+
+/**
+ * FILE_READ_ONLY: File is opened in read-only mode.
+ */
+#define FILE_READ_ONLY 0x01
+
+/**
+ * FILE_WRITE_ONLY: File is opened in write-only mode.
+ */
+#define FILE_WRITE_ONLY 0x02
+
+/**
+ * FILE_READ_WRITE: File is opened for both reading and writing.
+ */
+#define FILE_READ_WRITE 0x03
+
+/**
+ * FILE_MODE_READ: Mode string for opening a file for reading.
+ * Used in fopen() or similar functions.
+ */
+#define FILE_MODE_READ "r"
+
+/**
+ * FILE_MODE_WRITE: Mode string for opening a file for writing.
+ */
+#define FILE_MODE_WRITE "w"
+
+/**
+ * FILE_MODE_APPEND: Mode string for opening a file for appending data.
+ */
+#define FILE_MODE_APPEND "a"
+
+/***************************************
+ * SECTION: Mathematical Macros
+ * These macros simplify certain mathematical operations like finding
+ * minimum and maximum values, swapping variables, and aligning memory.
+ ***************************************/
+
+/**
+ * MIN(a, b): Returns the minimum of two values.
+ * @param a: First value.
+ * @param b: Second value.
+ * @return: The smaller value.
+ */
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+/**
+ * MAX(a, b): Returns the maximum of two values.
+ * @param a: First value.
+ * @param b: Second value.
+ * @return: The larger value.
+ */
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
+/**
+ * SWAP(a, b): Swaps two values of any type.
+ * @param a: First value.
+ * @param b: Second value.
+ */
+#define SWAP(a, b) { typeof(a) tmp = (a); (a) = (b); (b) = tmp; }
+
+/**
+ * ALIGN_UP(x, a): Aligns a value x to the next multiple of a.
+ * Useful when allocating memory blocks.
+ * @param x: The value to align.
+ * @param a: The alignment boundary.
+ */
+#define ALIGN_UP(x, a) (((x) + ((a) - 1)) & ~((a) - 1))
+
+/**
+ * ALIGN_DOWN(x, a): Aligns a value x down to the nearest multiple of a.
+ * @param x: The value to align.
+ * @param a: The alignment boundary.
+ */
+#define ALIGN_DOWN(x, a) ((x) & ~((a) - 1))
+
+/***************************************
+ * SECTION: Structs
+ * Structs are used to group related variables together under one name.
+ * The following structs represent common data structures.
+ ***************************************/
+
+/**
+ * @struct Point
+ * Represents a 2D point on a Cartesian plane.
+ */
+struct Point {
+    int x;  // X-coordinate
+    int y;  // Y-coordinate
+};
+
+/**
+ * @struct Rectangle
+ * Represents a rectangle defined by its top-left corner and its width and height.
+ */
+struct Rectangle {
+    Point topLeft;  // Top-left corner of the rectangle
+    int width;  // Width of the rectangle
+    int height;  // Height of the rectangle
+};
+
+/**
+ * @struct FileInfo
+ * Holds information about a file, including its name, size, and permissions.
+ */
+struct FileInfo {
+    std::string name;  // File name
+    size_t size;  // File size in bytes
+    bool isReadOnly;  // Indicates if the file is read-only
+};
+
+/***************************************
+ * SECTION: Enums
+ * Enums are used to represent a set of named integer constants.
+ * The following enums define common status codes and error types.
+ ***************************************/
+
+/**
+ * @enum StatusCode
+ * Represents the status of an operation.
+ */
+enum class StatusCode {
+    STATUS_SUCCESS,  // The operation was successful
+    STATUS_ERROR,  // A generic error occurred
+    FILE_NOT_FOUND,  // The file was not found
+    PERMISSION_DENIED  // The operation was denied due to lack of permissions
+};
+
+/**
+ * @enum FileMode
+ * Represents the mode in which a file can be opened.
+ */
+enum class FileMode {
+    READ,  // Open the file for reading
+    WRITE,  // Open the file for writing
+    APPEND  // Open the file for appending data
+};
+
+/**
+ * @enum LogLevel
+ * Represents the different levels of logging that can be used in the application.
+ */
+enum LogLevel {
+    LOG_LEVEL_DEBUG,  // Debug-level log messages
+    LOG_LEVEL_INFO,  // Informational log messages
+    LOG_LEVEL_WARNING,  // Warning-level log messages
+    LOG_LEVEL_ERROR  // Error-level log messages
+};
+
+/**
+ * @enum MathError
+ * Represents various mathematical errors that can occur during calculations.
+ */
+enum MathError {
+    MATH_ERROR_NONE,  // No error
+    MATH_ERROR_DIVIDE_BY_ZERO,  // Division by zero
+    MATH_ERROR_OVERFLOW,  // Overflow during calculation
+    MATH_ERROR_UNDERFLOW  // Underflow during calculation
+};
+
+/***************************************
+ * SECTION: Additional Structs and Enums
+ ***************************************/
+
+/**
+ * @struct Circle
+ * Represents a circle defined by its center and radius.
+ */
+struct Circle {
+    Point center;  // Center of the circle
+    double radius;  // Radius of the circle
+};
+
+/**
+ * @struct User
+ * Represents a user with an ID, name, and age.
+ */
+struct User {
+    int id;  // User ID
+    std::string name;  // User name
+    int age;  // User age
+};
+
+/**
+ * @enum UserRole
+ * Represents the role of a user in the system.
+ */
+enum UserRole {
+    ROLE_ADMIN,  // Administrator role
+    ROLE_EDITOR,  // Editor role
+    ROLE_VIEWER  // Viewer role
+};
+
+/***************************************
+ * SECTION: Parallel Helpers
+ * Small helpers for splitting an index range into contiguous chunks and
+ * running them on up to THREAD_POOL_SIZE threads. Used by the batch
+ * routines further down in this file.
+ ***************************************/
+
+/**
+ * PARALLEL_MIN_CHUNK: Smallest number of elements worth handing to a
+ * separate thread. Below this, batch routines stay on the calling thread.
+ */
+#define PARALLEL_MIN_CHUNK 16384
+
+namespace UniqueBuild {
+
+/**
+ * @namespace Parallel
+ * Chunked fork/join over index ranges.
+ */
+namespace Parallel {
+
+/**
+ * Computes how many chunks a range is split into.
+ * @param count: Number of elements in the range.
+ * @param minChunk: Smallest chunk worth running on its own thread.
+ * @return: Number of chunks, between 1 and THREAD_POOL_SIZE.
+ */
+inline size_t chunkCount(size_t count, size_t minChunk) {
+    if (minChunk == 0) minChunk = 1;
+    size_t chunks = (count + minChunk - 1) / minChunk;
+    if (chunks > THREAD_POOL_SIZE) chunks = THREAD_POOL_SIZE;
+    return chunks == 0 ? 1 : chunks;
+}
+
+/**
+ * Runs fn(chunk, begin, end) for every chunk of [0, count).
+ * Chunk 0 runs on the calling thread; the call returns once all chunks are done.
+ * fn must not throw.
+ * @param count: Number of elements in the range.
+ * @param minChunk: Smallest chunk worth running on its own thread.
+ * @param fn: Callable taking (size_t chunk, size_t begin, size_t end).
+ */
+template<typename F>
+void forChunks(size_t count, size_t minChunk, F&& fn) {
+    const size_t chunks = chunkCount(count, minChunk);
+    const size_t step = (count + chunks - 1) / chunks;
+#if ENABLE_MULTITHREADING
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+    for (size_t c = 1; c < chunks; ++c) {
+        const size_t begin = MIN(c * step, count);
+        const size_t end = MIN(begin + step, count);
+        workers.emplace_back([&fn, c, begin, end] { fn(c, begin, end); });
+    }
+    fn(size_t(0), size_t(0), MIN(step, count));
+    for (auto& worker : workers) {
+        worker.join();
+    }
+#else
+    for (size_t c = 0; c < chunks; ++c) {
+        const size_t begin = MIN(c * step, count);
+        fn(c, begin, MIN(begin + step, count));
+    }
+#endif
+}
+
+}  // namespace Parallel
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: Arena Allocator
+ * A bump allocator for short-lived data. Allocation is an aligned pointer
+ * bump inside a chunk; nothing is freed individually. A mark() taken at the
+ * start of a build step and a reset() at its end release every temporary
+ * of that step at once, and the chunks are reused by the next step.
+ ***************************************/
+
+#if defined(__has_include)
+    #if __has_include(<memory_resource>)
+        #include <memory_resource>
+        #define UNIQUEBUILD_HAS_PMR 1
+    #endif
+#endif
+
+/**
+ * ARENA_DEFAULT_CHUNK_SIZE: Size of the first chunk an Arena allocates.
+ * Each further chunk doubles, up to ARENA_MAX_CHUNK_SIZE.
+ */
+#define ARENA_DEFAULT_CHUNK_SIZE 65536
+#define ARENA_MAX_CHUNK_SIZE (64 * 1024 * 1024)
+
+namespace UniqueBuild {
+
+class Arena;
+
+#ifdef UNIQUEBUILD_HAS_PMR
+/**
+ * @class ArenaResource
+ * std::pmr::memory_resource backed by an Arena, so that std::pmr
+ * containers can allocate from it. Deallocation is a no-op; memory comes
+ * back when the arena is reset.
+ */
+class ArenaResource : public std::pmr::memory_resource {
+public:
+    explicit ArenaResource(Arena& arena) : arena_(&arena) {}
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        const ArenaResource* o = dynamic_cast<const ArenaResource*>(&other);
+        return o != nullptr && o->arena_ == arena_;
+    }
+
+    Arena* arena_;  // The arena that owns the memory
+};
+#endif
+
+/**
+ * @class Arena
+ * Chunked bump allocator with mark/reset. Not thread-safe; use one arena
+ * per thread or per build step.
+ */
+class Arena {
+public:
+    /**
+     * @struct Marker
+     * A position in the arena, returned by mark() and accepted by reset().
+     */
+    struct Marker {
+        size_t chunk;  // Index of the active chunk
+        size_t offset;  // Bytes used in that chunk
+    };
+
+    explicit Arena(size_t chunkSize = ARENA_DEFAULT_CHUNK_SIZE)
+        : nextChunkSize_(chunkSize ? chunkSize : ARENA_DEFAULT_CHUNK_SIZE), current_(0), offset_(0)
+#ifdef UNIQUEBUILD_HAS_PMR
+        , resource_(*this)
+#endif
+    {}
+
+    ~Arena() { release(); }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * Allocates uninitialized memory.
+     * @param bytes: Number of bytes.
+     * @param alignment: Required alignment; must be a power of two.
+     * @return: Pointer to the memory; valid until a reset() past it.
+     */
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        if (!chunks_.empty()) {
+            const Chunk& chunk = chunks_[current_];
+            const uintptr_t base = reinterpret_cast<uintptr_t>(chunk.data);
+            const uintptr_t start = ALIGN_UP(base + offset_, uintptr_t(alignment));
+            if (start + bytes <= base + chunk.size) {
+                offset_ = size_t(start + bytes - base);
+                return reinterpret_cast<void*>(start);
+            }
+        }
+        return allocateSlow(bytes, alignment);
+    }
+
+    /**
+     * Allocates an uninitialized array of T. T must be trivially destructible,
+     * since the arena never runs destructors.
+     */
+    template<typename T>
+    T* allocateArray(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "Arena does not run destructors");
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    /**
+     * Copies a string into the arena.
+     * @param text: The string to copy.
+     * @return: A view of the copy, NUL-terminated for C APIs.
+     */
+    std::string_view copyString(std::string_view text) {
+        char* out = allocateArray<char>(text.size() + 1);
+        std::memcpy(out, text.data(), text.size());
+        out[text.size()] = '\0';
+        return std::string_view(out, text.size());
+    }
+
+    /**
+     * @return: The current position, for a later reset(marker).
+     */
+    Marker mark() const { return Marker{current_, offset_}; }
+
+    /**
+     * Frees everything allocated after the marker was taken.
+     * Chunks stay allocated and are reused.
+     */
+    void reset(const Marker& marker) {
+        current_ = marker.chunk;
+        offset_ = marker.offset;
+    }
+
+    /**
+     * Frees everything. Chunks stay allocated and are reused.
+     */
+    void reset() {
+        current_ = 0;
+        offset_ = 0;
+    }
+
+    /**
+     * Returns all chunks to the heap.
+     */
+    void release() {
+        for (const Chunk& chunk : chunks_) {
+            ::operator delete(chunk.data);
+        }
+        chunks_.clear();
+        current_ = 0;
+        offset_ = 0;
+    }
+
+    /**
+     * @return: Bytes in use, including alignment padding.
+     */
+    size_t bytesUsed() const {
+        size_t total = offset_;
+        for (size_t i = 0; i < current_ && i < chunks_.size(); ++i) {
+            total += chunks_[i].size;
+        }
+        return total;
+    }
+
+    /**
+     * @return: Bytes held from the heap across all chunks.
+     */
+    size_t bytesReserved() const {
+        size_t total = 0;
+        for (const Chunk& chunk : chunks_) {
+            total += chunk.size;
+        }
+        return total;
+    }
+
+#ifdef UNIQUEBUILD_HAS_PMR
+    /**
+     * @return: A memory_resource for std::pmr containers that allocates here.
+     */
+    std::pmr::memory_resource* resource() { return &resource_; }
+#endif
+
+private:
+    struct Chunk {
+        char* data;
+        size_t size;
+    };
+
+    void* allocateSlow(size_t bytes, size_t alignment) {
+        // Move on to the next retained chunk that fits, or append a new one.
+        while (!chunks_.empty() && current_ + 1 < chunks_.size()) {
+            ++current_;
+            offset_ = 0;
+            const Chunk& chunk = chunks_[current_];
+            const uintptr_t base = reinterpret_cast<uintptr_t>(chunk.data);
+            const uintptr_t start = ALIGN_UP(base, uintptr_t(alignment));
+            if (start + bytes <= base + chunk.size) {
+                offset_ = size_t(start + bytes - base);
+                return reinterpret_cast<void*>(start);
+            }
+        }
+        size_t size = nextChunkSize_;
+        if (size < bytes + alignment) size = ALIGN_UP(bytes + alignment, size_t(4096));
+        if (nextChunkSize_ < ARENA_MAX_CHUNK_SIZE) nextChunkSize_ *= 2;
+        Chunk chunk;
+        chunk.data = static_cast<char*>(::operator new(size));
+        chunk.size = size;
+        chunks_.push_back(chunk);
+        current_ = chunks_.size() - 1;
+        const uintptr_t base = reinterpret_cast<uintptr_t>(chunk.data);
+        const uintptr_t start = ALIGN_UP(base, uintptr_t(alignment));
+        offset_ = size_t(start + bytes - base);
+        return reinterpret_cast<void*>(start);
+    }
+
+    std::vector<Chunk> chunks_;  // All chunks, in allocation order
+    size_t nextChunkSize_;  // Size of the next chunk to allocate
+    size_t current_;  // Index of the chunk being bumped
+    size_t offset_;  // Bytes used in the current chunk
+#ifdef UNIQUEBUILD_HAS_PMR
+    ArenaResource resource_;  // Adapter returned by resource()
+#endif
+};
+
+#ifdef UNIQUEBUILD_HAS_PMR
+inline void* ArenaResource::do_allocate(size_t bytes, size_t alignment) {
+    return arena_->allocate(bytes, alignment);
+}
+#endif
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: Function Declarations
+ * This section contains declarations for various functions
+ * used throughout the project.
+ ***************************************/
+
+/**
+ * Initializes the application.
+ * @return: True if initialization was successful, false otherwise.
+ */
+bool initApp();
+
+/**
+ * Cleans up resources before the application exits.
+ */
+void cleanupApp();
+
+/**
+ * Prints a welcome message to the user.
+ */
+void printWelcomeMessage();
+
+/**
+ * Displays the help menu for the application.
+ */
+void displayHelp();
+
+/**
+ * Reads user input from the console.
+ * @return: The input string entered by the user.
+ */
+std::string readUserInput();
+
+#endif  // UNIQUEBUILD_CORE_H
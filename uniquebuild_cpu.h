@@ -0,0 +1,91 @@
+/***************************************
+ * uniquebuild_cpu.h
+ * Runtime CPU feature detection and the target-attribute macros used
+ * by the vector kernels in the other headers.
+ *
+ * Part of uniquebuild; see uniquebuild.h.
+ ***************************************/
+
+#ifndef UNIQUEBUILD_CPU_H
+#define UNIQUEBUILD_CPU_H
+
+#include "uniquebuild_core.h"
+
+/***************************************
+ * SECTION: CPU Features
+ * Runtime detection of instruction-set extensions, so that vector kernels
+ * can be compiled into the header with per-function target attributes and
+ * selected at run time without requiring -mavx2 for the whole program.
+ ***************************************/
+
+#if defined(ARCH_X64) && (defined(__GNUC__) || defined(__clang__))
+    #include <immintrin.h>
+    #include <cpuid.h>
+    #define UNIQUEBUILD_X86_DISPATCH 1
+    #define UNIQUEBUILD_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define UNIQUEBUILD_TARGET(isa)
+#endif
+
+#if defined(ARCH_ARM64) && defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define UNIQUEBUILD_NEON 1
+#endif
+
+namespace UniqueBuild {
+
+/**
+ * @namespace Cpu
+ * Cached CPU feature queries. All return false on non-x86 targets.
+ */
+namespace Cpu {
+
+inline bool hasAvx2() {
+#ifdef UNIQUEBUILD_X86_DISPATCH
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+inline bool hasSsse3() {
+#ifdef UNIQUEBUILD_X86_DISPATCH
+    static const bool supported = __builtin_cpu_supports("ssse3");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+inline bool hasSse41() {
+#ifdef UNIQUEBUILD_X86_DISPATCH
+    static const bool supported = __builtin_cpu_supports("sse4.1");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+/**
+ * SHA extensions (SHA-NI), read from CPUID leaf 7 since not every compiler
+ * knows the feature name for __builtin_cpu_supports.
+ */
+inline bool hasSha() {
+#ifdef UNIQUEBUILD_X86_DISPATCH
+    static const bool supported = [] {
+        unsigned int eax, ebx, ecx, edx;
+        return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & (1u << 29)) != 0 &&
+               __builtin_cpu_supports("sse4.1");
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+}  // namespace Cpu
+
+}  // namespace UniqueBuild
+
+#endif  // UNIQUEBUILD_CPU_H
@@ -0,0 +1,377 @@
+/***************************************
+ * uniquebuild_endian.h
+ * Byte order: constexpr byte swaps, loads and stores of 16/32/64-bit
+ * values in either endianness, and bulk byte-swap kernels for arrays.
+ *
+ * Part of uniquebuild; see uniquebuild.h.
+ ***************************************/
+
+#ifndef UNIQUEBUILD_ENDIAN_H
+#define UNIQUEBUILD_ENDIAN_H
+
+#include "uniquebuild_core.h"
+#include "uniquebuild_cpu.h"
+
+#include <type_traits>  // Required for std::is_integral
+
+/***************************************
+ * SECTION: Byte Order
+ * Scalar conversions. Loads and stores work on unaligned addresses and
+ * are constexpr: in constant expressions they assemble values byte by
+ * byte, at run time they compile to a single mov plus bswap (or movbe)
+ * on x86 and ldr plus rev on ARM.
+ ***************************************/
+
+#if defined(__has_builtin)
+    #if __has_builtin(__builtin_is_constant_evaluated)
+        #define UNIQUEBUILD_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+    #endif
+#elif defined(__GNUC__) && __GNUC__ >= 9
+    #define UNIQUEBUILD_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+
+namespace UniqueBuild {
+
+/**
+ * @namespace Endian
+ * Byte-order conversion.
+ */
+namespace Endian {
+
+/**
+ * True when the host stores the least significant byte first.
+ */
+#if defined(__BYTE_ORDER__)
+constexpr bool HOST_LITTLE_ENDIAN = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+#else
+constexpr bool HOST_LITTLE_ENDIAN = true;  // Every Windows target
+#endif
+
+namespace detail {
+
+template <typename T>
+struct IsSwappable {
+    static const bool value = std::is_integral<T>::value && (sizeof(T) == 1 || sizeof(T) == 2 ||
+                                                            sizeof(T) == 4 || sizeof(T) == 8);
+};
+
+template <size_t Size>
+struct UnsignedOf;
+template <> struct UnsignedOf<1> { typedef uint8_t type; };
+template <> struct UnsignedOf<2> { typedef uint16_t type; };
+template <> struct UnsignedOf<4> { typedef uint32_t type; };
+template <> struct UnsignedOf<8> { typedef uint64_t type; };
+
+constexpr uint8_t swap(uint8_t x) { return x; }
+
+constexpr uint16_t swap(uint16_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap16(x);
+#else
+    return static_cast<uint16_t>((x << 8) | (x >> 8));
+#endif
+}
+
+constexpr uint32_t swap(uint32_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap32(x);
+#else
+    return ((x & 0xFFu) << 24) | ((x & 0xFF00u) << 8) | ((x >> 8) & 0xFF00u) | (x >> 24);
+#endif
+}
+
+constexpr uint64_t swap(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap64(x);
+#else
+    return (uint64_t(swap(uint32_t(x))) << 32) | swap(uint32_t(x >> 32));
+#endif
+}
+
+}  // namespace detail
+
+/**
+ * Reverses the bytes of an integer.
+ * @param value: Any 8, 16, 32 or 64-bit integer, signed or unsigned.
+ * @return: The value with its bytes in the opposite order.
+ */
+template <typename T>
+constexpr T byteSwap(T value) {
+    static_assert(detail::IsSwappable<T>::value, "byteSwap requires a 1, 2, 4 or 8-byte integer");
+    typedef typename detail::UnsignedOf<sizeof(T)>::type U;
+    return static_cast<T>(detail::swap(static_cast<U>(value)));
+}
+
+/**
+ * Converts between host order and little-endian; the conversion is its
+ * own inverse, so the same function serves both directions.
+ */
+template <typename T>
+constexpr T toLittle(T value) {
+    return HOST_LITTLE_ENDIAN ? value : byteSwap(value);
+}
+
+/**
+ * Converts between host order and big-endian (network order).
+ */
+template <typename T>
+constexpr T toBig(T value) {
+    return HOST_LITTLE_ENDIAN ? byteSwap(value) : value;
+}
+
+namespace detail {
+
+template <typename T>
+constexpr T assembleBytes(const uint8_t* p, bool little) {
+    typedef typename UnsignedOf<sizeof(T)>::type U;
+    U value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<U>(static_cast<U>(p[i]) << (8 * (little ? i : sizeof(T) - 1 - i)));
+    }
+    return static_cast<T>(value);
+}
+
+template <typename T>
+constexpr void scatterBytes(uint8_t* p, T value, bool little) {
+    typedef typename UnsignedOf<sizeof(T)>::type U;
+    const U bits = static_cast<U>(value);
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        p[i] = static_cast<uint8_t>(bits >> (8 * (little ? i : sizeof(T) - 1 - i)));
+    }
+}
+
+template <typename T>
+constexpr T loadBytes(const uint8_t* p, bool little) {
+#ifdef UNIQUEBUILD_CONSTANT_EVALUATED
+    if (!UNIQUEBUILD_CONSTANT_EVALUATED()) {
+        typename UnsignedOf<sizeof(T)>::type value = 0;
+        __builtin_memcpy(&value, p, sizeof(value));
+        return static_cast<T>(little == HOST_LITTLE_ENDIAN ? value : swap(value));
+    }
+#endif
+    return assembleBytes<T>(p, little);
+}
+
+template <typename T>
+constexpr void storeBytes(uint8_t* p, T value, bool little) {
+#ifdef UNIQUEBUILD_CONSTANT_EVALUATED
+    if (!UNIQUEBUILD_CONSTANT_EVALUATED()) {
+        typedef typename UnsignedOf<sizeof(T)>::type U;
+        const U ordered = little == HOST_LITTLE_ENDIAN ? static_cast<U>(value) : swap(static_cast<U>(value));
+        __builtin_memcpy(p, &ordered, sizeof(ordered));
+        return;
+    }
+#endif
+    scatterBytes(p, value, little);
+}
+
+}  // namespace detail
+
+/**
+ * Reads a little-endian value from any address.
+ * @param p: The first of sizeof(T) bytes.
+ * @return: The value in host order.
+ */
+template <typename T>
+constexpr T loadLittle(const uint8_t* p) {
+    static_assert(detail::IsSwappable<T>::value, "loadLittle requires a 1, 2, 4 or 8-byte integer");
+    return detail::loadBytes<T>(p, true);
+}
+
+/**
+ * Reads a big-endian value from any address.
+ */
+template <typename T>
+constexpr T loadBig(const uint8_t* p) {
+    static_assert(detail::IsSwappable<T>::value, "loadBig requires a 1, 2, 4 or 8-byte integer");
+    return detail::loadBytes<T>(p, false);
+}
+
+/**
+ * Writes a value little-endian to any address.
+ * @param p: Receives sizeof(T) bytes.
+ * @param value: The value in host order.
+ */
+template <typename T>
+constexpr void storeLittle(uint8_t* p, T value) {
+    static_assert(detail::IsSwappable<T>::value, "storeLittle requires a 1, 2, 4 or 8-byte integer");
+    detail::storeBytes(p, value, true);
+}
+
+/**
+ * Writes a value big-endian to any address.
+ */
+template <typename T>
+constexpr void storeBig(uint8_t* p, T value) {
+    static_assert(detail::IsSwappable<T>::value, "storeBig requires a 1, 2, 4 or 8-byte integer");
+    detail::storeBytes(p, value, false);
+}
+
+// Overloads for char buffers such as std::string contents.
+template <typename T>
+inline T loadLittle(const char* p) { return loadLittle<T>(reinterpret_cast<const uint8_t*>(p)); }
+template <typename T>
+inline T loadBig(const char* p) { return loadBig<T>(reinterpret_cast<const uint8_t*>(p)); }
+template <typename T>
+inline void storeLittle(char* p, T value) { storeLittle(reinterpret_cast<uint8_t*>(p), value); }
+template <typename T>
+inline void storeBig(char* p, T value) { storeBig(reinterpret_cast<uint8_t*>(p), value); }
+
+}  // namespace Endian
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: Bulk Byte Swap
+ * Reverses the bytes of every element of an array, 32 bytes per step
+ * with AVX2, 16 with SSSE3 or NEON, selected at run time. Used to
+ * convert big-endian sample buffers and file formats in one pass.
+ ***************************************/
+
+namespace UniqueBuild {
+
+namespace Endian {
+
+namespace detail {
+
+/**
+ * pshufb control that reverses each element of the given width within
+ * a 16-byte lane.
+ */
+inline const uint8_t* swapShuffle(size_t width) {
+    alignas(16) static const uint8_t masks[3][16] = {
+        {1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14},
+        {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12},
+        {7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8}};
+    return masks[width == 2 ? 0 : width == 4 ? 1 : 2];
+}
+
+template <typename U>
+inline void swapScalar(U* dst, const U* src, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = swap(src[i]);
+    }
+}
+
+#ifdef UNIQUEBUILD_X86_DISPATCH
+/**
+ * @return: Number of bytes handled; the caller finishes the tail.
+ */
+UNIQUEBUILD_TARGET("avx2")
+inline size_t swapAvx2(uint8_t* dst, const uint8_t* src, size_t bytes, size_t width) {
+    const __m128i lane = _mm_load_si128(reinterpret_cast<const __m128i*>(swapShuffle(width)));
+    const __m256i mask = _mm256_broadcastsi128_si256(lane);
+    size_t i = 0;
+    for (; i + 128 <= bytes; i += 128) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32));
+        const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 64));
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 96));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_shuffle_epi8(a, mask));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 32), _mm256_shuffle_epi8(b, mask));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 64), _mm256_shuffle_epi8(c, mask));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 96), _mm256_shuffle_epi8(d, mask));
+    }
+    for (; i + 32 <= bytes; i += 32) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_shuffle_epi8(a, mask));
+    }
+    return i;
+}
+
+UNIQUEBUILD_TARGET("ssse3")
+inline size_t swapSsse3(uint8_t* dst, const uint8_t* src, size_t bytes, size_t width) {
+    const __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i*>(swapShuffle(width)));
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi8(a, mask));
+    }
+    return i;
+}
+#endif
+
+#ifdef UNIQUEBUILD_NEON
+inline size_t swapNeon(uint8_t* dst, const uint8_t* src, size_t bytes, size_t width) {
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        const uint8x16_t a = vld1q_u8(src + i);
+        vst1q_u8(dst + i, width == 2 ? vrev16q_u8(a) : width == 4 ? vrev32q_u8(a) : vrev64q_u8(a));
+    }
+    return i;
+}
+#endif
+
+/**
+ * Swaps as many whole vectors as the CPU allows.
+ * @return: Number of bytes handled.
+ */
+inline size_t swapVector(uint8_t* dst, const uint8_t* src, size_t bytes, size_t width) {
+#ifdef UNIQUEBUILD_X86_DISPATCH
+    if (Cpu::hasAvx2()) return swapAvx2(dst, src, bytes, width);
+    if (Cpu::hasSsse3()) return swapSsse3(dst, src, bytes, width);
+#endif
+#ifdef UNIQUEBUILD_NEON
+    return swapNeon(dst, src, bytes, width);
+#else
+    (void)dst;
+    (void)src;
+    (void)bytes;
+    (void)width;
+    return 0;
+#endif
+}
+
+}  // namespace detail
+
+/**
+ * Byte-swaps count elements from src into dst.
+ * @param dst: Receives the swapped elements; may be src itself, but must
+ *             not otherwise overlap it.
+ * @param src: The elements to swap.
+ * @param count: Number of elements, not bytes.
+ */
+template <typename T>
+inline void byteSwapArray(T* dst, const T* src, size_t count) {
+    static_assert(detail::IsSwappable<T>::value, "byteSwapArray requires a 1, 2, 4 or 8-byte integer");
+    if (sizeof(T) == 1) {
+        if (dst != src) std::memmove(dst, src, count);
+        return;
+    }
+    typedef typename detail::UnsignedOf<sizeof(T)>::type U;
+    const size_t done = detail::swapVector(reinterpret_cast<uint8_t*>(dst), reinterpret_cast<const uint8_t*>(src),
+                                           count * sizeof(T), sizeof(T)) / sizeof(T);
+    detail::swapScalar(reinterpret_cast<U*>(dst) + done, reinterpret_cast<const U*>(src) + done, count - done);
+}
+
+/**
+ * Byte-swaps count elements in place.
+ */
+template <typename T>
+inline void byteSwapArray(T* data, size_t count) {
+    byteSwapArray(data, data, count);
+}
+
+/**
+ * Converts an array between host order and big-endian in place; does
+ * nothing on big-endian hosts.
+ */
+template <typename T>
+inline void bigToHostArray(T* data, size_t count) {
+    if (HOST_LITTLE_ENDIAN) byteSwapArray(data, count);
+}
+
+/**
+ * Converts an array between host order and little-endian in place; does
+ * nothing on little-endian hosts.
+ */
+template <typename T>
+inline void littleToHostArray(T* data, size_t count) {
+    if (!HOST_LITTLE_ENDIAN) byteSwapArray(data, count);
+}
+
+}  // namespace Endian
+
+}  // namespace UniqueBuild
+
+#endif  // UNIQUEBUILD_ENDIAN_H
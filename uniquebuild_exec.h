@@ -0,0 +1,2050 @@
+/***************************************
+ * uniquebuild_exec.h
+ * Command execution, the build graph and its caches, the compilation
+ * database, the build daemon, watch mode, precompiled headers, unity
+ * builds and the recipe entry point.
+ *
+ * Part of uniquebuild; see uniquebuild.h.
+ ***************************************/
+
+#ifndef UNIQUEBUILD_EXEC_H
+#define UNIQUEBUILD_EXEC_H
+
+#include "uniquebuild_core.h"
+#include "uniquebuild_strings.h"
+#include "uniquebuild_log.h"
+#include "uniquebuild_fs.h"
+#include "uniquebuild_hash.h"
+#include "uniquebuild_paths.h"
+
+#include <thread>       // Required for std::this_thread::sleep_for
+#include <chrono>       // Required for std::chrono::milliseconds
+
+/***************************************
+ * SECTION: Command Execution
+ * Runs build commands as child processes without going through a shell.
+ ***************************************/
+
+#ifdef UNIQUEBUILD_POSIX
+    #include <sys/wait.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <csignal>
+    #include <cerrno>
+#endif
+
+namespace UniqueBuild {
+
+/**
+ * @namespace Exec
+ * Process spawning for recipes.
+ */
+namespace Exec {
+
+/**
+ * Joins a command line for logging, quoting arguments that contain spaces.
+ * @param argv: The command and its arguments.
+ * @return: A printable command line.
+ */
+inline std::string quoteCommand(const std::vector<std::string>& argv) {
+    std::string line;
+    for (const std::string& arg : argv) {
+        if (!line.empty()) line.push_back(' ');
+        if (arg.empty() || arg.find_first_of(" \t\"'") != std::string::npos) {
+            line.push_back('\'');
+            line.append(arg);
+            line.push_back('\'');
+        } else {
+            line.append(arg);
+        }
+    }
+    return line;
+}
+
+/**
+ * Runs a command and waits for it. The child inherits stdout and stderr.
+ * @param argv: The command and its arguments; argv[0] is looked up in PATH.
+ * @return: The exit status, 128 + signal number if it was killed, or -1
+ *          if it could not be started.
+ */
+inline int runCommand(const std::vector<std::string>& argv) {
+    if (argv.empty()) return -1;
+    LOG_INFO(("CMD: " + quoteCommand(argv)).c_str());
+    std::fflush(stdout);
+    std::fflush(stderr);
+#ifdef UNIQUEBUILD_POSIX
+    std::vector<char*> args;
+    args.reserve(argv.size() + 1);
+    for (const std::string& arg : argv) {
+        args.push_back(const_cast<char*>(arg.c_str()));
+    }
+    args.push_back(nullptr);
+    const pid_t pid = ::fork();
+    if (pid < 0) return -1;
+    if (pid == 0) {
+        ::execvp(args[0], args.data());
+        _exit(127);
+    }
+    int status = 0;
+    while (::waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) return -1;
+    }
+    if (WIFEXITED(status)) return WEXITSTATUS(status);
+    if (WIFSIGNALED(status)) return 128 + WTERMSIG(status);
+    return -1;
+#else
+    return std::system(quoteCommand(argv).c_str());
+#endif
+}
+
+/**
+ * Runs a command in another directory and waits for it.
+ * @param argv: The command and its arguments; argv[0] is looked up in PATH.
+ * @param directory: Working directory of the command.
+ * @param output: If not null, receives everything the command wrote to
+ *                stdout and stderr; otherwise both are inherited.
+ * @return: As runCommand. Always -1 where fork() is unavailable.
+ */
+inline int runCommandIn(const std::vector<std::string>& argv, const std::string& directory, std::string* output) {
+    if (argv.empty()) return -1;
+#ifdef UNIQUEBUILD_POSIX
+    std::vector<char*> args;
+    args.reserve(argv.size() + 1);
+    for (const std::string& arg : argv) {
+        args.push_back(const_cast<char*>(arg.c_str()));
+    }
+    args.push_back(nullptr);
+    // Close-on-exec, so children that other threads fork meanwhile do not
+    // inherit the write end and keep the read below from seeing EOF.
+    int pipeFds[2] = {-1, -1};
+#ifdef OS_MAC
+    if (output) {
+        if (::pipe(pipeFds) != 0) return -1;
+        ::fcntl(pipeFds[0], F_SETFD, FD_CLOEXEC);
+        ::fcntl(pipeFds[1], F_SETFD, FD_CLOEXEC);
+    }
+#else
+    if (output && ::pipe2(pipeFds, O_CLOEXEC) != 0) return -1;
+#endif
+    std::fflush(stdout);
+    std::fflush(stderr);
+    const pid_t pid = ::fork();
+    if (pid < 0) {
+        if (output) {
+            ::close(pipeFds[0]);
+            ::close(pipeFds[1]);
+        }
+        return -1;
+    }
+    if (pid == 0) {
+        if (output) {
+            ::dup2(pipeFds[1], 1);
+            ::dup2(pipeFds[1], 2);
+            ::close(pipeFds[0]);
+            ::close(pipeFds[1]);
+        }
+        if (::chdir(directory.c_str()) != 0) _exit(127);
+        ::execvp(args[0], args.data());
+        _exit(127);
+    }
+    if (output) {
+        ::close(pipeFds[1]);
+        char buffer[BUFFER_SIZE_2048 * 2];
+        for (;;) {
+            const ssize_t n = ::read(pipeFds[0], buffer, sizeof(buffer));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            output->append(buffer, size_t(n));
+        }
+        ::close(pipeFds[0]);
+    }
+    int status = 0;
+    while (::waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) return -1;
+    }
+    if (WIFEXITED(status)) return WEXITSTATUS(status);
+    if (WIFSIGNALED(status)) return 128 + WTERMSIG(status);
+    return -1;
+#else
+    (void)directory;
+    (void)output;
+    return -1;
+#endif
+}
+
+}  // namespace Exec
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: Build Graph
+ * Targets, their inputs and the commands that produce them, plus the
+ * caches that decide what is out of date: a stat cache and a content-hash
+ * cache keyed by PathId. A target is rebuilt when its output is missing
+ * or when the signature of its command and input contents changed since
+ * its last successful build. The first time a target is seen in a
+ * process, an output newer than all inputs counts as up to date.
+ * Inputs found in compiler depfiles (-MMD) are tracked as well.
+ ***************************************/
+
+#if !defined(UNIQUEBUILD_POSIX)
+    #include <filesystem>
+#endif
+
+namespace UniqueBuild {
+
+/**
+ * @namespace Build
+ * Build graph, caches, and the resident daemon.
+ */
+namespace Build {
+
+/**
+ * @struct FileStamp
+ * What a stat() call says about a file.
+ */
+struct FileStamp {
+    bool exists;  // False if the file is missing
+    int64_t mtimeNs;  // Modification time in nanoseconds since the epoch
+    uint64_t size;  // File size in bytes
+};
+
+/**
+ * Stats a file directly, bypassing any cache.
+ * @param filename: The file to stat.
+ * @return: Its stamp; exists is false if it cannot be stat'ed.
+ */
+inline FileStamp statFile(const char* filename) {
+    FileStamp stamp = {false, 0, 0};
+#ifdef UNIQUEBUILD_POSIX
+    struct stat st;
+    if (::stat(filename, &st) != 0) return stamp;
+    stamp.exists = true;
+    stamp.size = static_cast<uint64_t>(st.st_size);
+#if defined(OS_MAC)
+    stamp.mtimeNs = int64_t(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    stamp.mtimeNs = int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+#else
+    std::error_code ec;
+    const std::filesystem::path path(filename);
+    const auto time = std::filesystem::last_write_time(path, ec);
+    if (ec) return stamp;
+    stamp.exists = true;
+    stamp.size = std::filesystem::is_regular_file(path, ec) ? std::filesystem::file_size(path, ec) : 0;
+    stamp.mtimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+#endif
+    return stamp;
+}
+
+/**
+ * @class StatCache
+ * Memoized stat() results by PathId. Entries stay valid until
+ * invalidated; clear() forces every path to be stat'ed again.
+ */
+class StatCache {
+public:
+    explicit StatCache(PathTable& paths) : paths_(paths), statCalls_(0) {}
+
+    /**
+     * @return: The cached stamp, stat'ing the path on first use.
+     */
+    const FileStamp& stat(PathId id) {
+        if (id >= valid_.size()) {
+            valid_.resize(paths_.size(), 0);
+            stamps_.resize(paths_.size());
+        }
+        if (!valid_[id]) {
+            stamps_[id] = statFile(paths_.view(id).data());
+            valid_[id] = 1;
+            ++statCalls_;
+        }
+        return stamps_[id];
+    }
+
+    void invalidate(PathId id) {
+        if (id < valid_.size()) valid_[id] = 0;
+    }
+
+    void clear() { std::fill(valid_.begin(), valid_.end(), 0); }
+
+    /**
+     * @return: Number of real stat() calls made so far.
+     */
+    size_t statCalls() const { return statCalls_; }
+
+private:
+    PathTable& paths_;  // Names for the ids
+    std::vector<FileStamp> stamps_;  // Stamp by PathId
+    std::vector<uint8_t> valid_;  // 1 where stamps_ is current
+    size_t statCalls_;  // Counter for diagnostics
+};
+
+/**
+ * @class HashCache
+ * Content hashes by PathId. A file is rehashed only when its stamp
+ * (mtime and size) differs from the one it was hashed at.
+ */
+class HashCache {
+public:
+    explicit HashCache(PathTable& paths) : paths_(paths), hashCalls_(0) {}
+
+    /**
+     * @param id: The file.
+     * @param stamp: Its current stamp, from a StatCache.
+     * @return: Hash of its contents; zero if it cannot be read.
+     */
+    Hash::Hash128 contentHash(PathId id, const FileStamp& stamp) {
+        if (id >= entries_.size()) entries_.resize(paths_.size());
+        Entry& entry = entries_[id];
+        if (!entry.valid || entry.mtimeNs != stamp.mtimeNs || entry.size != stamp.size) {
+            entry.hash = Hash::Hash128{0, 0};
+            if (stamp.exists) Hash::hashFile(paths_.str(id), entry.hash);
+            entry.mtimeNs = stamp.mtimeNs;
+            entry.size = stamp.size;
+            entry.valid = true;
+            ++hashCalls_;
+        }
+        return entry.hash;
+    }
+
+    size_t hashCalls() const { return hashCalls_; }
+
+private:
+    struct Entry {
+        Hash::Hash128 hash = {0, 0};
+        int64_t mtimeNs = 0;
+        uint64_t size = 0;
+        bool valid = false;
+    };
+
+    PathTable& paths_;  // Names for the ids
+    std::vector<Entry> entries_;  // Entry by PathId
+    size_t hashCalls_;  // Counter for diagnostics
+};
+
+/**
+ * Parses a Makefile-style dependency file as written by gcc/clang -MD.
+ * @param text: The depfile contents.
+ * @param out: Receives the prerequisites (everything after the first ':').
+ */
+inline void parseDepfile(std::string_view text, std::vector<std::string>& out) {
+    out.clear();
+    size_t i = 0;
+    // Skip the target list; a ':' followed by a separator ends it (so "C:\" is not the end).
+    for (; i < text.size(); ++i) {
+        if (text[i] == ':' && (i + 1 == text.size() || text[i + 1] == ' ' || text[i + 1] == '\n' ||
+                               text[i + 1] == '\r' || text[i + 1] == '\t')) {
+            ++i;
+            break;
+        }
+    }
+    std::string token;
+    for (; i <= text.size(); ++i) {
+        const char c = i < text.size() ? text[i] : '\n';
+        if (c == '\\' && i + 1 < text.size()) {
+            const char next = text[i + 1];
+            if (next == '\n' || next == '\r') {
+                // Line continuation: acts as a separator.
+                ++i;
+                if (next == '\r' && i + 1 < text.size() && text[i + 1] == '\n') ++i;
+                if (!token.empty()) {
+                    out.push_back(token);
+                    token.clear();
+                }
+                continue;
+            }
+            if (next == ' ' || next == '#') {
+                token.push_back(next);
+                ++i;
+                continue;
+            }
+        }
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            if (!token.empty()) {
+                out.push_back(token);
+                token.clear();
+            }
+            if (c == '\n') {
+                // A second rule (e.g. from -MP) starts; its targets are not inputs.
+                size_t j = i + 1;
+                while (j < text.size() && text[j] != ':' && text[j] != '\n') ++j;
+                if (j < text.size() && text[j] == ':') i = j;
+            }
+            continue;
+        }
+        token.push_back(c);
+    }
+}
+
+/**
+ * @struct Target
+ * One output, the inputs it depends on and the command that produces it.
+ */
+struct Target {
+    PathId output;  // The file the command produces
+    std::vector<PathId> inputs;  // Declared inputs
+    std::vector<PathId> discovered;  // Inputs read from the depfile after the last build
+    std::vector<std::string> command;  // argv of the command
+    PathId depfile;  // Depfile written by the command, or INVALID_PATH_ID
+    Hash::Hash128 signature;  // Command and input hash at the last successful build
+    bool hasSignature;  // False until the target has been checked once
+    bool dirty;  // Set by markDirty; forces a signature check
+    std::vector<std::vector<std::string>> fallback;  // Run in order if command fails
+    std::vector<PathId> fallbackDepfiles;  // Depfiles the fallback writes; merged into depfile
+    bool usedFallback;  // True if the last build of this target needed the fallback
+};
+
+/**
+ * @struct BuildStats
+ * Counters for one build() call.
+ */
+struct BuildStats {
+    size_t executed;  // Commands run
+    size_t upToDate;  // Targets skipped
+    size_t failed;  // Commands that failed
+};
+
+/**
+ * @class CommandRunner
+ * Runs the command of a target in place of Exec::runCommand, e.g. on a
+ * remote worker. See Graph::setRunner.
+ */
+class CommandRunner {
+public:
+    virtual ~CommandRunner() {}
+
+    /**
+     * Runs target.command so that it produces target.output.
+     * @return: The command's exit status; 0 on success.
+     */
+    virtual int run(const Target& target) = 0;
+
+    /**
+     * Runs targets that do not depend on each other, e.g. all at once on
+     * a worker. The default runs them one by one with run().
+     * @param targets: Targets whose inputs are all built.
+     * @param statuses: Receives one exit status per target.
+     */
+    virtual void runBatch(const std::vector<const Target*>& targets, std::vector<int>& statuses) {
+        statuses.resize(targets.size());
+        for (size_t i = 0; i < targets.size(); ++i) {
+            statuses[i] = run(*targets[i]);
+        }
+    }
+};
+
+/**
+ * @class Graph
+ * The set of targets of a recipe. Inputs that are outputs of other
+ * targets are built first. Without a runner, commands run one at a time
+ * and the first failure stops the build. With one, targets are built in
+ * waves of independent commands handed to CommandRunner::runBatch; a
+ * failure stops the build after its wave.
+ */
+class Graph {
+public:
+    explicit Graph(PathTable& paths) : paths_(paths), stats_(paths), hashes_(paths), runner_(nullptr) {}
+
+    /**
+     * Adds a target.
+     * @param output: The file the command produces.
+     * @param inputs: Files the command reads.
+     * @param command: argv of the command.
+     * @param depfile: Optional depfile the command writes (e.g. with -MMD -MF).
+     * @return: Index of the target.
+     */
+    size_t addTarget(std::string_view output, const std::vector<std::string>& inputs,
+                     const std::vector<std::string>& command, std::string_view depfile = std::string_view()) {
+        Target target;
+        target.output = paths_.intern(output);
+        for (const std::string& input : inputs) {
+            target.inputs.push_back(paths_.intern(input));
+        }
+        target.command = command;
+        target.depfile = depfile.empty() ? INVALID_PATH_ID : paths_.intern(depfile);
+        target.signature = Hash::Hash128{0, 0};
+        target.hasSignature = false;
+        target.dirty = true;
+        target.usedFallback = false;
+        targets_.push_back(target);
+        const uint32_t index = static_cast<uint32_t>(targets_.size() - 1);
+        if (producer_.size() <= target.output) producer_.resize(paths_.size(), -1);
+        producer_[target.output] = static_cast<int32_t>(index);
+        addReader(target.output, index);
+        if (target.depfile != INVALID_PATH_ID) addReader(target.depfile, index);
+        for (PathId input : target.inputs) {
+            addReader(input, index);
+        }
+        return index;
+    }
+
+    /**
+     * Builds the given outputs, or every target if none are given.
+     * @param goals: Outputs to build.
+     * @param stats: Optional; receives counters for this build.
+     * @return: 0 on success, otherwise the exit status of the failing command.
+     */
+    int build(const std::vector<PathId>& goals = std::vector<PathId>(), BuildStats* stats = nullptr) {
+        visited_.assign(targets_.size(), 0);
+        BuildStats counters = {0, 0, 0};
+        std::vector<size_t> roots;
+        bool missing = false;
+        if (goals.empty()) {
+            for (size_t i = 0; i < targets_.size(); ++i) roots.push_back(i);
+        } else {
+            for (size_t g = 0; g < goals.size() && !missing; ++g) {
+                const int32_t index = producerOf(goals[g]);
+                if (index < 0) {
+                    LOG_ERROR(("no target produces " + paths_.str(goals[g])).c_str());
+                    missing = true;
+                } else {
+                    roots.push_back(size_t(index));
+                }
+            }
+        }
+        int result = 0;
+        if (runner_) {
+            result = buildInWaves(roots, counters);
+        } else {
+            for (size_t i = 0; i < roots.size() && result == 0; ++i) {
+                result = buildTarget(roots[i], counters);
+            }
+        }
+        if (result == 0 && missing) result = 1;
+        if (stats) *stats = counters;
+        return result;
+    }
+
+    /**
+     * Sets what runs target commands; null (the default) runs them locally.
+     * Fallback commands always run locally.
+     * @param runner: Must outlive its use by the graph.
+     */
+    void setRunner(CommandRunner* runner) { runner_ = runner; }
+
+    /**
+     * Gives a target commands to run, in order, when its command fails.
+     * The target succeeds if they all do; Target::usedFallback tells
+     * afterwards whether they were needed.
+     * @param index: Index returned by addTarget.
+     * @param commands: argv of each fallback command.
+     * @param depfiles: Depfiles the commands write; after a successful
+     *                  fallback they replace the target's own depfile.
+     */
+    void setFallback(size_t index, const std::vector<std::vector<std::string>>& commands,
+                     const std::vector<std::string>& depfiles = std::vector<std::string>()) {
+        targets_[index].fallback = commands;
+        targets_[index].fallbackDepfiles.clear();
+        for (const std::string& depfile : depfiles) {
+            targets_[index].fallbackDepfiles.push_back(paths_.intern(depfile));
+        }
+    }
+
+    /**
+     * Records that a file changed: forgets its cached stat and flags every
+     * target that reads or produces it.
+     * @param changed: The changed file.
+     * @return: Number of targets flagged.
+     */
+    size_t markDirty(PathId changed) {
+        stats_.invalidate(changed);
+        if (changed >= readers_.size()) return 0;
+        for (uint32_t index : readers_[changed]) {
+            targets_[index].dirty = true;
+        }
+        return readers_[changed].size();
+    }
+
+    /**
+     * Marks every target dirty and forgets all cached stats, e.g. before a
+     * build when nothing reports file changes.
+     */
+    void invalidateAll() {
+        stats_.clear();
+        for (Target& target : targets_) {
+            target.dirty = true;
+        }
+    }
+
+    int32_t producerOf(PathId output) const {
+        return output < producer_.size() ? producer_[output] : -1;
+    }
+
+    const std::vector<Target>& targets() const { return targets_; }
+    PathTable& paths() { return paths_; }
+    StatCache& statCache() { return stats_; }
+    HashCache& hashCache() { return hashes_; }
+
+private:
+    void addReader(PathId path, uint32_t index) {
+        if (readers_.size() <= path) readers_.resize(paths_.size());
+        std::vector<uint32_t>& list = readers_[path];
+        if (std::find(list.begin(), list.end(), index) == list.end()) list.push_back(index);
+    }
+
+    Hash::Hash128 signatureOf(const Target& target) {
+        std::string material;
+        for (const std::string& arg : target.command) {
+            material.append(arg);
+            material.push_back('\0');
+        }
+        const std::vector<PathId>* lists[2] = {&target.inputs, &target.discovered};
+        for (const std::vector<PathId>* list : lists) {
+            for (PathId input : *list) {
+                const Hash::Hash128 h = hashes_.contentHash(input, stats_.stat(input));
+                material.append(paths_.view(input));
+                material.append(reinterpret_cast<const char*>(&h), sizeof(h));
+            }
+        }
+        return Hash::hash128(material);
+    }
+
+    bool outputNewerThanInputs(const Target& target) {
+        const FileStamp& out = stats_.stat(target.output);
+        if (!out.exists) return false;
+        const std::vector<PathId>* lists[2] = {&target.inputs, &target.discovered};
+        for (const std::vector<PathId>* list : lists) {
+            for (PathId input : *list) {
+                const FileStamp& in = stats_.stat(input);
+                if (!in.exists || in.mtimeNs > out.mtimeNs) return false;
+            }
+        }
+        return true;
+    }
+
+    // Replaces the depfile the failed command left with the fallback's
+    // depfiles, one rule after another, so the next read sees what the
+    // fallback compiles actually included.
+    void mergeFallbackDepfiles(const Target& target) {
+        if (target.depfile == INVALID_PATH_ID) return;
+        std::string merged;
+        for (PathId part : target.fallbackDepfiles) {
+            FileUtils::MappedFile file;
+            if (!file.open(paths_.str(part))) continue;
+            merged.append(file.view());
+            if (!merged.empty() && merged.back() != '\n') merged.push_back('\n');
+        }
+        const std::string name = paths_.str(target.depfile);
+        if (!FileUtils::writeFileIfChanged(name, merged)) LOG_ERROR(("could not write " + name).c_str());
+    }
+
+    void readDepfile(size_t index) {
+        Target& target = targets_[index];
+        target.discovered.clear();
+        if (target.depfile == INVALID_PATH_ID) return;
+        stats_.invalidate(target.depfile);
+        FileUtils::MappedFile file;
+        if (!file.open(paths_.str(target.depfile))) return;
+        std::vector<std::string> names;
+        parseDepfile(file.view(), names);
+        for (const std::string& name : names) {
+            const PathId id = paths_.intern(name);
+            if (std::find(target.inputs.begin(), target.inputs.end(), id) == target.inputs.end()) {
+                target.discovered.push_back(id);
+                addReader(id, static_cast<uint32_t>(index));
+            }
+        }
+    }
+
+    int buildTarget(size_t index, BuildStats& counters) {
+        if (visited_[index]) return 0;
+        visited_[index] = 1;
+        const std::vector<PathId> inputs = targets_[index].inputs;
+        for (PathId input : inputs) {
+            const int32_t producer = producerOf(input);
+            if (producer >= 0) {
+                const int result = buildTarget(size_t(producer), counters);
+                if (result != 0) return result;
+            }
+        }
+
+        if (checkUpToDate(index, counters)) return 0;
+        const int status = runner_ ? runner_->run(targets_[index]) : Exec::runCommand(targets_[index].command);
+        return finishTarget(index, status, counters);
+    }
+
+    // Appends index after the targets producing its inputs and sets its
+    // wave: one more than the highest wave among them.
+    void collectWaves(size_t index, std::vector<uint32_t>& wave, std::vector<size_t>& order) {
+        if (visited_[index]) return;
+        visited_[index] = 1;
+        uint32_t level = 0;
+        for (PathId input : targets_[index].inputs) {
+            const int32_t producer = producerOf(input);
+            if (producer >= 0) {
+                collectWaves(size_t(producer), wave, order);
+                level = MAX(level, wave[size_t(producer)] + 1);
+            }
+        }
+        wave[index] = level;
+        order.push_back(index);
+    }
+
+    int buildInWaves(const std::vector<size_t>& roots, BuildStats& counters) {
+        std::vector<uint32_t> wave(targets_.size(), 0);
+        std::vector<size_t> order;
+        for (size_t root : roots) collectWaves(root, wave, order);
+        std::vector<std::vector<size_t>> waves;
+        for (size_t index : order) {
+            if (waves.size() <= wave[index]) waves.resize(wave[index] + 1);
+            waves[wave[index]].push_back(index);
+        }
+        std::vector<size_t> batch;
+        std::vector<const Target*> commands;
+        std::vector<int> statuses;
+        for (const std::vector<size_t>& members : waves) {
+            batch.clear();
+            commands.clear();
+            for (size_t index : members) {
+                if (!checkUpToDate(index, counters)) {
+                    batch.push_back(index);
+                    commands.push_back(&targets_[index]);
+                }
+            }
+            if (batch.empty()) continue;
+            statuses.clear();
+            runner_->runBatch(commands, statuses);
+            int result = 0;
+            for (size_t i = 0; i < batch.size(); ++i) {
+                const int status = finishTarget(batch[i], i < statuses.size() ? statuses[i] : -1, counters);
+                if (result == 0) result = status;
+            }
+            if (result != 0) return result;
+        }
+        return 0;
+    }
+
+    // Reads the depfile if needed and compares signatures.
+    // @return: True if the target is up to date (and counted as such).
+    bool checkUpToDate(size_t index, BuildStats& counters) {
+        Target& target = targets_[index];
+        if (!target.hasSignature && target.depfile != INVALID_PATH_ID) readDepfile(index);
+        if (!target.dirty && target.hasSignature && stats_.stat(target.output).exists) {
+            ++counters.upToDate;
+            return true;
+        }
+        const Hash::Hash128 signature = signatureOf(target);
+        const bool upToDate = target.hasSignature ? (signature == target.signature && stats_.stat(target.output).exists)
+                                                  : outputNewerThanInputs(target);
+        if (upToDate) {
+            target.signature = signature;
+            target.hasSignature = true;
+            target.dirty = false;
+            ++counters.upToDate;
+        }
+        return upToDate;
+    }
+
+    // Runs the fallback if the command failed, then records the result.
+    int finishTarget(size_t index, int status, BuildStats& counters) {
+        Target& target = targets_[index];
+        target.usedFallback = false;
+        if (status != 0 && !target.fallback.empty()) {
+            LOG_WARN(("retrying " + paths_.str(target.output) + " with its fallback commands").c_str());
+            status = 0;
+            for (size_t i = 0; i < target.fallback.size() && status == 0; ++i) {
+                status = Exec::runCommand(target.fallback[i]);
+            }
+            target.usedFallback = status == 0;
+        }
+        stats_.invalidate(target.output);
+        if (status != 0) {
+            ++counters.failed;
+            target.hasSignature = false;
+            return status;
+        }
+        ++counters.executed;
+        if (target.usedFallback) mergeFallbackDepfiles(target);
+        readDepfile(index);
+        // Targets that read this output must re-check their signature.
+        markDirty(targets_[index].output);
+        Target& built = targets_[index];
+        built.signature = signatureOf(built);
+        built.hasSignature = true;
+        built.dirty = false;
+        return 0;
+    }
+
+    PathTable& paths_;  // Interned names of all files
+    StatCache stats_;  // Cached stat() results
+    HashCache hashes_;  // Cached content hashes
+    std::vector<Target> targets_;  // All targets
+    std::vector<int32_t> producer_;  // Target index by output PathId, -1 if none
+    std::vector<std::vector<uint32_t>> readers_;  // Indexes of targets reading each PathId
+    std::vector<uint8_t> visited_;  // Per-build visit marks
+    CommandRunner* runner_;  // Runs commands; null for Exec::runCommand
+};
+
+}  // namespace Build
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: Compilation Database
+ * Writes compile_commands.json for clangd and other tooling from the
+ * compile targets of a Graph. Entries are serialized once and cached per
+ * target; on later updates only targets whose command changed are
+ * serialized again, and the file is left untouched (mtime included) when
+ * its content would not change.
+ ***************************************/
+
+/**
+ * COMPILE_COMMANDS_PATH: Default location of the compilation database.
+ */
+#define COMPILE_COMMANDS_PATH "compile_commands.json"
+
+namespace UniqueBuild {
+
+namespace Build {
+
+/**
+ * Checks whether a file is a translation unit clang tooling understands.
+ * @param path: File name.
+ * @return: True for C, C++, Objective-C and CUDA sources.
+ */
+inline bool isCompileSource(std::string_view path) {
+    static const char* const EXTENSIONS[] = {".c", ".cc", ".cpp", ".cxx", ".c++", ".C", ".m", ".mm", ".cu"};
+    const size_t dot = path.rfind('.');
+    if (dot == std::string_view::npos) return false;
+    const std::string_view extension = path.substr(dot);
+    for (const char* candidate : EXTENSIONS) {
+        if (extension == candidate) return true;
+    }
+    return false;
+}
+
+/**
+ * @class CompilationDatabase
+ * Mirrors the compile targets of a graph into a compile_commands.json.
+ * A target counts as a compile when one of its declared inputs is a
+ * source file (see isCompileSource); that input becomes "file".
+ */
+class CompilationDatabase {
+public:
+    /**
+     * @param directory: Directory the commands run in; defaults to the
+     *                   current working directory.
+     */
+    explicit CompilationDatabase(const std::string& directory = std::string())
+        : directory_(directory.empty() ? FileUtils::currentDirectory() : directory), serialized_(0) {}
+
+    /**
+     * Brings the cached entries in line with the graph.
+     * @param graph: The recipe's graph.
+     * @return: Number of entries serialized again (new or changed).
+     */
+    size_t update(Graph& graph) {
+        const std::vector<Target>& targets = graph.targets();
+        if (entries_.size() < targets.size()) entries_.resize(targets.size());
+        size_t changed = 0;
+        for (size_t i = 0; i < targets.size(); ++i) {
+            const Target& target = targets[i];
+            Entry& entry = entries_[i];
+            PathId source = INVALID_PATH_ID;
+            for (PathId input : target.inputs) {
+                if (isCompileSource(graph.paths().view(input))) {
+                    source = input;
+                    break;
+                }
+            }
+            if (source == INVALID_PATH_ID || target.command.empty()) {
+                if (!entry.json.empty()) ++changed;
+                entry.json.clear();
+                continue;
+            }
+            const uint64_t key = entryKey(graph.paths(), target, source);
+            if (!entry.json.empty() && entry.key == key) continue;
+            entry.key = key;
+            serialize(graph.paths(), target, source, entry.json);
+            ++changed;
+        }
+        serialized_ += changed;
+        return changed;
+    }
+
+    /**
+     * Writes the database if its content differs from the file on disk.
+     * The new content goes to a temporary file that is renamed into place,
+     * so readers never see a partial file.
+     * @param filename: Output path.
+     * @return: True if the file is up to date afterwards.
+     */
+    bool write(const std::string& filename = COMPILE_COMMANDS_PATH) const {
+        if (matchesFile(filename)) return true;
+        const std::string temporary = filename + ".tmp";
+        std::FILE* file = std::fopen(temporary.c_str(), "wb");
+        if (!file) return false;
+        {
+            Format::BufferedSink sink(file);
+            writeTo(sink);
+        }
+        const bool ok = std::ferror(file) == 0;
+        if (std::fclose(file) != 0 || !ok || std::rename(temporary.c_str(), filename.c_str()) != 0) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Streams the database into any JSON sink.
+     */
+    template <typename Sink>
+    void writeTo(Sink& sink) const {
+        bool first = true;
+        sink.put('[');
+        for (const Entry& entry : entries_) {
+            if (entry.json.empty()) continue;
+            sink.append(first ? "\n  " : ",\n  ");
+            sink.append(entry.json);
+            first = false;
+        }
+        sink.append(first ? "]\n" : "\n]\n");
+    }
+
+    /**
+     * @return: Number of entries currently in the database.
+     */
+    size_t size() const {
+        size_t count = 0;
+        for (const Entry& entry : entries_) {
+            count += !entry.json.empty();
+        }
+        return count;
+    }
+
+    /**
+     * @return: Total entries serialized so far; unchanged entries are not counted.
+     */
+    size_t serializedCount() const { return serialized_; }
+
+    const std::string& directory() const { return directory_; }
+
+private:
+    struct Entry {
+        uint64_t key = 0;  // Hash of everything the JSON depends on
+        std::string json;  // Serialized object, empty if the target is not a compile
+    };
+
+    static uint64_t entryKey(const PathTable& paths, const Target& target, PathId source) {
+        uint64_t key = paths.hash(source) ^ (paths.hash(target.output) * Hash::detail::PRIME64_2);
+        for (const std::string& arg : target.command) {
+            key = Hash::hash64(arg.data(), arg.size(), key);
+        }
+        return key;
+    }
+
+    void serialize(const PathTable& paths, const Target& target, PathId source, std::string& out) const {
+        Json::StringSink sink;
+        Json::Writer<Json::StringSink> json(sink);
+        json.beginObject();
+        json.field("directory", directory_);
+        json.field("file", paths.view(source));
+        json.field("output", paths.view(target.output));
+        json.key("arguments").beginArray();
+        for (const std::string& arg : target.command) {
+            json.value(arg);
+        }
+        json.endArray();
+        json.endObject();
+        out = sink.str();
+    }
+
+    // Compares the would-be content with the file without building it in memory.
+    bool matchesFile(const std::string& filename) const {
+        FileUtils::MappedFile existing;
+        if (!existing.open(filename)) return false;
+        std::string_view rest = existing.view();
+        bool first = true;
+        auto consume = [&rest](std::string_view piece) {
+            if (rest.substr(0, piece.size()) != piece) return false;
+            rest.remove_prefix(piece.size());
+            return true;
+        };
+        if (!consume("[")) return false;
+        for (const Entry& entry : entries_) {
+            if (entry.json.empty()) continue;
+            if (!consume(first ? "\n  " : ",\n  ") || !consume(entry.json)) return false;
+            first = false;
+        }
+        return consume(first ? "]\n" : "\n]\n") && rest.empty();
+    }
+
+    std::string directory_;  // "directory" of every entry
+    std::vector<Entry> entries_;  // By target index
+    size_t serialized_;  // Entries serialized since construction
+};
+
+}  // namespace Build
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: Build Daemon
+ * A resident process that keeps the build graph, the stat cache and the
+ * hash cache of a recipe in memory and serves build requests from thin
+ * clients over a Unix domain socket. A warm daemon does not reread
+ * depfiles and only rehashes files whose mtime or size changed.
+ *
+ * Protocol: the client sends one line, "build <recipe-stamp> [output...]",
+ * "ping" or "shutdown". For a build, the daemon points its stdout and
+ * stderr (and so those of the commands it runs) at the connection, and
+ * ends with DAEMON_EXIT_MARKER followed by the exit status and a newline.
+ * The recipe stamp identifies the recipe binary; a daemon started from an
+ * older binary answers "stale" and exits, and the client builds in-process.
+ ***************************************/
+
+/**
+ * DAEMON_SOCKET_PATH: Default socket, relative to the directory the recipe runs in.
+ */
+#define DAEMON_SOCKET_PATH ".uniquebuild.sock"
+
+/**
+ * DAEMON_EXIT_MARKER: Separates command output from the exit status.
+ */
+#define DAEMON_EXIT_MARKER "\x1E" "uniquebuild-exit "
+
+namespace UniqueBuild {
+
+namespace Build {
+
+/**
+ * Identifies a recipe binary by its path, size and mtime.
+ * @param executable: Path of the running recipe, usually argv[0].
+ * @return: A short hex string.
+ */
+inline std::string recipeStamp(const std::string& executable) {
+    const FileStamp stamp = statFile(executable.c_str());
+    char buffer[BUFFER_SIZE_256];
+    std::snprintf(buffer, sizeof(buffer), "%016llx",
+                  static_cast<unsigned long long>(Hash::hash64(executable) ^ uint64_t(stamp.mtimeNs) ^
+                                                  (stamp.size * Hash::detail::PRIME64_2)));
+    return buffer;
+}
+
+#ifdef UNIQUEBUILD_POSIX
+
+namespace detail {
+
+inline bool socketAddress(const std::string& path, sockaddr_un& address) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) return false;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+inline bool writeAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        const ssize_t n = ::send(fd, data, length, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        length -= size_t(n);
+    }
+    return true;
+}
+
+inline bool readLine(int fd, std::string& line) {
+    line.clear();
+    char c;
+    while (line.size() < MAX_PACKET_SIZE) {
+        const ssize_t n = ::recv(fd, &c, 1, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        if (c == '\n') return true;
+        line.push_back(c);
+    }
+    return false;
+}
+
+inline int connectTo(const std::string& path) {
+    sockaddr_un address;
+    if (!socketAddress(path, address)) return -1;
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+}  // namespace detail
+
+/**
+ * @class Daemon
+ * Serves build requests for one Graph, one client at a time.
+ */
+class Daemon {
+public:
+    /**
+     * @param graph: The recipe's graph; it stays warm between requests.
+     * @param socketPath: Where to listen.
+     * @param stamp: recipeStamp() of the running binary.
+     */
+    Daemon(Graph& graph, const std::string& socketPath, const std::string& stamp)
+        : graph_(graph), socketPath_(socketPath), stamp_(stamp), listenFd_(-1) {}
+
+    ~Daemon() { stop(); }
+
+    Daemon(const Daemon&) = delete;
+    Daemon& operator=(const Daemon&) = delete;
+
+    /**
+     * Binds the socket. Fails if another daemon is already answering on it;
+     * a leftover socket file from a dead daemon is replaced.
+     * @return: True if the daemon is ready to serve.
+     */
+    bool start() {
+        const int probe = detail::connectTo(socketPath_);
+        if (probe >= 0) {
+            ::close(probe);
+            LOG_ERROR(("a daemon is already listening on " + socketPath_).c_str());
+            return false;
+        }
+        ::unlink(socketPath_.c_str());
+        sockaddr_un address;
+        if (!detail::socketAddress(socketPath_, address)) return false;
+        listenFd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listenFd_ < 0) return false;
+        if (::bind(listenFd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(listenFd_, MAX_CONNECTIONS) != 0) {
+            stop();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Accepts and answers requests until a client sends "shutdown".
+     * @return: 0 after a clean shutdown, 1 if the socket could not be set up.
+     */
+    int serve() {
+        if (listenFd_ < 0 && !start()) return 1;
+        IGNORE_SIGNAL(SIGPIPE);
+        LOG_INFO(("daemon listening on " + socketPath_).c_str());
+        bool running = true;
+        while (running) {
+            const int client = ::accept(listenFd_, nullptr, nullptr);
+            if (client < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            timeval timeout = {TIMEOUT_MS / 1000, (TIMEOUT_MS % 1000) * 1000};
+            ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            running = handle(client);
+            ::close(client);
+        }
+        stop();
+        return 0;
+    }
+
+    /**
+     * Closes the socket and removes the socket file.
+     */
+    void stop() {
+        if (listenFd_ >= 0) {
+            ::close(listenFd_);
+            ::unlink(socketPath_.c_str());
+            listenFd_ = -1;
+        }
+    }
+
+protected:
+    /**
+     * Brings the graph up to date with the file system before a build.
+     * Without change notifications every path has to be stat'ed again;
+     * hashes are only recomputed for files whose stamp changed.
+     */
+    virtual void refresh() { graph_.invalidateAll(); }
+
+    Graph& graph() { return graph_; }
+
+private:
+    bool handle(int client) {
+        std::string line;
+        if (!detail::readLine(client, line)) return true;
+        std::vector<std::string> words;
+        size_t begin = 0;
+        while (begin < line.size()) {
+            size_t end = line.find(' ', begin);
+            if (end == std::string::npos) end = line.size();
+            if (end > begin) words.emplace_back(line, begin, end - begin);
+            begin = end + 1;
+        }
+        if (words.empty()) return true;
+        if (words[0] == "ping") {
+            detail::writeAll(client, "pong\n", 5);
+            return true;
+        }
+        if (words[0] == "shutdown") {
+            detail::writeAll(client, "bye\n", 4);
+            return false;
+        }
+        if (words[0] != "build" || words.size() < 2) {
+            detail::writeAll(client, "error\n", 6);
+            return true;
+        }
+        if (words[1] != stamp_) {
+            detail::writeAll(client, "stale\n", 6);
+            return false;
+        }
+        std::vector<PathId> goals;
+        for (size_t i = 2; i < words.size(); ++i) {
+            goals.push_back(graph_.paths().intern(words[i]));
+        }
+
+        std::fflush(stdout);
+        std::fflush(stderr);
+        const int savedOut = ::dup(1);
+        const int savedErr = ::dup(2);
+        ::dup2(client, 1);
+        ::dup2(client, 2);
+        refresh();
+        BuildStats stats;
+        const int status = graph_.build(goals, &stats);
+        std::fflush(stdout);
+        std::fflush(stderr);
+        ::dup2(savedOut, 1);
+        ::dup2(savedErr, 2);
+        ::close(savedOut);
+        ::close(savedErr);
+
+        const std::string trailer = std::string(DAEMON_EXIT_MARKER) + std::to_string(status) + "\n";
+        detail::writeAll(client, trailer.data(), trailer.size());
+        return true;
+    }
+
+    Graph& graph_;  // The warm graph
+    std::string socketPath_;  // Socket file
+    std::string stamp_;  // Identity of the binary that started the daemon
+    int listenFd_;  // Listening socket, -1 when stopped
+};
+
+/**
+ * Sends a build request to a running daemon and relays its output.
+ * @param socketPath: The daemon's socket.
+ * @param stamp: recipeStamp() of the calling binary.
+ * @param outputs: Outputs to build; empty builds everything.
+ * @param exitStatus: Receives the build's exit status.
+ * @return: False if no daemon answered or it was started from a different
+ *          binary; the caller should then build in-process.
+ */
+inline bool requestBuild(const std::string& socketPath, const std::string& stamp,
+                         const std::vector<std::string>& outputs, int& exitStatus) {
+    const int fd = detail::connectTo(socketPath);
+    if (fd < 0) return false;
+    std::string request = "build " + stamp;
+    for (const std::string& output : outputs) {
+        request += " " + output;
+    }
+    request += "\n";
+    if (!detail::writeAll(fd, request.data(), request.size())) {
+        ::close(fd);
+        return false;
+    }
+    // Relay everything except a tail long enough to hold the trailer.
+    const std::string marker = DAEMON_EXIT_MARKER;
+    const size_t keep = marker.size() + 16;
+    std::string pending;
+    char buffer[BUFFER_SIZE_2048];
+    bool sawOutput = false;
+    for (;;) {
+        const ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        sawOutput = true;
+        pending.append(buffer, size_t(n));
+        if (pending.size() > keep) {
+            std::fwrite(pending.data(), 1, pending.size() - keep, stdout);
+            pending.erase(0, pending.size() - keep);
+        }
+    }
+    ::close(fd);
+    if (!sawOutput || pending == "stale\n") return false;
+    const size_t at = pending.rfind(marker);
+    if (at == std::string::npos) {
+        std::fwrite(pending.data(), 1, pending.size(), stdout);
+        exitStatus = 1;
+        return true;
+    }
+    std::fwrite(pending.data(), 1, at, stdout);
+    int32_t status = 1;
+    UniqueBuild::Parse::parseInt32(std::string_view(pending).substr(at + marker.size()), status);
+    exitStatus = status;
+    return true;
+}
+
+/**
+ * Sends a one-line control request ("ping" or "shutdown").
+ * @return: The daemon's one-line answer, or an empty string if none is running.
+ */
+inline std::string sendControl(const std::string& socketPath, const std::string& request) {
+    const int fd = detail::connectTo(socketPath);
+    if (fd < 0) return std::string();
+    const std::string line = request + "\n";
+    std::string answer;
+    if (detail::writeAll(fd, line.data(), line.size())) detail::readLine(fd, answer);
+    ::close(fd);
+    return answer;
+}
+
+#endif  // UNIQUEBUILD_POSIX
+
+}  // namespace Build
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: Watch Mode
+ * Keeps a graph up to date while the developer edits. Directories that
+ * hold the graph's files are watched with inotify; a burst of events is
+ * coalesced over a short debounce window, each changed file marks its
+ * readers dirty, and the rebuild only stats and hashes those targets.
+ * Without inotify the watcher falls back to polling with a full re-stat.
+ ***************************************/
+
+#if defined(__linux__)
+    #include <sys/inotify.h>
+    #include <poll.h>
+    #define UNIQUEBUILD_INOTIFY 1
+#endif
+#include <thread>
+
+/**
+ * WATCH_DEBOUNCE_MS: Quiet time that ends a burst of file events.
+ */
+#define WATCH_DEBOUNCE_MS 50
+
+/**
+ * WATCH_POLL_MS: How long one wait blocks, and the rescan period without inotify.
+ */
+#define WATCH_POLL_MS 1000
+
+namespace UniqueBuild {
+
+namespace Build {
+
+/**
+ * @class Watcher
+ * Turns file system events into Graph::markDirty calls.
+ */
+class Watcher {
+public:
+    explicit Watcher(Graph& graph) : graph_(graph), fd_(-1), synced_(false), needSync_(true), rebuildPending_(false), watchCount_(0) {}
+
+    ~Watcher() { close(); }
+
+    Watcher(const Watcher&) = delete;
+    Watcher& operator=(const Watcher&) = delete;
+
+    /**
+     * Creates the inotify instance.
+     * @return: False if change notifications are unavailable.
+     */
+    bool open() {
+#ifdef UNIQUEBUILD_INOTIFY
+        if (fd_ < 0) fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+        return fd_ >= 0;
+    }
+
+    void close() {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+        directoryOf_.clear();
+        watched_.clear();
+        watchCount_ = 0;
+        synced_ = false;
+        needSync_ = true;
+    }
+
+    bool isOpen() const { return fd_ >= 0; }
+
+    /**
+     * Makes the next sync() rescan the graph, e.g. after a build ran
+     * commands whose depfiles may name new inputs.
+     */
+    void requestSync() { needSync_ = true; }
+
+    /**
+     * Watches the directory of every file the graph references, including
+     * inputs discovered from depfiles. Does nothing unless this is the
+     * first call, requestSync() was called, or directories appeared or
+     * vanished since the last call. A directory that does not exist yet is
+     * covered by watching its nearest existing ancestor. Files in
+     * directories that become watched after the first call are marked
+     * dirty, since their changes may have been missed.
+     * @return: Number of directories newly watched.
+     */
+    size_t sync() {
+        if (fd_ < 0 || !needSync_) return 0;
+        needSync_ = false;
+        size_t added = 0;
+        for (const Target& target : graph_.targets()) {
+            added += watchFileDirectory(target.output);
+            if (target.depfile != INVALID_PATH_ID) added += watchFileDirectory(target.depfile);
+            for (PathId input : target.inputs) {
+                added += watchFileDirectory(input);
+            }
+            for (PathId input : target.discovered) {
+                added += watchFileDirectory(input);
+            }
+        }
+        synced_ = true;
+        return added;
+    }
+
+    /**
+     * Waits for changes, then keeps reading until no event arrived for
+     * WATCH_DEBOUNCE_MS, marking every changed file dirty in the graph.
+     * Does not block while rebuildPending() holds.
+     * @param timeoutMs: Longest wait for the first event; 0 only drains.
+     * @return: Number of distinct files marked dirty.
+     */
+    size_t wait(int timeoutMs) {
+        if (fd_ < 0) return 0;
+        changed_.clear();
+        if (readable(rebuildPending_ ? 0 : timeoutMs)) {
+            do {
+                readEvents();
+            } while (readable(WATCH_DEBOUNCE_MS));
+        }
+        if (needSync_) sync();
+        for (PathId id : changed_) {
+            seen_[id] = 0;
+        }
+        return changed_.size();
+    }
+
+    /**
+     * @return: Files marked dirty by the last wait().
+     */
+    const std::vector<PathId>& changed() const { return changed_; }
+
+    /**
+     * True when the graph was invalidated without naming files, i.e.
+     * events were lost or a watched directory vanished or became watched;
+     * a build is then needed even if wait() returned 0.
+     */
+    bool rebuildPending() const { return rebuildPending_; }
+
+    /**
+     * Tells the watcher a build ran, which clears rebuildPending().
+     */
+    void built() { rebuildPending_ = false; }
+
+    size_t watchCount() const { return watchCount_; }
+
+private:
+#ifdef UNIQUEBUILD_INOTIFY
+    static const uint32_t EVENT_MASK = IN_CLOSE_WRITE | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM |
+                                       IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+#endif
+
+    bool readable(int timeoutMs) {
+#ifdef UNIQUEBUILD_INOTIFY
+        pollfd entry = {fd_, POLLIN, 0};
+        int n;
+        do {
+            n = ::poll(&entry, 1, timeoutMs);
+        } while (n < 0 && errno == EINTR);
+        return n > 0;
+#else
+        (void)timeoutMs;
+        return false;
+#endif
+    }
+
+    size_t watchFileDirectory(PathId file) {
+        PathTable& paths = graph_.paths();
+        PathId directory = paths.parent(file);
+        if (directory == INVALID_PATH_ID) return 0;
+        if (directory < watched_.size() && watched_[directory]) return 0;
+#ifdef UNIQUEBUILD_INOTIFY
+        size_t added = 0;
+        for (PathId dir = directory; dir != INVALID_PATH_ID; dir = paths.parent(dir)) {
+            if (dir < watched_.size() && watched_[dir]) break;
+            const int wd = ::inotify_add_watch(fd_, paths.view(dir).data(), EVENT_MASK | IN_ONLYDIR);
+            if (wd >= 0) {
+                if (watched_.size() <= dir) watched_.resize(paths.size(), 0);
+                watched_[dir] = 1;
+                if (directoryOf_.size() <= size_t(wd)) directoryOf_.resize(size_t(wd) + 1, INVALID_PATH_ID);
+                directoryOf_[wd] = dir;
+                ++watchCount_;
+                ++added;
+                break;
+            }
+            if (errno != ENOENT && errno != ENOTDIR) break;
+        }
+        // Anything in a directory watched only now may have changed unseen.
+        if (added && synced_) {
+            graph_.markDirty(file);
+            rebuildPending_ = true;
+        }
+        return added;
+#else
+        return 0;
+#endif
+    }
+
+    void noteChanged(PathId id) {
+        graph_.markDirty(id);
+        if (seen_.size() <= id) seen_.resize(graph_.paths().size(), 0);
+        if (!seen_[id]) {
+            seen_[id] = 1;
+            changed_.push_back(id);
+        }
+    }
+
+    void readEvents() {
+#ifdef UNIQUEBUILD_INOTIFY
+        alignas(inotify_event) char buffer[BUFFER_SIZE_2048 * 8];
+        for (;;) {
+            const ssize_t length = ::read(fd_, buffer, sizeof(buffer));
+            if (length < 0 && errno == EINTR) continue;
+            if (length <= 0) return;
+            for (ssize_t offset = 0; offset < length;) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += ssize_t(sizeof(inotify_event) + event->len);
+                handleEvent(*event);
+            }
+        }
+#endif
+    }
+
+#ifdef UNIQUEBUILD_INOTIFY
+    void handleEvent(const inotify_event& event) {
+        if (event.mask & IN_Q_OVERFLOW) {
+            // Events were lost: fall back to checking everything once.
+            graph_.invalidateAll();
+            needSync_ = true;
+            rebuildPending_ = true;
+            return;
+        }
+        if (event.wd < 0 || size_t(event.wd) >= directoryOf_.size()) return;
+        const PathId directory = directoryOf_[event.wd];
+        if (directory == INVALID_PATH_ID) return;
+        if (event.mask & IN_IGNORED) {
+            watched_[directory] = 0;
+            directoryOf_[event.wd] = INVALID_PATH_ID;
+            --watchCount_;
+            needSync_ = true;
+            rebuildPending_ = true;
+            return;
+        }
+        if (event.mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+            needSync_ = true;
+            rebuildPending_ = true;
+            return;
+        }
+        if (event.len == 0) return;
+        if ((event.mask & IN_ISDIR) && (event.mask & (IN_CREATE | IN_MOVED_TO))) needSync_ = true;
+        PathTable& paths = graph_.paths();
+        scratch_.assign(paths.view(directory));
+        scratch_.push_back('/');
+        scratch_.append(event.name);
+        const PathId id = paths.find(scratch_);
+        if (id != INVALID_PATH_ID) noteChanged(id);
+    }
+#endif
+
+    Graph& graph_;  // Graph to notify
+    int fd_;  // inotify descriptor, -1 when closed
+    bool synced_;  // True once the initial directories are watched
+    bool needSync_;  // Set initially, by requestSync, and when directories appeared or vanished
+    bool rebuildPending_;  // Graph invalidated without a changed_ entry; cleared by built()
+    size_t watchCount_;  // Directories currently watched
+    std::vector<PathId> directoryOf_;  // Directory by watch descriptor
+    std::vector<uint8_t> watched_;  // Per PathId: 1 if the directory is watched
+    std::vector<uint8_t> seen_;  // Per PathId: 1 if already in changed_
+    std::vector<PathId> changed_;  // Files changed during the last wait()
+    std::string scratch_;  // Reused for joining event names
+};
+
+/**
+ * Builds, then rebuilds whenever a file the graph references changes.
+ * Only the first build stats every file; later ones only look at targets
+ * reached from changed files.
+ * @param graph: The recipe's graph.
+ * @param goals: Outputs to keep up to date; empty means all.
+ * @param stop: Optional; the loop returns once it becomes true.
+ * @return: Exit status of the last build.
+ */
+inline int runWatch(Graph& graph, const std::vector<PathId>& goals = std::vector<PathId>(),
+                    const std::atomic<bool>* stop = nullptr) {
+    Watcher watcher(graph);
+    if (!watcher.open()) LOG_WARN("file change notifications unavailable, polling instead");
+    // Watch before the first build, so edits made while it runs are seen.
+    watcher.sync();
+    BuildStats stats;
+    int status = graph.build(goals, &stats);
+    watcher.built();
+    if (stats.executed) watcher.requestSync();
+    while (!stop || !stop->load()) {
+        watcher.sync();
+        size_t changed;
+        if (watcher.isOpen()) {
+            changed = watcher.wait(WATCH_POLL_MS);
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(WATCH_POLL_MS));
+            graph.invalidateAll();
+            changed = 1;
+        }
+        if (changed == 0 && !watcher.rebuildPending()) continue;
+        status = graph.build(goals, &stats);
+        watcher.built();
+        if (stats.executed) watcher.requestSync();
+        if (stats.executed || stats.failed) {
+            LOG_INFO(("watch: " + std::to_string(stats.executed) + " rebuilt, " + std::to_string(stats.failed) +
+                      " failed").c_str());
+        }
+    }
+    return status;
+}
+
+#ifdef UNIQUEBUILD_POSIX
+
+/**
+ * @class WatchingDaemon
+ * A Daemon that learns about changes from a Watcher instead of
+ * re-stating every file on each request.
+ */
+class WatchingDaemon : public Daemon {
+public:
+    WatchingDaemon(Graph& graph, const std::string& socketPath, const std::string& stamp)
+        : Daemon(graph, socketPath, stamp), watcher_(graph) {
+        watcher_.open();
+    }
+
+protected:
+    void refresh() override {
+        if (!watcher_.isOpen()) {
+            Daemon::refresh();
+            return;
+        }
+        // The previous request may have built targets with new depfile inputs.
+        watcher_.requestSync();
+        watcher_.sync();
+        watcher_.wait(0);
+        // The daemon builds after every refresh.
+        watcher_.built();
+    }
+
+private:
+    Watcher watcher_;  // Change source for the daemon's graph
+};
+
+#endif  // UNIQUEBUILD_POSIX
+
+}  // namespace Build
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: Precompiled Headers
+ * A recipe can precompile the headers most of its translation units
+ * include, so each compile loads a ready-made AST instead of parsing the
+ * same standard headers again. The precompiled header is an ordinary
+ * target: it is rebuilt when the header, or anything it includes, changes.
+ ***************************************/
+
+namespace UniqueBuild {
+
+namespace Build {
+
+/**
+ * @struct PrecompiledHeader
+ * Result of addPrecompiledHeader.
+ */
+struct PrecompiledHeader {
+    std::string header;  // The header that is precompiled
+    std::string output;  // The precompiled form: header.gch (GCC) or header.pch (Clang)
+    std::vector<std::string> flags;  // Compiler flags that make a compile use it
+};
+
+/**
+ * Adds a target that precompiles a header.
+ * GCC only uses the .gch if the compile uses the same options as the one
+ * that produced it, so pass the project's common compile flags.
+ * @param graph: The recipe's graph.
+ * @param header: The header to precompile, e.g. "build/pch.h".
+ * @param includes: If not empty, the header is generated to include these,
+ *                  written like the #include operand ("<vector>", "\"util.h\"").
+ *                  It is only rewritten when the list changes.
+ * @param compile: Compiler and common flags, e.g. {"g++", "-std=c++17", "-O2"}.
+ * @return: What compiles need to use the precompiled header; pass it to
+ *          usePrecompiledHeader.
+ */
+inline PrecompiledHeader addPrecompiledHeader(Graph& graph, const std::string& header,
+                                              const std::vector<std::string>& includes,
+                                              const std::vector<std::string>& compile) {
+    if (!includes.empty()) {
+        std::string text = "// Generated by the build recipe.\n";
+        for (const std::string& include : includes) {
+            text += "#include " + include + "\n";
+        }
+        if (!FileUtils::writeFileIfChanged(header, text)) LOG_ERROR(("could not write " + header).c_str());
+    }
+    const std::string compiler = compile.empty() ? std::string("cc") : compile[0];
+    const std::string_view name = std::string_view(compiler).substr(compiler.find_last_of("/\\") + 1);
+    const bool clang = name.find("clang") != std::string_view::npos;
+    const bool cxx = name.find("++") != std::string_view::npos;
+
+    PrecompiledHeader pch;
+    pch.header = header;
+    pch.output = header + (clang ? ".pch" : ".gch");
+    if (clang) {
+        pch.flags = {"-include-pch", pch.output};
+    } else {
+        pch.flags = {"-include", header, "-Winvalid-pch"};
+    }
+    std::vector<std::string> command = compile.empty() ? std::vector<std::string>{compiler} : compile;
+    command.insert(command.end(), {"-x", cxx ? "c++-header" : "c-header", header, "-o", pch.output,
+                                   "-MMD", "-MF", pch.output + ".d"});
+    graph.addTarget(pch.output, {header}, command, pch.output + ".d");
+    return pch;
+}
+
+/**
+ * Makes a compile command use a precompiled header.
+ * @param pch: From addPrecompiledHeader.
+ * @param command: The compile's argv; the flags are inserted after the compiler.
+ * @param inputs: The compile's inputs; the precompiled header is added, so
+ *                it is built first and its changes rebuild the compile.
+ */
+inline void usePrecompiledHeader(const PrecompiledHeader& pch, std::vector<std::string>& command,
+                                 std::vector<std::string>& inputs) {
+    command.insert(command.empty() ? command.end() : command.begin() + 1, pch.flags.begin(), pch.flags.end());
+    inputs.push_back(pch.output);
+}
+
+}  // namespace Build
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: Unity Builds
+ * Compiles batches of sources as one translation unit each: an umbrella
+ * file #includes the batch, so shared headers are parsed and the compiler
+ * started once per batch instead of once per file. A batch that does not
+ * compile as one unit (clashing file-local names, for example) falls back
+ * to per-file compiles combined into the same object, and its sources are
+ * remembered and compiled on their own in later runs.
+ ***************************************/
+
+/**
+ * UNITY_BATCH_BYTES: Source bytes after which a batch is closed.
+ */
+#define UNITY_BATCH_BYTES (512 * 1024)
+
+/**
+ * UNITY_MAX_FILES: Most sources in one batch.
+ */
+#define UNITY_MAX_FILES 64
+
+namespace UniqueBuild {
+
+namespace Build {
+
+/**
+ * @enum UnityGrouping
+ * How sources are grouped into batches. Sources are sorted by path first,
+ * so batches do not depend on the order they were listed in.
+ */
+enum class UnityGrouping {
+    BY_SIZE,  // Fill each batch up to the size and file limits
+    BY_DIRECTORY  // As BY_SIZE, but a batch never spans two directories
+};
+
+/**
+ * @class UnityBuild
+ * Adds unity-build targets to a graph.
+ */
+class UnityBuild {
+public:
+    /**
+     * @param graph: The recipe's graph.
+     * @param directory: Where umbrella files, objects and state go; created if missing.
+     * @param grouping: How to form batches.
+     * @param batchBytes: Source bytes after which a batch is closed.
+     * @param maxFiles: Most sources in one batch.
+     */
+    UnityBuild(Graph& graph, const std::string& directory, UnityGrouping grouping = UnityGrouping::BY_DIRECTORY,
+               size_t batchBytes = UNITY_BATCH_BYTES, size_t maxFiles = UNITY_MAX_FILES)
+        : graph_(graph), directory_(directory), grouping_(grouping), batchBytes_(batchBytes),
+          maxFiles_(maxFiles == 0 ? 1 : maxFiles) {
+        FileUtils::createDirectories(directory_);
+        loadState();
+    }
+
+    /**
+     * Adds targets compiling the sources, batched where possible.
+     * @param sources: C or C++ sources; C and C++ never share a batch.
+     * @param compile: Compiler and flags, without -c or -o, e.g. {"g++", "-std=c++17", "-O2"}.
+     * @return: The object files to link.
+     */
+    std::vector<std::string> addSources(const std::vector<std::string>& sources, const std::vector<std::string>& compile) {
+        std::vector<std::string> objects;
+        std::vector<Source> batchable;
+        PathTable& paths = graph_.paths();
+        for (const std::string& source : sources) {
+            const PathId id = paths.intern(source);
+            if (id < standalone_.size() && standalone_[id]) {
+                objects.push_back(addFileTarget(source, compile));
+                continue;
+            }
+            Source entry;
+            entry.path = source;
+            entry.key = isC(source) ? "c:" : "c++:";
+            if (grouping_ == UnityGrouping::BY_DIRECTORY) {
+                const PathId parent = paths.parent(id);
+                if (parent != INVALID_PATH_ID) entry.key.append(paths.view(parent));
+            }
+            entry.size = statFile(source.c_str()).size;
+            batchable.push_back(entry);
+        }
+        std::sort(batchable.begin(), batchable.end(), [](const Source& a, const Source& b) {
+            return a.key != b.key ? a.key < b.key : a.path < b.path;
+        });
+
+        std::vector<std::string> batch;
+        uint64_t bytes = 0;
+        for (size_t i = 0; i < batchable.size(); ++i) {
+            batch.push_back(batchable[i].path);
+            bytes += batchable[i].size;
+            const bool last = i + 1 == batchable.size() || batchable[i + 1].key != batchable[i].key;
+            if (last || bytes >= batchBytes_ || batch.size() >= maxFiles_) {
+                objects.push_back(batch.size() == 1 ? addFileTarget(batch[0], compile) : addBatchTarget(batch, compile));
+                batch.clear();
+                bytes = 0;
+            }
+        }
+        return objects;
+    }
+
+    /**
+     * Builds through the graph, then records sources whose batch needed
+     * the per-file fallback so later runs compile them on their own.
+     * @return: As Graph::build.
+     */
+    int build(const std::vector<PathId>& goals = std::vector<PathId>(), BuildStats* stats = nullptr) {
+        const int status = graph_.build(goals, stats);
+        saveState();
+        return status;
+    }
+
+    /**
+     * Writes the list of sources to compile on their own, if it changed.
+     * @return: False on an I/O error.
+     */
+    bool saveState() {
+        PathTable& paths = graph_.paths();
+        for (const Batch& batch : batches_) {
+            if (!graph_.targets()[batch.target].usedFallback) continue;
+            for (PathId source : batch.sources) {
+                if (standalone_.size() <= source) standalone_.resize(paths.size(), 0);
+                standalone_[source] = 1;
+            }
+        }
+        std::vector<std::string_view> names;
+        for (PathId id = 0; id < standalone_.size(); ++id) {
+            if (standalone_[id]) names.push_back(paths.view(id));
+        }
+        std::sort(names.begin(), names.end());
+        std::string text;
+        for (std::string_view name : names) {
+            text.append(name);
+            text.push_back('\n');
+        }
+        return FileUtils::writeFileIfChanged(statePath(), text);
+    }
+
+    /**
+     * @return: Number of umbrella translation units added.
+     */
+    size_t batchCount() const { return batches_.size(); }
+
+private:
+    struct Source {
+        std::string path;  // As given
+        std::string key;  // Sources with different keys never share a batch
+        uint64_t size;  // Bytes, 0 if missing
+    };
+
+    struct Batch {
+        size_t target;  // Index of the umbrella's target
+        std::vector<PathId> sources;  // Sources it includes
+    };
+
+    static bool isC(const std::string& source) {
+        return source.size() > 2 && source.compare(source.size() - 2, 2, ".c") == 0;
+    }
+
+    std::string statePath() const { return directory_ + "/unity-standalone.txt"; }
+
+    void loadState() {
+        FileUtils::MappedFile file;
+        if (!file.open(statePath())) return;
+        std::string_view text = file.view();
+        while (!text.empty()) {
+            const size_t end = std::min(text.find('\n'), text.size());
+            if (end > 0) {
+                const PathId id = graph_.paths().intern(text.substr(0, end));
+                if (standalone_.size() <= id) standalone_.resize(graph_.paths().size(), 0);
+                standalone_[id] = 1;
+            }
+            text.remove_prefix(std::min(end + 1, text.size()));
+        }
+    }
+
+    // Object name: file name plus a hash of the full path, so equal names in different directories do not clash.
+    std::string objectFor(const std::string& source) const {
+        char suffix[FORMAT_BUFFER_SIZE];
+        std::snprintf(suffix, sizeof(suffix), ".%08x.o", static_cast<unsigned>(Hash::hash64(source)));
+        const size_t slash = source.find_last_of("/\\");
+        return directory_ + "/" + source.substr(slash == std::string::npos ? 0 : slash + 1) + suffix;
+    }
+
+    static std::vector<std::string> compileCommand(const std::vector<std::string>& compile, const std::string& source,
+                                                   const std::string& object, bool depfile) {
+        std::vector<std::string> command = compile;
+        command.insert(command.end(), {"-c", source, "-o", object});
+        if (depfile) command.insert(command.end(), {"-MMD", "-MF", object + ".d"});
+        return command;
+    }
+
+    std::string addFileTarget(const std::string& source, const std::vector<std::string>& compile) {
+        const std::string object = objectFor(source);
+        graph_.addTarget(object, {source}, compileCommand(compile, source, object, true), object + ".d");
+        return object;
+    }
+
+    std::string addBatchTarget(const std::vector<std::string>& sources, const std::vector<std::string>& compile) {
+        // Named after the first source, so batches before this one do not rename it.
+        char id[FORMAT_BUFFER_SIZE];
+        std::snprintf(id, sizeof(id), "/unity_%08x", static_cast<unsigned>(Hash::hash64(sources[0])));
+        const std::string name = directory_ + id;
+        const std::string umbrella = name + (isC(sources[0]) ? ".c" : ".cpp");
+        const std::string object = name + ".o";
+
+        const std::string cwd = FileUtils::currentDirectory();
+        std::string text = "// Generated by the build recipe.\n";
+        for (const std::string& source : sources) {
+            const bool absolute = !source.empty() && (source[0] == '/' || source[0] == '\\' || source.find(':') == 1);
+            text += "#include \"" + (absolute ? source : cwd + "/" + source) + "\"\n";
+        }
+        if (!FileUtils::writeFileIfChanged(umbrella, text)) LOG_ERROR(("could not write " + umbrella).c_str());
+
+        std::vector<std::string> inputs(1, umbrella);
+        inputs.insert(inputs.end(), sources.begin(), sources.end());
+        const size_t target = graph_.addTarget(object, inputs, compileCommand(compile, umbrella, object, true), object + ".d");
+
+        // Fallback: compile each source alone, then combine the objects with a relocatable link.
+        std::vector<std::vector<std::string>> fallback;
+        std::vector<std::string> depfiles;
+        std::vector<std::string> combine = {compile.empty() ? std::string("cc") : compile[0], "-r"};
+        Batch batch;
+        batch.target = target;
+        for (const std::string& source : sources) {
+            const std::string part = objectFor(source);
+            fallback.push_back(compileCommand(compile, source, part, true));
+            depfiles.push_back(part + ".d");
+            combine.push_back(part);
+            batch.sources.push_back(graph_.paths().intern(source));
+        }
+        combine.insert(combine.end(), {"-o", object});
+        fallback.push_back(combine);
+        graph_.setFallback(target, fallback, depfiles);
+        batches_.push_back(batch);
+        return object;
+    }
+
+    Graph& graph_;  // Graph the targets go into
+    std::string directory_;  // Umbrella files, objects and state
+    UnityGrouping grouping_;  // How batches are formed
+    size_t batchBytes_;  // Size limit per batch
+    size_t maxFiles_;  // File limit per batch
+    std::vector<Batch> batches_;  // All umbrella targets
+    std::vector<uint8_t> standalone_;  // Per PathId: 1 if compiled on its own
+};
+
+}  // namespace Build
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: Recipe Entry Point
+ ***************************************/
+
+namespace UniqueBuild {
+
+namespace Build {
+
+/**
+ * Entry point for recipes. Refreshes compile_commands.json when the graph
+ * has compile targets, then handles:
+ *   --watch       build, then rebuild on every change
+ *   --daemon      serve requests until shut down
+ *   --shutdown    stop a running daemon
+ *   [outputs...]  build through the daemon if one is running, else in-process
+ * @param argc: From main().
+ * @param argv: From main().
+ * @param graph: The recipe's fully described graph.
+ * @param socketPath: Socket to serve on or connect to.
+ * @return: Exit status for main().
+ */
+inline int runRecipe(int argc, char** argv, Graph& graph, const std::string& socketPath = DAEMON_SOCKET_PATH) {
+    std::vector<std::string> outputs;
+    bool daemonMode = false;
+    bool watchMode = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--daemon") {
+            daemonMode = true;
+        } else if (arg == "--watch") {
+            watchMode = true;
+        } else if (arg == "--shutdown") {
+#ifdef UNIQUEBUILD_POSIX
+            return sendControl(socketPath, "shutdown").empty() ? 1 : 0;
+#else
+            return 1;
+#endif
+        } else {
+            outputs.push_back(arg);
+        }
+    }
+    CompilationDatabase database;
+    if (database.update(graph) > 0 && !database.write()) {
+        LOG_WARN("could not write " COMPILE_COMMANDS_PATH);
+    }
+    std::vector<PathId> goals;
+    for (const std::string& output : outputs) {
+        goals.push_back(graph.paths().intern(output));
+    }
+    if (watchMode) return runWatch(graph, goals);
+#ifdef UNIQUEBUILD_POSIX
+    const std::string stamp = recipeStamp(argc > 0 ? argv[0] : "");
+    if (daemonMode) {
+        WatchingDaemon daemon(graph, socketPath, stamp);
+        return daemon.serve();
+    }
+    int status = 0;
+    if (requestBuild(socketPath, stamp, outputs, status)) return status;
+#else
+    if (daemonMode) {
+        LOG_ERROR("daemon mode needs Unix domain sockets");
+        return 1;
+    }
+#endif
+    return graph.build(goals);
+}
+
+}  // namespace Build
+
+}  // namespace UniqueBuild
+
+#endif  // UNIQUEBUILD_EXEC_H
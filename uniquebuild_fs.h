@@ -0,0 +1,1033 @@
+/***************************************
+ * uniquebuild_fs.h
+ * File access: the FileUtils declarations, FileHandler, read-only
+ * memory-mapped files, write-if-changed, directory helpers, parallel
+ * tree removal and in-kernel file copies.
+ *
+ * Part of uniquebuild; see uniquebuild.h.
+ ***************************************/
+
+#ifndef UNIQUEBUILD_FS_H
+#define UNIQUEBUILD_FS_H
+
+#include "uniquebuild_core.h"
+
+#include <fstream>      // Required for std::fstream
+#include <deque>        // Required for std::deque in removeTree
+#include <mutex>        // Required for std::mutex in removeTree
+#include <condition_variable>  // Required for std::condition_variable in removeTree
+
+#ifdef UNIQUEBUILD_POSIX
+    #include <cerrno>
+    #include <dirent.h>
+    #include <signal.h>
+#else
+    #include <filesystem>
+#endif
+
+/***************************************
+ * SECTION: Namespaces
+ * The following namespaces are designed to group related functionalities.
+ * They help avoid naming collisions in larger projects and provide better
+ * code organization.
+ ***************************************/
+
+namespace UniqueBuild {
+
+/**
+ * @namespace FileUtils
+ * Provides a collection of utility functions for handling files.
+ * Contains methods for file reading, writing, and deletion.
+ */
+namespace FileUtils {
+
+/**
+ * Reads the contents of a file.
+ * @param filename: The name of the file to read.
+ * @return: The content of the file as a string.
+ */
+std::string readFile(const std::string& filename);
+
+/**
+ * Writes content to a file.
+ * @param filename: The name of the file to write.
+ * @param content: The content to write to the file.
+ * @return: True if the operation is successful, false otherwise.
+ */
+bool writeFile(const std::string& filename, const std::string& content);
+
+/**
+ * Deletes a file.
+ * @param filename: The name of the file to delete.
+ * @return: True if the file was successfully deleted, false otherwise.
+ */
+bool deleteFile(const std::string& filename);
+
+}  // namespace FileUtils
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: Classes
+ * The following classes are designed to encapsulate related data and functions.
+ * Classes provide a blueprint for creating objects in the program.
+ ***************************************/
+
+/**
+ * @class FileHandler
+ * Handles file operations such as opening, closing, reading, and writing files.
+ */
+class FileHandler {
+public:
+        FileHandler() = default;  // Constructor
+    ~FileHandler() { close(); }  // Destructor to close file if open
+    /**
+     * Opens a file with the given filename.
+     * @param filename: The name of the file to open.
+     * @return: True if the file was successfully opened, false otherwise.
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * Reads data from the file.
+     * @return: A string containing the data read from the file.
+     */
+    std::string read() const;  // Marked const
+
+    /**
+     * Writes data to the file.
+     * @param data: The data to write to the file.
+     */
+    void write(const std::string& data);
+
+    /**
+     * Closes the file.
+     */
+    void close();
+
+private:
+    std::string filename_;  // The name of the file
+    std::fstream fileStream_;  // File stream for reading and writing
+};
+
+/***************************************
+ * SECTION: Memory-Mapped Files
+ * Read-only mapping of whole files, so hashing and parsing can work on the
+ * page cache directly instead of copying into a std::string first.
+ * Platforms without mmap fall back to reading the file into memory.
+ ***************************************/
+
+namespace UniqueBuild {
+
+namespace FileUtils {
+
+/**
+ * @class MappedFile
+ * Maps a file read-only for the lifetime of the object. Empty files open
+ * successfully with size() == 0 and data() == nullptr.
+ */
+class MappedFile {
+public:
+    MappedFile() : data_(nullptr), size_(0), opened_(false) {}
+
+    explicit MappedFile(const std::string& filename) : data_(nullptr), size_(0), opened_(false) { open(filename); }
+
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept : data_(other.data_), size_(other.size_), opened_(other.opened_) {
+#ifndef UNIQUEBUILD_POSIX
+        fallback_.swap(other.fallback_);
+#endif
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.opened_ = false;
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            data_ = other.data_;
+            size_ = other.size_;
+            opened_ = other.opened_;
+#ifndef UNIQUEBUILD_POSIX
+            fallback_.swap(other.fallback_);
+#endif
+            other.data_ = nullptr;
+            other.size_ = 0;
+            other.opened_ = false;
+        }
+        return *this;
+    }
+
+    /**
+     * Maps a file, replacing any previous mapping.
+     * @param filename: The file to map.
+     * @return: True if the file was opened and mapped, false otherwise.
+     */
+    bool open(const std::string& filename) {
+        close();
+#ifdef UNIQUEBUILD_POSIX
+        const int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+            ::close(fd);
+            return false;
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ > 0) {
+            void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                ::close(fd);
+                size_ = 0;
+                return false;
+            }
+            data_ = static_cast<const uint8_t*>(mapped);
+        }
+        ::close(fd);
+        opened_ = true;
+        return true;
+#else
+        std::ifstream in(filename, std::ios::binary | std::ios::ate);
+        if (!in) return false;
+        fallback_.resize(static_cast<size_t>(in.tellg()));
+        in.seekg(0);
+        if (!fallback_.empty() && !in.read(reinterpret_cast<char*>(fallback_.data()), fallback_.size())) {
+            fallback_.clear();
+            return false;
+        }
+        data_ = fallback_.empty() ? nullptr : fallback_.data();
+        size_ = fallback_.size();
+        opened_ = true;
+        return true;
+#endif
+    }
+
+    /**
+     * Unmaps the file.
+     */
+    void close() {
+#ifdef UNIQUEBUILD_POSIX
+        if (data_) ::munmap(const_cast<uint8_t*>(data_), size_);
+#else
+        fallback_.clear();
+#endif
+        data_ = nullptr;
+        size_ = 0;
+        opened_ = false;
+    }
+
+    /**
+     * Tells the kernel the mapping will be read front to back, so it reads
+     * ahead aggressively. No-op without mmap.
+     */
+    void adviseSequential() const {
+#ifdef UNIQUEBUILD_POSIX
+        if (data_) ::madvise(const_cast<uint8_t*>(data_), size_, MADV_SEQUENTIAL);
+#endif
+    }
+
+    bool isOpen() const { return opened_; }
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    std::string_view view() const { return std::string_view(reinterpret_cast<const char*>(data_), size_); }
+
+private:
+    const uint8_t* data_;  // Start of the mapping
+    size_t size_;  // Mapping length in bytes
+    bool opened_;  // True after a successful open()
+#ifndef UNIQUEBUILD_POSIX
+    std::vector<uint8_t> fallback_;  // File contents where mmap is unavailable
+#endif
+};
+
+}  // namespace FileUtils
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: File Writing
+ * Small helpers for recipes that generate files.
+ ***************************************/
+
+namespace UniqueBuild {
+
+namespace FileUtils {
+
+/**
+ * Names a temporary file next to filename that is unique to the process
+ * and call, so concurrent writers of the same file never share one.
+ * @param filename: The file the temporary will be renamed to.
+ * @return: filename + ".tmp.<pid>.<serial>".
+ */
+inline std::string temporaryName(const std::string& filename) {
+    static std::atomic<uint64_t> serial(0);
+#ifdef UNIQUEBUILD_POSIX
+    const uint64_t process = uint64_t(::getpid());
+#else
+    const uint64_t process = uint64_t(::GetCurrentProcessId());
+#endif
+    return filename + ".tmp." + std::to_string(process) + "." + std::to_string(serial.fetch_add(1));
+}
+
+/**
+ * Writes a file only if its content would change, so that its mtime, and
+ * everything that depends on it, stays untouched otherwise. The new content
+ * goes to a temporary file that is renamed into place.
+ * @param filename: The file to write.
+ * @param content: The complete new content.
+ * @param changed: Optional; set to true if the file was written.
+ * @return: True if the file holds content afterwards, false on an I/O error.
+ */
+inline bool writeFileIfChanged(const std::string& filename, std::string_view content, bool* changed = nullptr) {
+    if (changed) *changed = false;
+    {
+        MappedFile existing;
+        if (existing.open(filename) && existing.view() == content) return true;
+    }
+    const std::string temporary = temporaryName(filename);
+    std::FILE* file = std::fopen(temporary.c_str(), FILE_MODE_WRITE_BINARY);
+    if (!file) return false;
+    const bool written = std::fwrite(content.data(), 1, content.size(), file) == content.size();
+    if (std::fclose(file) != 0 || !written) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+#ifdef OS_WINDOWS
+    std::remove(filename.c_str());
+#endif
+    if (std::rename(temporary.c_str(), filename.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    if (changed) *changed = true;
+    return true;
+}
+
+/**
+ * @return: The absolute path of the working directory, or "." if it cannot be determined.
+ */
+inline std::string currentDirectory() {
+#ifdef UNIQUEBUILD_POSIX
+    char buffer[MAX_PATH_LENGTH];
+    if (::getcwd(buffer, sizeof(buffer))) return buffer;
+    return ".";
+#else
+    std::error_code ec;
+    const std::string directory = std::filesystem::current_path(ec).generic_string();
+    return ec ? std::string(".") : directory;
+#endif
+}
+
+/**
+ * Creates a directory and any missing parents, like mkdir -p.
+ * @param path: The directory to create.
+ * @return: True if the directory exists afterwards.
+ */
+inline bool createDirectories(const std::string& path) {
+#ifdef UNIQUEBUILD_POSIX
+    struct stat info;
+    if (::stat(path.c_str(), &info) == 0) return S_ISDIR(info.st_mode);
+    const size_t slash = path.find_last_of('/');
+    if (slash != std::string::npos && slash > 0 && !createDirectories(path.substr(0, slash))) return false;
+    return ::mkdir(path.c_str(), 0777) == 0 || errno == EEXIST;
+#else
+    std::error_code ec;
+    std::filesystem::create_directories(path, ec);
+    return std::filesystem::is_directory(path, ec);
+#endif
+}
+
+}  // namespace FileUtils
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: Removing Trees
+ * removeTree deletes a directory tree relative to directory descriptors:
+ * files are unlinked with unlinkat, subdirectories are opened with openat
+ * and removed with unlinkat(AT_REMOVEDIR), all relative to their parent,
+ * so only the root is looked up by path. Each subdirectory becomes a task
+ * for up to REMOVE_TREE_THREADS threads; a directory is removed by
+ * whichever thread finishes its last child. Below REMOVE_TREE_OPEN_DEPTH
+ * a thread removes the rest of the chain itself, depth first, so deep
+ * trees do not run out of file descriptors. removeTreeInBackground renames the tree out of
+ * the way first and deletes it on a detached thread, so a clean step, or
+ * a process that exits right after it, only waits for the rename.
+ ***************************************/
+
+/**
+ * REMOVE_TREE_THREADS: Threads deleting subdirectories in parallel.
+ * More than THREAD_POOL_SIZE since they mostly wait on the filesystem.
+ */
+#define REMOVE_TREE_THREADS 8
+
+/**
+ * REMOVE_TREE_OPEN_DEPTH: Depth up to which removeTree keeps directories
+ * open for their children. Deeper subtrees are removed depth first with
+ * one directory open at a time, climbing back through "..".
+ */
+#define REMOVE_TREE_OPEN_DEPTH 64
+
+/**
+ * REMOVE_TREE_TRASH_PREFIX: Name prefix of trees renamed away by
+ * removeTreeInBackground, followed by the owning process id.
+ */
+#define REMOVE_TREE_TRASH_PREFIX ".uniquebuild-trash-"
+
+namespace UniqueBuild {
+
+namespace FileUtils {
+
+/**
+ * @struct RemoveStats
+ * What a removal deleted.
+ */
+struct RemoveStats {
+    uint64_t files = 0;  // Files, symbolic links and other non-directories
+    uint64_t directories = 0;  // Directories
+    uint64_t bytes = 0;  // Disk space freed: blocks of files whose last link went
+    uint64_t failures = 0;  // Entries that could not be removed
+
+    void add(const RemoveStats& other) {
+        files += other.files;
+        directories += other.directories;
+        bytes += other.bytes;
+        failures += other.failures;
+    }
+};
+
+namespace detail {
+
+#ifdef UNIQUEBUILD_POSIX
+
+/**
+ * @class TreeRemover
+ * One parallel removal. Directories are tasks in a shared queue; each
+ * holds a count of unfinished children plus one for itself, and the
+ * thread that drops it to zero removes the directory and moves up.
+ * A directory stays open while it has unfinished children, since they
+ * are opened and removed relative to it; REMOVE_TREE_OPEN_DEPTH bounds
+ * how many are open along one path.
+ */
+class TreeRemover {
+public:
+    explicit TreeRemover(bool statFiles) : statFiles_(statFiles), finished_(false), files_(0), directories_(0), bytes_(0), failures_(0) {}
+
+    void run(const std::string& root) {
+        nodes_.emplace_back(nullptr, root);
+        RemoveNode* node = &nodes_.back();
+        // A tree without subdirectories never leaves the calling thread.
+        removeContents(node);
+        if (finished_) return;
+#if ENABLE_MULTITHREADING
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < REMOVE_TREE_THREADS; ++t) workers.emplace_back([this] { work(); });
+        work();
+        for (auto& worker : workers) worker.join();
+#else
+        work();
+#endif
+    }
+
+    RemoveStats stats() const {
+        RemoveStats stats;
+        stats.files = files_;
+        stats.directories = directories_;
+        stats.bytes = bytes_;
+        stats.failures = failures_;
+        return stats;
+    }
+
+private:
+    struct RemoveNode {
+        RemoveNode(RemoveNode* parent_, std::string name_)
+            : parent(parent_), name(std::move(name_)), depth(parent_ ? parent_->depth + 1 : 0), directory(nullptr), pending(1) {}
+
+        RemoveNode* parent;  // Directory containing this one; null for the root
+        std::string name;  // Name within the parent; the full path for the root
+        size_t depth;  // Directories above this one; zero for the root
+        DIR* directory;  // Open while children are pending
+        std::atomic<size_t> pending;  // Unfinished children, plus one until listed
+    };
+
+    static int parentFd(const RemoveNode* node) {
+        return node->parent ? ::dirfd(node->parent->directory) : AT_FDCWD;
+    }
+
+    void work() {
+        for (;;) {
+            RemoveNode* node;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this] { return !queue_.empty() || finished_; });
+                if (queue_.empty()) return;
+                node = queue_.back();
+                queue_.pop_back();
+            }
+            removeContents(node);
+        }
+    }
+
+    static DIR* openDirectory(int parent, const std::string& name) {
+        const int fd = ::openat(parent, name.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        DIR* directory = fd >= 0 ? ::fdopendir(fd) : nullptr;
+        if (directory == nullptr && fd >= 0) ::close(fd);
+        return directory;
+    }
+
+    /**
+     * Unlinks the non-directories in an open directory and collects the
+     * names of its subdirectories.
+     */
+    void unlinkFiles(DIR* directory, std::vector<std::string>& subdirectories) {
+        const int fd = ::dirfd(directory);
+        uint64_t files = 0;
+        uint64_t bytes = 0;
+        uint64_t failures = 0;
+        for (;;) {
+            const dirent* entry = ::readdir(directory);
+            if (entry == nullptr) break;
+            const char* name = entry->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+            bool isDirectory = entry->d_type == DT_DIR;
+            struct stat info;
+            bool statted = false;
+            if (entry->d_type == DT_UNKNOWN || (statFiles_ && !isDirectory)) {
+                if (::fstatat(fd, name, &info, AT_SYMLINK_NOFOLLOW) != 0) continue;
+                statted = true;
+                isDirectory = S_ISDIR(info.st_mode);
+            }
+            if (!isDirectory) {
+                if (::unlinkat(fd, name, 0) == 0) {
+                    ++files;
+                    if (statted && info.st_nlink == 1) bytes += uint64_t(info.st_blocks) * 512;
+                    continue;
+                }
+                if (errno == ENOENT) continue;
+                if (errno != EISDIR) {
+                    ++failures;
+                    continue;
+                }
+            }
+            subdirectories.push_back(name);
+        }
+        files_ += files;
+        bytes_ += bytes;
+        failures_ += failures;
+    }
+
+    /** Removes an emptied directory, or a file that replaced it. */
+    void removeDirectory(int parent, const std::string& name) {
+        if (::unlinkat(parent, name.c_str(), AT_REMOVEDIR) == 0) {
+            ++directories_;
+        } else if (errno == ENOTDIR && ::unlinkat(parent, name.c_str(), 0) == 0) {
+            ++files_;
+        } else if (errno != ENOENT) {
+            ++failures_;
+        }
+    }
+
+    /**
+     * Unlinks the non-directories in a directory and queues its
+     * subdirectories, or removes them right away once the directory is
+     * REMOVE_TREE_OPEN_DEPTH deep.
+     */
+    void removeContents(RemoveNode* node) {
+        std::vector<std::string> subdirectories;
+        node->directory = openDirectory(parentFd(node), node->name);
+        if (node->directory) unlinkFiles(node->directory, subdirectories);
+
+        if (!subdirectories.empty() && node->depth + 1 >= REMOVE_TREE_OPEN_DEPTH) {
+            for (const std::string& name : subdirectories) removeChain(::dirfd(node->directory), name);
+        } else if (!subdirectories.empty()) {
+            node->pending += subdirectories.size();
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (std::string& name : subdirectories) {
+                nodes_.emplace_back(node, std::move(name));
+                queue_.push_back(&nodes_.back());
+            }
+            wake_.notify_all();
+        }
+        release(node);
+    }
+
+    /**
+     * Removes a subdirectory and everything below it on this thread,
+     * depth first. Only the directory being emptied is open; the way back
+     * up goes through "..", checked against the device and inode seen on
+     * the way down, so a chain moved away meanwhile is left alone.
+     */
+    void removeChain(int parent, const std::string& name) {
+        struct Level {
+            std::string name;  // Name within the level above
+            dev_t device;  // Identity of the directory, to check ".." against
+            ino_t inode;
+            std::vector<std::string> subdirectories;  // Not yet removed
+        };
+        std::vector<Level> levels;
+        DIR* directory = nullptr;
+        std::string next = name;
+        for (;;) {
+            if (!next.empty()) {
+                const int fd = directory ? ::dirfd(directory) : parent;
+                DIR* below = openDirectory(fd, next);
+                struct stat info;
+                if (below == nullptr || ::fstat(::dirfd(below), &info) != 0) {
+                    if (below) ::closedir(below);
+                    removeDirectory(fd, next);
+                    if (directory == nullptr) return;
+                    next.clear();
+                    continue;
+                }
+                if (directory) ::closedir(directory);
+                directory = below;
+                levels.push_back(Level{std::move(next), info.st_dev, info.st_ino, {}});
+                next.clear();
+                unlinkFiles(directory, levels.back().subdirectories);
+            }
+            Level& level = levels.back();
+            if (!level.subdirectories.empty()) {
+                next = std::move(level.subdirectories.back());
+                level.subdirectories.pop_back();
+                continue;
+            }
+            if (levels.size() == 1) break;
+            const Level& above = levels[levels.size() - 2];
+            DIR* up = openDirectory(::dirfd(directory), "..");
+            ::closedir(directory);
+            directory = up;
+            struct stat info;
+            if (directory == nullptr || ::fstat(::dirfd(directory), &info) != 0 || info.st_dev != above.device || info.st_ino != above.inode) {
+                if (directory) ::closedir(directory);
+                ++failures_;
+                return;
+            }
+            removeDirectory(::dirfd(directory), level.name);
+            levels.pop_back();
+        }
+        ::closedir(directory);
+        removeDirectory(parent, name);
+    }
+
+    /**
+     * Drops one pending count; closes and removes every directory on the
+     * way up whose count reaches zero.
+     */
+    void release(RemoveNode* node) {
+        while (node && node->pending.fetch_sub(1) == 1) {
+            if (node->directory) {
+                ::closedir(node->directory);
+                node->directory = nullptr;
+            }
+            removeDirectory(parentFd(node), node->name);
+            if (node->parent == nullptr) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                finished_ = true;
+                wake_.notify_all();
+            }
+            node = node->parent;
+        }
+    }
+
+    const bool statFiles_;  // Whether to stat files to count freed bytes
+    std::mutex mutex_;  // Guards queue_, nodes_ and finished_
+    std::condition_variable wake_;  // Signalled on new tasks and when done
+    std::deque<RemoveNode> nodes_;  // Every directory seen; deque keeps them in place
+    std::vector<RemoveNode*> queue_;  // Directories waiting to be listed
+    bool finished_;  // Set once the root is gone
+    std::atomic<uint64_t> files_;  // Totals for stats()
+    std::atomic<uint64_t> directories_;
+    std::atomic<uint64_t> bytes_;
+    std::atomic<uint64_t> failures_;
+};
+
+#endif  // UNIQUEBUILD_POSIX
+
+}  // namespace detail
+
+/**
+ * Removes a file or a directory with everything below it, like rm -rf,
+ * deleting subdirectories in parallel. Symbolic links are removed, never
+ * followed.
+ * @param path: The file or directory to remove.
+ * @param stats: Optional; receives what was removed. Counting freed bytes
+ *               costs one fstatat per file, so it is only done when set.
+ * @return: True if nothing is left at path afterwards.
+ */
+inline bool removeTree(const std::string& path, RemoveStats* stats = nullptr) {
+#ifdef UNIQUEBUILD_POSIX
+    struct stat info;
+    if (::lstat(path.c_str(), &info) != 0) return errno == ENOENT;
+    if (!S_ISDIR(info.st_mode)) {
+        if (::unlink(path.c_str()) != 0) {
+            if (stats && errno != ENOENT) ++stats->failures;
+            return errno == ENOENT;
+        }
+        if (stats) {
+            ++stats->files;
+            if (info.st_nlink == 1) stats->bytes += uint64_t(info.st_blocks) * 512;
+        }
+        return true;
+    }
+    detail::TreeRemover remover(stats != nullptr);
+    remover.run(path);
+    if (stats) stats->add(remover.stats());
+    return ::lstat(path.c_str(), &info) != 0 && errno == ENOENT;
+#else
+    std::error_code ec;
+    const std::uintmax_t removed = std::filesystem::remove_all(path, ec);
+    if (stats && removed != static_cast<std::uintmax_t>(-1)) stats->files += removed;
+    return !ec;
+#endif
+}
+
+namespace detail {
+
+/**
+ * @class BackgroundRemovals
+ * Detached threads deleting trees renamed away by removeTreeInBackground.
+ * Exit does not wait for them; whatever a removal leaves behind is trash
+ * of a dead process and is collected by a later removeTreeInBackground.
+ * The instance is never destroyed, so the threads can outlive main().
+ */
+class BackgroundRemovals {
+public:
+    static BackgroundRemovals& instance() {
+        static BackgroundRemovals* removals = new BackgroundRemovals();
+        return *removals;
+    }
+
+    void start(std::vector<std::string> paths) {
+#if ENABLE_MULTITHREADING
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++running_;
+        }
+        std::thread([this, paths] {
+            RemoveStats stats;
+            for (const std::string& path : paths) removeTree(path, &stats);
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.add(stats);
+            if (--running_ == 0) idle_.notify_all();
+        }).detach();
+#else
+        for (const std::string& path : paths) removeTree(path, &stats_);
+#endif
+    }
+
+    void wait(RemoveStats* stats) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait(lock, [this] { return running_ == 0; });
+        if (stats) stats->add(stats_);
+        stats_ = RemoveStats();
+    }
+
+private:
+    BackgroundRemovals() : running_(0) {}
+
+    std::mutex mutex_;  // Guards running_ and stats_
+    std::condition_variable idle_;  // Signalled when running_ drops to zero
+    size_t running_;  // Removals still in progress
+    RemoveStats stats_;  // Totals of finished removals since the last wait
+};
+
+}  // namespace detail
+
+/**
+ * Moves a file or directory out of the way and removes it on a
+ * background thread. The tree is renamed to REMOVE_TREE_TRASH_PREFIX<pid>-<n>
+ * next to it, so path is free as soon as this returns. Trash left behind
+ * by processes that exited before their removals finished, this one's
+ * predecessors included, is collected by the same thread.
+ * @param path: The file or directory to remove.
+ * @return: True if nothing is left at path afterwards; falls back to
+ *          removeTree when the rename fails.
+ */
+inline bool removeTreeInBackground(const std::string& path) {
+#ifdef UNIQUEBUILD_POSIX
+    size_t end = path.size();
+    while (end > 1 && path[end - 1] == '/') --end;
+    const size_t slash = path.find_last_of('/', end - 1);
+    const std::string parent = slash == std::string::npos ? std::string(".") : path.substr(0, MAX(slash, size_t(1)));
+    const std::string base = path.substr(slash == std::string::npos ? 0 : slash + 1, end - (slash == std::string::npos ? 0 : slash + 1));
+    if (base.empty() || base == "." || base == "..") return removeTree(path);
+
+    static std::atomic<unsigned> counter(0);
+    const std::string prefix = parent + "/" REMOVE_TREE_TRASH_PREFIX + std::to_string(::getpid()) + "-";
+    std::vector<std::string> trash;
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        const std::string target = prefix + std::to_string(counter++);
+        if (::rename(path.c_str(), target.c_str()) == 0) {
+            trash.push_back(target);
+            break;
+        }
+        if (errno == ENOENT) return true;
+        if (errno != EEXIST && errno != ENOTEMPTY && errno != EISDIR && errno != ENOTDIR) return removeTree(path);
+    }
+    if (trash.empty()) return removeTree(path);
+
+    // Collect trash of processes that no longer exist.
+    if (DIR* directory = ::opendir(parent.c_str())) {
+        const size_t length = std::strlen(REMOVE_TREE_TRASH_PREFIX);
+        while (const dirent* entry = ::readdir(directory)) {
+            if (std::strncmp(entry->d_name, REMOVE_TREE_TRASH_PREFIX, length) != 0) continue;
+            const long pid = std::strtol(entry->d_name + length, nullptr, 10);
+            if (pid > 0 && pid != long(::getpid()) && ::kill(pid_t(pid), 0) != 0 && errno == ESRCH) {
+                trash.push_back(parent + "/" + entry->d_name);
+            }
+        }
+        ::closedir(directory);
+    }
+    detail::BackgroundRemovals::instance().start(std::move(trash));
+    return true;
+#else
+    return removeTree(path);
+#endif
+}
+
+/**
+ * Waits until every removal started by removeTreeInBackground is done.
+ * @param stats: Optional; receives what those removals deleted.
+ */
+inline void waitForBackgroundRemovals(RemoveStats* stats = nullptr) {
+    detail::BackgroundRemovals::instance().wait(stats);
+}
+
+}  // namespace FileUtils
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: Copying Files
+ * copyFile keeps the data in the kernel: it asks the filesystem for a
+ * reflink first (FICLONE, a metadata-only copy on btrfs, XFS and other
+ * copy-on-write filesystems), then copy_file_range, then sendfile, and
+ * only then reads and writes through a buffer. The copy is written to
+ * a temporary file and renamed into place, with the source's mode bits
+ * and timestamps.
+ ***************************************/
+
+/**
+ * COPY_FILES_THREADS: Threads copying in parallel in copyFiles.
+ */
+#define COPY_FILES_THREADS 8
+
+/**
+ * COPY_BUFFER_SIZE: Buffer size of the read/write fallback.
+ */
+#define COPY_BUFFER_SIZE (128 * 1024)
+
+#ifdef OS_LINUX
+    #include <sys/ioctl.h>
+    #include <sys/sendfile.h>
+    #ifndef FICLONE
+        #define FICLONE _IOW(0x94, 9, int)
+    #endif
+#endif
+
+namespace UniqueBuild {
+
+namespace FileUtils {
+
+/**
+ * @enum CopyMethod
+ * How copyFile moved the data.
+ */
+enum class CopyMethod {
+    None,  // Nothing was copied
+    Clone,  // Reflink; the copy shares the source's blocks
+    CopyFileRange,  // copy_file_range within the kernel
+    Sendfile,  // sendfile within the kernel
+    Buffered  // read/write through a user-space buffer
+};
+
+/**
+ * @struct CopyResult
+ * Outcome of one copy.
+ */
+struct CopyResult {
+    int error = 0;  // 0 on success, otherwise an errno value
+    uint64_t bytes = 0;  // Bytes copied
+    CopyMethod method = CopyMethod::None;  // How the data was copied
+
+    bool ok() const { return error == 0; }
+};
+
+/**
+ * @struct CopyJob
+ * One source and destination for copyFiles.
+ */
+struct CopyJob {
+    std::string from;  // File to copy
+    std::string to;  // Destination; replaced if it exists
+};
+
+namespace detail {
+
+#ifdef UNIQUEBUILD_POSIX
+
+/**
+ * Copies in to out, trying the kernel paths in order, then reads until
+ * EOF. length (st_size) only steers the kernel paths: procfs, sysfs and
+ * some FUSE files report 0 for content they have, and a file can shrink
+ * or grow while it is copied.
+ * @param method: Receives the first path that moved data.
+ * @param copied: Receives the bytes actually copied.
+ * @return: 0, or an errno value.
+ */
+inline int copyData(int in, int out, uint64_t length, CopyMethod& method, uint64_t& copied) {
+    copied = 0;
+    method = CopyMethod::Buffered;
+#ifdef OS_LINUX
+    if (length > 0) {
+        if (::ioctl(out, FICLONE, in) == 0) {
+            struct stat info;
+            copied = ::fstat(out, &info) == 0 ? uint64_t(info.st_size) : length;
+            method = CopyMethod::Clone;
+            return 0;
+        }
+        // copy_file_range fails up front (EXDEV, EINVAL, ENOSYS, EOPNOTSUPP)
+        // where the kernel or filesystem cannot do it; fall through then.
+        while (copied < length) {
+            const ssize_t n =
+                ::copy_file_range(in, nullptr, out, nullptr, size_t(MIN(length - copied, uint64_t(1) << 30)), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && copied > 0) return errno;
+            if (n <= 0) break;
+            copied += uint64_t(n);
+        }
+        if (copied > 0) method = CopyMethod::CopyFileRange;
+        const uint64_t before = copied;
+        while (copied < length) {
+            const ssize_t n = ::sendfile(out, in, nullptr, size_t(MIN(length - copied, uint64_t(1) << 30)));
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && copied > 0) return errno;
+            if (n <= 0) break;
+            copied += uint64_t(n);
+        }
+        if (before == 0 && copied > 0) method = CopyMethod::Sendfile;
+    }
+    // The kernel paths share file offsets, so the loop below resumes where
+    // they stopped; after a complete kernel copy its first read only
+    // confirms EOF, so the large buffer is allocated once data shows up.
+#endif
+    char first[BUFFER_SIZE_512];
+    std::unique_ptr<char[]> buffer;
+    for (;;) {
+        char* data = buffer ? buffer.get() : first;
+        const ssize_t n = ::read(in, data, buffer ? COPY_BUFFER_SIZE : sizeof(first));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) return errno;
+        if (n == 0) break;
+        for (ssize_t written = 0; written < n;) {
+            const ssize_t w = ::write(out, data + written, size_t(n - written));
+            if (w < 0 && errno == EINTR) continue;
+            if (w < 0) return errno;
+            written += w;
+        }
+        copied += uint64_t(n);
+        if (!buffer) buffer.reset(new char[COPY_BUFFER_SIZE]);
+    }
+    return 0;
+}
+
+#endif  // UNIQUEBUILD_POSIX
+
+}  // namespace detail
+
+/**
+ * Copies a file, preserving its mode bits and timestamps. The copy goes
+ * to a temporary file next to the destination that is renamed over it,
+ * so readers never see a partial file.
+ * @param from: The file to copy.
+ * @param to: The destination; its directory must exist.
+ * @return: The outcome; error is EISDIR/EINVAL for a source that is not a regular file.
+ */
+inline CopyResult copyFile(const std::string& from, const std::string& to) {
+    CopyResult result;
+#ifdef UNIQUEBUILD_POSIX
+    const int in = ::open(from.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat info;
+    if (in < 0 || ::fstat(in, &info) != 0) {
+        result.error = errno;
+        if (in >= 0) ::close(in);
+        return result;
+    }
+    if (!S_ISREG(info.st_mode)) {
+        result.error = S_ISDIR(info.st_mode) ? EISDIR : EINVAL;
+        ::close(in);
+        return result;
+    }
+    const std::string temporary = temporaryName(to);
+    const int out = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (out < 0) {
+        result.error = errno;
+        ::close(in);
+        return result;
+    }
+    uint64_t copied = 0;
+    result.error = detail::copyData(in, out, uint64_t(info.st_size), result.method, copied);
+    if (result.error == 0 && ::fchmod(out, info.st_mode & 07777) != 0) result.error = errno;
+#if defined(OS_MAC)
+    const struct timespec times[2] = {info.st_atimespec, info.st_mtimespec};
+#else
+    const struct timespec times[2] = {info.st_atim, info.st_mtim};
+#endif
+    if (result.error == 0 && ::futimens(out, times) != 0) result.error = errno;
+    if (::close(out) != 0 && result.error == 0) result.error = errno;
+    ::close(in);
+    if (result.error == 0 && ::rename(temporary.c_str(), to.c_str()) != 0) result.error = errno;
+    if (result.error != 0) {
+        ::unlink(temporary.c_str());
+        result.method = CopyMethod::None;
+        return result;
+    }
+    result.bytes = copied;
+#else
+    std::error_code ec;
+    std::filesystem::copy_file(from, to, std::filesystem::copy_options::overwrite_existing, ec);
+    if (ec) {
+        result.error = ec.value();
+        return result;
+    }
+    std::filesystem::last_write_time(to, std::filesystem::last_write_time(from, ec), ec);
+    result.bytes = std::filesystem::file_size(to, ec);
+    result.method = CopyMethod::Buffered;
+#endif
+    return result;
+}
+
+/**
+ * Runs copyFile for every job on up to COPY_FILES_THREADS threads.
+ * @param jobs: Sources and destinations; destinations should be distinct.
+ * @return: One result per job, in the same order.
+ */
+inline std::vector<CopyResult> copyFiles(const std::vector<CopyJob>& jobs) {
+    std::vector<CopyResult> results(jobs.size());
+    std::atomic<size_t> next(0);
+    auto work = [&jobs, &results, &next] {
+        for (size_t i = next.fetch_add(1); i < jobs.size(); i = next.fetch_add(1)) {
+            results[i] = copyFile(jobs[i].from, jobs[i].to);
+        }
+    };
+#if ENABLE_MULTITHREADING
+    std::vector<std::thread> workers;
+    const size_t threads = MIN(size_t(COPY_FILES_THREADS), jobs.size());
+    for (size_t t = 1; t < threads; ++t) workers.emplace_back(work);
+    work();
+    for (auto& worker : workers) worker.join();
+#else
+    work();
+#endif
+    return results;
+}
+
+}  // namespace FileUtils
+
+}  // namespace UniqueBuild
+
+#endif  // UNIQUEBUILD_FS_H
@@ -0,0 +1,749 @@
+/***************************************
+ * uniquebuild_geometry.h
+ * Geometry on Point, Rectangle and Circle: scalar predicates and
+ * structure-of-arrays batches with vectorized containment, overlap and
+ * distance kernels that write selection bitmaps or index lists.
+ *
+ * Part of uniquebuild; see uniquebuild.h.
+ ***************************************/
+
+#ifndef UNIQUEBUILD_GEOMETRY_H
+#define UNIQUEBUILD_GEOMETRY_H
+
+#include "uniquebuild_core.h"
+#include "uniquebuild_cpu.h"
+#include "uniquebuild_memory.h"
+#include "uniquebuild_table.h"
+
+#include <cmath>  // Required for std::sqrt and HUGE_VAL
+
+/***************************************
+ * SECTION: Geometry
+ * A Rectangle covers the half-open area [x, x + width) x [y, y + height)
+ * from its topLeft corner; a rectangle with a width or height of zero or
+ * less is empty. A Circle contains the points at a distance of at most
+ * radius from its center. Coordinates are assumed to satisfy
+ * x + width and y + height fitting in an int, which lets every test
+ * compare unsigned differences instead of computing far edges. A circle
+ * with a negative radius is empty.
+ ***************************************/
+
+namespace UniqueBuild {
+
+/**
+ * @namespace Geometry
+ * Predicates on Point, Rectangle and Circle.
+ */
+namespace Geometry {
+
+namespace detail {
+
+/**
+ * start <= value < start + length, for length >= 0.
+ */
+inline bool inSpan(int32_t value, int32_t start, int32_t length) {
+    return uint32_t(value) - uint32_t(start) < uint32_t(length);
+}
+
+/**
+ * [a, a + aLength) and [b, b + bLength) share a point, for lengths > 0.
+ */
+inline bool spansOverlap(int32_t a, int32_t aLength, int32_t b, int32_t bLength) {
+    return inSpan(b, a, aLength) || inSpan(a, b, bLength);
+}
+
+inline int32_t clampLength(int length) {
+    return length > 0 ? int32_t(length) : 0;
+}
+
+}  // namespace detail
+
+inline bool contains(const Rectangle& rectangle, const Point& point) {
+    return detail::inSpan(point.x, rectangle.topLeft.x, detail::clampLength(rectangle.width)) &&
+           detail::inSpan(point.y, rectangle.topLeft.y, detail::clampLength(rectangle.height));
+}
+
+inline bool contains(const Circle& circle, const Point& point) {
+    const double dx = double(point.x) - double(circle.center.x);
+    const double dy = double(point.y) - double(circle.center.y);
+    return circle.radius >= 0 && dx * dx + dy * dy <= circle.radius * circle.radius;
+}
+
+inline bool overlaps(const Rectangle& a, const Rectangle& b) {
+    return a.width > 0 && a.height > 0 && b.width > 0 && b.height > 0 &&
+           detail::spansOverlap(a.topLeft.x, a.width, b.topLeft.x, b.width) &&
+           detail::spansOverlap(a.topLeft.y, a.height, b.topLeft.y, b.height);
+}
+
+inline double distanceSquared(const Point& a, const Point& b) {
+    const double dx = double(a.x) - double(b.x);
+    const double dy = double(a.y) - double(b.y);
+    return dx * dx + dy * dy;
+}
+
+/**
+ * A circle overlaps a non-empty rectangle when it contains the point of
+ * the rectangle nearest to its center.
+ */
+inline bool overlaps(const Circle& circle, const Rectangle& rectangle) {
+    if (rectangle.width <= 0 || rectangle.height <= 0 || !(circle.radius >= 0)) return false;
+    const double x = double(circle.center.x);
+    const double y = double(circle.center.y);
+    const double left = double(rectangle.topLeft.x);
+    const double top = double(rectangle.topLeft.y);
+    const double dx = x - MAX(left, MIN(x, left + double(rectangle.width - 1)));
+    const double dy = y - MAX(top, MIN(y, top + double(rectangle.height - 1)));
+    return dx * dx + dy * dy <= circle.radius * circle.radius;
+}
+
+/**
+ * Distance from a point to the nearest point a rectangle contains; zero
+ * inside, infinite for an empty rectangle.
+ */
+inline double distance(const Rectangle& rectangle, const Point& point) {
+    if (rectangle.width <= 0 || rectangle.height <= 0) return HUGE_VAL;
+    const double x = double(point.x);
+    const double y = double(point.y);
+    const double left = double(rectangle.topLeft.x);
+    const double top = double(rectangle.topLeft.y);
+    const double dx = x - MAX(left, MIN(x, left + double(rectangle.width - 1)));
+    const double dy = y - MAX(top, MIN(y, top + double(rectangle.height - 1)));
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+/**
+ * Distance from a point to a disc; zero inside, infinite for a negative
+ * radius.
+ */
+inline double distance(const Circle& circle, const Point& point) {
+    if (!(circle.radius >= 0)) return HUGE_VAL;
+    const double d = std::sqrt(distanceSquared(circle.center, point)) - circle.radius;
+    return d > 0 ? d : 0.0;
+}
+
+}  // namespace Geometry
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: Geometry Kernels
+ * Word kernels: each fills bitmap words [firstWord, lastWord) into
+ * words[0, lastWord - firstWord), bit i of word w standing for element
+ * 64 * w + i, so callers can pass a buffer that holds only that range.
+ * AVX2 tests eight int lanes or four double lanes per instruction, NEON
+ * four or two.
+ ***************************************/
+
+namespace UniqueBuild {
+
+namespace Geometry {
+
+namespace detail {
+
+/**
+ * Column pointers of the rectangles or points being tested.
+ */
+struct SpanColumns {
+    const int32_t* x;  // Point x, or rectangle left edge
+    const int32_t* y;  // Point y, or rectangle top edge
+    const int32_t* width;  // Rectangle width, null for points
+    const int32_t* height;  // Rectangle height, null for points
+};
+
+/**
+ * Sets bit i when test(i) holds; the scalar reference for the vector
+ * kernels below and their tail handler.
+ */
+template <typename Test>
+inline void fillWordsScalar(size_t count, uint64_t* words, size_t firstWord, size_t lastWord, Test&& test) {
+    for (size_t w = firstWord; w < lastWord; ++w) {
+        const size_t begin = w * 64;
+        const size_t end = MIN(begin + 64, count);
+        uint64_t word = 0;
+        for (size_t i = begin; i < end; ++i) {
+            word |= uint64_t(test(i)) << (i - begin);
+        }
+        words[w - firstWord] = word;
+    }
+}
+
+#ifdef UNIQUEBUILD_X86_DISPATCH
+/**
+ * Unsigned a < b on 32-bit lanes.
+ */
+UNIQUEBUILD_TARGET("avx2")
+inline __m256i lessUnsignedAvx2(__m256i a, __m256i b) {
+    const __m256i bias = _mm256_set1_epi32(int32_t(0x80000000u));
+    return _mm256_cmpgt_epi32(_mm256_xor_si256(b, bias), _mm256_xor_si256(a, bias));
+}
+
+/**
+ * Points (x[i], y[i]) inside one rectangle.
+ */
+UNIQUEBUILD_TARGET("avx2")
+inline void pointsInRectangleAvx2(const int32_t* x, const int32_t* y, size_t count, int32_t left, int32_t top,
+                                  int32_t width, int32_t height, uint64_t* words, size_t firstWord, size_t lastWord) {
+    const __m256i x0 = _mm256_set1_epi32(left);
+    const __m256i y0 = _mm256_set1_epi32(top);
+    const __m256i w = _mm256_set1_epi32(width);
+    const __m256i h = _mm256_set1_epi32(height);
+    const size_t fullWords = MIN(lastWord, count / 64);
+    size_t word = firstWord;
+    for (; word < fullWords; ++word) {
+        uint64_t bits = 0;
+        for (int k = 0; k < 8; ++k) {
+            const size_t i = word * 64 + size_t(8 * k);
+            const __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+            const __m256i py = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i));
+            const __m256i inside = _mm256_and_si256(lessUnsignedAvx2(_mm256_sub_epi32(px, x0), w),
+                                                    lessUnsignedAvx2(_mm256_sub_epi32(py, y0), h));
+            bits |= uint64_t(uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(inside)))) << (8 * k);
+        }
+        words[word - firstWord] = bits;
+    }
+    fillWordsScalar(count, words + (word - firstWord), word, lastWord, [=](size_t i) {
+        return inSpan(x[i], left, width) && inSpan(y[i], top, height);
+    });
+}
+
+/**
+ * Rectangles containing one point.
+ */
+UNIQUEBUILD_TARGET("avx2")
+inline void rectanglesContainingAvx2(const SpanColumns& r, size_t count, int32_t px, int32_t py, uint64_t* words,
+                                     size_t firstWord, size_t lastWord) {
+    const __m256i x = _mm256_set1_epi32(px);
+    const __m256i y = _mm256_set1_epi32(py);
+    const size_t fullWords = MIN(lastWord, count / 64);
+    size_t word = firstWord;
+    for (; word < fullWords; ++word) {
+        uint64_t bits = 0;
+        for (int k = 0; k < 8; ++k) {
+            const size_t i = word * 64 + size_t(8 * k);
+            const __m256i x0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(r.x + i));
+            const __m256i y0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(r.y + i));
+            const __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(r.width + i));
+            const __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(r.height + i));
+            const __m256i inside = _mm256_and_si256(lessUnsignedAvx2(_mm256_sub_epi32(x, x0), w),
+                                                    lessUnsignedAvx2(_mm256_sub_epi32(y, y0), h));
+            bits |= uint64_t(uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(inside)))) << (8 * k);
+        }
+        words[word - firstWord] = bits;
+    }
+    fillWordsScalar(count, words + (word - firstWord), word, lastWord, [&r, px, py](size_t i) {
+        return inSpan(px, r.x[i], r.width[i]) && inSpan(py, r.y[i], r.height[i]);
+    });
+}
+
+/**
+ * Rectangles overlapping one non-empty rectangle. Stored widths and
+ * heights are never negative, so zero marks an empty rectangle.
+ */
+UNIQUEBUILD_TARGET("avx2")
+inline void rectanglesOverlappingAvx2(const SpanColumns& r, size_t count, int32_t left, int32_t top, int32_t width,
+                                      int32_t height, uint64_t* words, size_t firstWord, size_t lastWord) {
+    const __m256i qx = _mm256_set1_epi32(left);
+    const __m256i qy = _mm256_set1_epi32(top);
+    const __m256i qw = _mm256_set1_epi32(width);
+    const __m256i qh = _mm256_set1_epi32(height);
+    const __m256i zero = _mm256_setzero_si256();
+    const size_t fullWords = MIN(lastWord, count / 64);
+    size_t word = firstWord;
+    for (; word < fullWords; ++word) {
+        uint64_t bits = 0;
+        for (int k = 0; k < 8; ++k) {
+            const size_t i = word * 64 + size_t(8 * k);
+            const __m256i x0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(r.x + i));
+            const __m256i y0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(r.y + i));
+            const __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(r.width + i));
+            const __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(r.height + i));
+            const __m256i overlapX = _mm256_or_si256(lessUnsignedAvx2(_mm256_sub_epi32(qx, x0), w),
+                                                     lessUnsignedAvx2(_mm256_sub_epi32(x0, qx), qw));
+            const __m256i overlapY = _mm256_or_si256(lessUnsignedAvx2(_mm256_sub_epi32(qy, y0), h),
+                                                     lessUnsignedAvx2(_mm256_sub_epi32(y0, qy), qh));
+            const __m256i empty = _mm256_or_si256(_mm256_cmpeq_epi32(w, zero), _mm256_cmpeq_epi32(h, zero));
+            const __m256i hit = _mm256_andnot_si256(empty, _mm256_and_si256(overlapX, overlapY));
+            bits |= uint64_t(uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(hit)))) << (8 * k);
+        }
+        words[word - firstWord] = bits;
+    }
+    fillWordsScalar(count, words + (word - firstWord), word, lastWord, [&](size_t i) {
+        return r.width[i] > 0 && r.height[i] > 0 && spansOverlap(r.x[i], r.width[i], left, width) &&
+               spansOverlap(r.y[i], r.height[i], top, height);
+    });
+}
+
+/**
+ * Elements whose squared distance to (cx, cy) is at most limit; used
+ * both for points in one circle and for circles containing one point,
+ * where limits holds each circle's squared radius.
+ */
+UNIQUEBUILD_TARGET("avx2")
+inline void withinDistanceAvx2(const int32_t* x, const int32_t* y, const double* limits, double limit, size_t count,
+                               int32_t cx, int32_t cy, uint64_t* words, size_t firstWord, size_t lastWord) {
+    const __m256d centerX = _mm256_set1_pd(double(cx));
+    const __m256d centerY = _mm256_set1_pd(double(cy));
+    const __m256d fixedLimit = _mm256_set1_pd(limit);
+    const size_t fullWords = MIN(lastWord, count / 64);
+    size_t word = firstWord;
+    for (; word < fullWords; ++word) {
+        uint64_t bits = 0;
+        for (int k = 0; k < 16; ++k) {
+            const size_t i = word * 64 + size_t(4 * k);
+            const __m256d dx = _mm256_sub_pd(
+                _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i))), centerX);
+            const __m256d dy = _mm256_sub_pd(
+                _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i))), centerY);
+            const __m256d d = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+            const __m256d bound = limits ? _mm256_loadu_pd(limits + i) : fixedLimit;
+            bits |= uint64_t(uint32_t(_mm256_movemask_pd(_mm256_cmp_pd(d, bound, _CMP_LE_OQ)))) << (4 * k);
+        }
+        words[word - firstWord] = bits;
+    }
+    fillWordsScalar(count, words + (word - firstWord), word, lastWord, [=](size_t i) {
+        const double dx = double(x[i]) - double(cx);
+        const double dy = double(y[i]) - double(cy);
+        return dx * dx + dy * dy <= (limits ? limits[i] : limit);
+    });
+}
+
+UNIQUEBUILD_TARGET("avx2")
+inline void distancesSquaredAvx2(const int32_t* x, const int32_t* y, size_t begin, size_t end, int32_t cx, int32_t cy,
+                                 double* out) {
+    const __m256d centerX = _mm256_set1_pd(double(cx));
+    const __m256d centerY = _mm256_set1_pd(double(cy));
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        const __m256d dx = _mm256_sub_pd(
+            _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i))), centerX);
+        const __m256d dy = _mm256_sub_pd(
+            _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i))), centerY);
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+    }
+    for (; i < end; ++i) {
+        const double dx = double(x[i]) - double(cx);
+        const double dy = double(y[i]) - double(cy);
+        out[i] = dx * dx + dy * dy;
+    }
+}
+#endif
+
+#ifdef UNIQUEBUILD_NEON
+/**
+ * Packs four all-ones/all-zero lanes into four bits.
+ */
+inline uint64_t neonBits(uint32x4_t mask) {
+    const uint32_t weightValues[4] = {1, 2, 4, 8};
+    return vaddvq_u32(vandq_u32(mask, vld1q_u32(weightValues)));
+}
+
+inline void pointsInRectangleNeon(const int32_t* x, const int32_t* y, size_t count, int32_t left, int32_t top,
+                                  int32_t width, int32_t height, uint64_t* words, size_t firstWord, size_t lastWord) {
+    const uint32x4_t x0 = vdupq_n_u32(uint32_t(left));
+    const uint32x4_t y0 = vdupq_n_u32(uint32_t(top));
+    const uint32x4_t w = vdupq_n_u32(uint32_t(width));
+    const uint32x4_t h = vdupq_n_u32(uint32_t(height));
+    const size_t fullWords = MIN(lastWord, count / 64);
+    size_t word = firstWord;
+    for (; word < fullWords; ++word) {
+        uint64_t bits = 0;
+        for (int k = 0; k < 16; ++k) {
+            const size_t i = word * 64 + size_t(4 * k);
+            const uint32x4_t px = vreinterpretq_u32_s32(vld1q_s32(x + i));
+            const uint32x4_t py = vreinterpretq_u32_s32(vld1q_s32(y + i));
+            const uint32x4_t inside = vandq_u32(vcltq_u32(vsubq_u32(px, x0), w), vcltq_u32(vsubq_u32(py, y0), h));
+            bits |= neonBits(inside) << (4 * k);
+        }
+        words[word - firstWord] = bits;
+    }
+    fillWordsScalar(count, words + (word - firstWord), word, lastWord, [=](size_t i) {
+        return inSpan(x[i], left, width) && inSpan(y[i], top, height);
+    });
+}
+
+inline void rectanglesContainingNeon(const SpanColumns& r, size_t count, int32_t px, int32_t py, uint64_t* words,
+                                     size_t firstWord, size_t lastWord) {
+    const uint32x4_t x = vdupq_n_u32(uint32_t(px));
+    const uint32x4_t y = vdupq_n_u32(uint32_t(py));
+    const size_t fullWords = MIN(lastWord, count / 64);
+    size_t word = firstWord;
+    for (; word < fullWords; ++word) {
+        uint64_t bits = 0;
+        for (int k = 0; k < 16; ++k) {
+            const size_t i = word * 64 + size_t(4 * k);
+            const uint32x4_t x0 = vreinterpretq_u32_s32(vld1q_s32(r.x + i));
+            const uint32x4_t y0 = vreinterpretq_u32_s32(vld1q_s32(r.y + i));
+            const uint32x4_t w = vreinterpretq_u32_s32(vld1q_s32(r.width + i));
+            const uint32x4_t h = vreinterpretq_u32_s32(vld1q_s32(r.height + i));
+            const uint32x4_t inside = vandq_u32(vcltq_u32(vsubq_u32(x, x0), w), vcltq_u32(vsubq_u32(y, y0), h));
+            bits |= neonBits(inside) << (4 * k);
+        }
+        words[word - firstWord] = bits;
+    }
+    fillWordsScalar(count, words + (word - firstWord), word, lastWord, [&r, px, py](size_t i) {
+        return inSpan(px, r.x[i], r.width[i]) && inSpan(py, r.y[i], r.height[i]);
+    });
+}
+#endif
+
+inline void pointsInRectangle(const int32_t* x, const int32_t* y, size_t count, int32_t left, int32_t top,
+                              int32_t width, int32_t height, uint64_t* words, size_t firstWord, size_t lastWord) {
+#ifdef UNIQUEBUILD_X86_DISPATCH
+    if (Cpu::hasAvx2()) return pointsInRectangleAvx2(x, y, count, left, top, width, height, words, firstWord, lastWord);
+#endif
+#ifdef UNIQUEBUILD_NEON
+    return pointsInRectangleNeon(x, y, count, left, top, width, height, words, firstWord, lastWord);
+#else
+    fillWordsScalar(count, words, firstWord, lastWord, [=](size_t i) {
+        return inSpan(x[i], left, width) && inSpan(y[i], top, height);
+    });
+#endif
+}
+
+inline void rectanglesContaining(const SpanColumns& r, size_t count, int32_t px, int32_t py, uint64_t* words,
+                                 size_t firstWord, size_t lastWord) {
+#ifdef UNIQUEBUILD_X86_DISPATCH
+    if (Cpu::hasAvx2()) return rectanglesContainingAvx2(r, count, px, py, words, firstWord, lastWord);
+#endif
+#ifdef UNIQUEBUILD_NEON
+    return rectanglesContainingNeon(r, count, px, py, words, firstWord, lastWord);
+#else
+    fillWordsScalar(count, words, firstWord, lastWord, [&r, px, py](size_t i) {
+        return inSpan(px, r.x[i], r.width[i]) && inSpan(py, r.y[i], r.height[i]);
+    });
+#endif
+}
+
+inline void rectanglesOverlapping(const SpanColumns& r, size_t count, int32_t left, int32_t top, int32_t width,
+                                  int32_t height, uint64_t* words, size_t firstWord, size_t lastWord) {
+    if (width <= 0 || height <= 0) {
+        for (size_t w = firstWord; w < lastWord; ++w) words[w - firstWord] = 0;
+        return;
+    }
+#ifdef UNIQUEBUILD_X86_DISPATCH
+    if (Cpu::hasAvx2()) {
+        return rectanglesOverlappingAvx2(r, count, left, top, width, height, words, firstWord, lastWord);
+    }
+#endif
+    fillWordsScalar(count, words, firstWord, lastWord, [&](size_t i) {
+        return r.width[i] > 0 && r.height[i] > 0 && spansOverlap(r.x[i], r.width[i], left, width) &&
+               spansOverlap(r.y[i], r.height[i], top, height);
+    });
+}
+
+inline void withinDistance(const int32_t* x, const int32_t* y, const double* limits, double limit, size_t count,
+                           int32_t cx, int32_t cy, uint64_t* words, size_t firstWord, size_t lastWord) {
+#ifdef UNIQUEBUILD_X86_DISPATCH
+    if (Cpu::hasAvx2()) return withinDistanceAvx2(x, y, limits, limit, count, cx, cy, words, firstWord, lastWord);
+#endif
+    fillWordsScalar(count, words, firstWord, lastWord, [=](size_t i) {
+        const double dx = double(x[i]) - double(cx);
+        const double dy = double(y[i]) - double(cy);
+        return dx * dx + dy * dy <= (limits ? limits[i] : limit);
+    });
+}
+
+/**
+ * Word kernels bound to one batch and one query, as passed to
+ * fillBitmap and appendIndices. words[0] receives word first.
+ */
+struct PointsInRectangleKernel {
+    const int32_t* x;  // Point x column
+    const int32_t* y;  // Point y column
+    size_t count;  // Number of points
+    int32_t left, top, width, height;  // Query rectangle, sizes clamped to >= 0
+
+    void operator()(uint64_t* words, size_t first, size_t last) const {
+        pointsInRectangle(x, y, count, left, top, width, height, words, first, last);
+    }
+};
+
+struct WithinDistanceKernel {
+    const int32_t* x;  // Point or center x column
+    const int32_t* y;  // Point or center y column
+    const double* limits;  // Per-element squared radius, or null to use limit
+    double limit;  // Squared radius shared by all elements
+    size_t count;  // Number of elements
+    int32_t cx, cy;  // Query point
+
+    void operator()(uint64_t* words, size_t first, size_t last) const {
+        withinDistance(x, y, limits, limit, count, cx, cy, words, first, last);
+    }
+};
+
+struct RectanglesContainingKernel {
+    SpanColumns r;  // Rectangle columns
+    size_t count;  // Number of rectangles
+    int32_t px, py;  // Query point
+
+    void operator()(uint64_t* words, size_t first, size_t last) const {
+        rectanglesContaining(r, count, px, py, words, first, last);
+    }
+};
+
+struct RectanglesOverlappingKernel {
+    SpanColumns r;  // Rectangle columns
+    size_t count;  // Number of rectangles
+    int32_t left, top, width, height;  // Query rectangle
+
+    void operator()(uint64_t* words, size_t first, size_t last) const {
+        rectanglesOverlapping(r, count, left, top, width, height, words, first, last);
+    }
+};
+
+/**
+ * Runs a word kernel over all elements into a bitmap, in parallel for
+ * large batches.
+ */
+template <typename Kernel>
+inline Columnar::SelectionBitmap fillBitmap(size_t count, const Kernel& kernel) {
+    Columnar::SelectionBitmap out(count);
+    uint64_t* words = out.words();
+    Parallel::forChunks(out.wordCount(), PARALLEL_MIN_CHUNK / 64, [&kernel, words](size_t, size_t begin, size_t end) {
+        kernel(words + begin, begin, end);
+    });
+    return out;
+}
+
+/**
+ * Runs a word kernel over all elements and appends the indices of the
+ * set bits, a block of words at a time so no full bitmap is built.
+ */
+template <typename Kernel>
+inline void appendIndices(size_t count, std::vector<uint32_t>& out, const Kernel& kernel) {
+    const size_t BLOCK = 16;
+    uint64_t block[BLOCK];
+    const size_t wordCount = (count + 63) / 64;
+    for (size_t first = 0; first < wordCount; first += BLOCK) {
+        const size_t last = MIN(first + BLOCK, wordCount);
+        kernel(block, first, last);
+        for (size_t w = first; w < last; ++w) {
+            for (uint64_t bits = block[w - first]; bits; bits &= bits - 1) {
+                out.push_back(uint32_t(w * 64 + size_t(MathUtils::detail::countTrailingZeros64(bits))));
+            }
+        }
+    }
+}
+
+}  // namespace detail
+
+}  // namespace Geometry
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: Geometry Batches
+ * Structure-of-arrays containers. Every query comes in two forms: one
+ * returning a SelectionBitmap, one appending matching indices.
+ ***************************************/
+
+namespace UniqueBuild {
+
+namespace Geometry {
+
+/**
+ * @class PointBatch
+ * Points as separate x and y columns.
+ */
+class PointBatch {
+public:
+    size_t size() const { return x_.size(); }
+
+    void reserve(size_t count) {
+        x_.reserve(count);
+        y_.reserve(count);
+    }
+
+    void clear() {
+        x_.clear();
+        y_.clear();
+    }
+
+    void add(const Point& point) {
+        x_.push_back(int32_t(point.x));
+        y_.push_back(int32_t(point.y));
+    }
+
+    Point operator[](size_t i) const { return Point{x_[i], y_[i]}; }
+
+    const int32_t* x() const { return x_.data(); }
+    const int32_t* y() const { return y_.data(); }
+
+    /**
+     * Selects the points inside a rectangle.
+     */
+    Columnar::SelectionBitmap inRectangle(const Rectangle& rectangle) const {
+        return detail::fillBitmap(size(), rectangleKernel(rectangle));
+    }
+
+    void inRectangle(const Rectangle& rectangle, std::vector<uint32_t>& out) const {
+        detail::appendIndices(size(), out, rectangleKernel(rectangle));
+    }
+
+    /**
+     * Selects the points inside a circle.
+     */
+    Columnar::SelectionBitmap inCircle(const Circle& circle) const {
+        return detail::fillBitmap(size(), circleKernel(circle));
+    }
+
+    void inCircle(const Circle& circle, std::vector<uint32_t>& out) const {
+        detail::appendIndices(size(), out, circleKernel(circle));
+    }
+
+    /**
+     * Squared distance from every point to one point.
+     * @param out: Receives size() values.
+     */
+    void distancesSquared(const Point& point, double* out) const {
+        const int32_t* x = x_.data();
+        const int32_t* y = y_.data();
+        Parallel::forChunks(size(), PARALLEL_MIN_CHUNK, [=](size_t, size_t begin, size_t end) {
+#ifdef UNIQUEBUILD_X86_DISPATCH
+            if (Cpu::hasAvx2()) return detail::distancesSquaredAvx2(x, y, begin, end, point.x, point.y, out);
+#endif
+            for (size_t i = begin; i < end; ++i) out[i] = distanceSquared(Point{x[i], y[i]}, point);
+        });
+    }
+
+private:
+    detail::PointsInRectangleKernel rectangleKernel(const Rectangle& rectangle) const {
+        return detail::PointsInRectangleKernel{x_.data(), y_.data(), size(), rectangle.topLeft.x, rectangle.topLeft.y,
+                                               detail::clampLength(rectangle.width),
+                                               detail::clampLength(rectangle.height)};
+    }
+
+    detail::WithinDistanceKernel circleKernel(const Circle& circle) const {
+        const double limit = circle.radius < 0 ? -1.0 : circle.radius * circle.radius;
+        return detail::WithinDistanceKernel{x_.data(), y_.data(), nullptr, limit, size(), circle.center.x,
+                                            circle.center.y};
+    }
+
+    Memory::AlignedVector<int32_t> x_;  // X coordinates
+    Memory::AlignedVector<int32_t> y_;  // Y coordinates
+};
+
+/**
+ * @class RectangleBatch
+ * Rectangles as left, top, width and height columns. Negative sizes are
+ * stored as zero (empty).
+ */
+class RectangleBatch {
+public:
+    size_t size() const { return x_.size(); }
+
+    void reserve(size_t count) {
+        x_.reserve(count);
+        y_.reserve(count);
+        width_.reserve(count);
+        height_.reserve(count);
+    }
+
+    void clear() {
+        x_.clear();
+        y_.clear();
+        width_.clear();
+        height_.clear();
+    }
+
+    void add(const Rectangle& rectangle) {
+        x_.push_back(int32_t(rectangle.topLeft.x));
+        y_.push_back(int32_t(rectangle.topLeft.y));
+        width_.push_back(detail::clampLength(rectangle.width));
+        height_.push_back(detail::clampLength(rectangle.height));
+    }
+
+    Rectangle operator[](size_t i) const { return Rectangle{Point{x_[i], y_[i]}, width_[i], height_[i]}; }
+
+    /**
+     * Selects the rectangles that contain a point.
+     */
+    Columnar::SelectionBitmap containing(const Point& point) const {
+        return detail::fillBitmap(size(), containingKernel(point));
+    }
+
+    void containing(const Point& point, std::vector<uint32_t>& out) const {
+        detail::appendIndices(size(), out, containingKernel(point));
+    }
+
+    /**
+     * Selects the rectangles that overlap another rectangle.
+     */
+    Columnar::SelectionBitmap overlapping(const Rectangle& rectangle) const {
+        return detail::fillBitmap(size(), overlappingKernel(rectangle));
+    }
+
+    void overlapping(const Rectangle& rectangle, std::vector<uint32_t>& out) const {
+        detail::appendIndices(size(), out, overlappingKernel(rectangle));
+    }
+
+private:
+    detail::SpanColumns columns() const { return detail::SpanColumns{x_.data(), y_.data(), width_.data(), height_.data()}; }
+
+    detail::RectanglesContainingKernel containingKernel(const Point& point) const {
+        return detail::RectanglesContainingKernel{columns(), size(), point.x, point.y};
+    }
+
+    detail::RectanglesOverlappingKernel overlappingKernel(const Rectangle& rectangle) const {
+        return detail::RectanglesOverlappingKernel{columns(), size(), rectangle.topLeft.x, rectangle.topLeft.y,
+                                                   rectangle.width, rectangle.height};
+    }
+
+    Memory::AlignedVector<int32_t> x_;  // Left edges
+    Memory::AlignedVector<int32_t> y_;  // Top edges
+    Memory::AlignedVector<int32_t> width_;  // Widths, >= 0
+    Memory::AlignedVector<int32_t> height_;  // Heights, >= 0
+};
+
+/**
+ * @class CircleBatch
+ * Circles as center columns and squared radii.
+ */
+class CircleBatch {
+public:
+    size_t size() const { return x_.size(); }
+
+    void reserve(size_t count) {
+        x_.reserve(count);
+        y_.reserve(count);
+        radiusSquared_.reserve(count);
+    }
+
+    void clear() {
+        x_.clear();
+        y_.clear();
+        radiusSquared_.clear();
+    }
+
+    void add(const Circle& circle) {
+        x_.push_back(int32_t(circle.center.x));
+        y_.push_back(int32_t(circle.center.y));
+        radiusSquared_.push_back(circle.radius < 0 ? -1.0 : circle.radius * circle.radius);
+    }
+
+    /**
+     * Selects the circles that contain a point.
+     */
+    Columnar::SelectionBitmap containing(const Point& point) const {
+        return detail::fillBitmap(size(), containingKernel(point));
+    }
+
+    void containing(const Point& point, std::vector<uint32_t>& out) const {
+        detail::appendIndices(size(), out, containingKernel(point));
+    }
+
+private:
+    detail::WithinDistanceKernel containingKernel(const Point& point) const {
+        return detail::WithinDistanceKernel{x_.data(), y_.data(), radiusSquared_.data(), 0.0, size(), point.x, point.y};
+    }
+
+    Memory::AlignedVector<int32_t> x_;  // Center x
+    Memory::AlignedVector<int32_t> y_;  // Center y
+    Memory::AlignedVector<double> radiusSquared_;  // Squared radius; -1 for negative radii
+};
+
+}  // namespace Geometry
+
+}  // namespace UniqueBuild
+
+#endif  // UNIQUEBUILD_GEOMETRY_H
@@ -0,0 +1,666 @@
+/***************************************
+ * uniquebuild_hash.h
+ * Non-cryptographic 64/128-bit hashing, streaming SHA-256 and
+ * whole-file hashing.
+ *
+ * Part of uniquebuild; see uniquebuild.h.
+ ***************************************/
+
+#ifndef UNIQUEBUILD_HASH_H
+#define UNIQUEBUILD_HASH_H
+
+#include "uniquebuild_core.h"
+#include "uniquebuild_cpu.h"
+#include "uniquebuild_endian.h"
+#include "uniquebuild_fs.h"
+
+/***************************************
+ * SECTION: Hashing
+ * Two hash families:
+ * - hash64/hash128: fast non-cryptographic hashing for hash-table keys and
+ *   change detection, built like XXH3 (64-byte stripes feeding eight
+ *   64-bit multiply-accumulate lanes, keyed by a secret, with an AVX2
+ *   kernel selected at run time). The values are stable across runs and
+ *   platforms but are not XXH3-compatible.
+ * - Sha256: streaming SHA-256 for artifact fingerprints, using the SHA-NI
+ *   or ARMv8 crypto instructions when available.
+ * Both work directly on memory-mapped files, and many files can be hashed
+ * in parallel.
+ ***************************************/
+
+/**
+ * HASH_SECRET_SIZE: Size of the key material mixed into long inputs.
+ * HASH_STRIPE_LENGTH: Bytes consumed per accumulate step.
+ */
+#define HASH_SECRET_SIZE 192
+#define HASH_STRIPE_LENGTH 64
+#define HASH_STRIPES_PER_BLOCK ((HASH_SECRET_SIZE - HASH_STRIPE_LENGTH) / 8)
+
+namespace UniqueBuild {
+
+/**
+ * @namespace Hash
+ * Non-cryptographic and SHA-256 hashing over memory and files.
+ */
+namespace Hash {
+
+/**
+ * @struct Hash128
+ * A 128-bit hash value.
+ */
+struct Hash128 {
+    uint64_t low;  // Low 64 bits
+    uint64_t high;  // High 64 bits
+
+    bool operator==(const Hash128& other) const { return low == other.low && high == other.high; }
+    bool operator!=(const Hash128& other) const { return !(*this == other); }
+};
+
+namespace detail {
+
+const uint64_t PRIME32_1 = 0x9E3779B1u;
+const uint64_t PRIME32_2 = 0x85EBCA77u;
+const uint64_t PRIME32_3 = 0xC2B2AE3Du;
+const uint64_t PRIME64_1 = 0x9E3779B185EBCA87ull;
+const uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4Full;
+const uint64_t PRIME64_3 = 0x165667B19E3779F9ull;
+const uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ull;
+const uint64_t PRIME64_5 = 0x27D4EB2F165667C5ull;
+
+inline uint64_t read64(const uint8_t* p) {
+    return Endian::loadLittle<uint64_t>(p);
+}
+
+inline uint32_t read32(const uint8_t* p) {
+    return Endian::loadLittle<uint32_t>(p);
+}
+
+/**
+ * The secret: HASH_SECRET_SIZE fixed pseudo-random bytes.
+ */
+inline const uint8_t* secret() {
+    struct Table {
+        uint8_t bytes[HASH_SECRET_SIZE];
+        Table() {
+            // SplitMix64, as in Random::SplitMix64, kept local to avoid the dependency.
+            uint64_t state = 0x5EC2E7u;
+            for (size_t i = 0; i < HASH_SECRET_SIZE; i += 8) {
+                uint64_t word = (state += 0x9E3779B97F4A7C15ull);
+                word = (word ^ (word >> 30)) * 0xBF58476D1CE4E5B9ull;
+                word = (word ^ (word >> 27)) * 0x94D049BB133111EBull;
+                word ^= word >> 31;
+                for (size_t b = 0; b < 8; ++b) bytes[i + b] = static_cast<uint8_t>(word >> (8 * b));
+            }
+        }
+    };
+    static const Table table;
+    return table.bytes;
+}
+
+/**
+ * Multiplies two 64-bit values and folds the 128-bit product to 64 bits.
+ */
+inline uint64_t mulFold64(uint64_t a, uint64_t b) {
+#ifdef __SIZEOF_INT128__
+    const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#else
+    const uint64_t aLo = a & 0xFFFFFFFFu, aHi = a >> 32, bLo = b & 0xFFFFFFFFu, bHi = b >> 32;
+    const uint64_t lolo = aLo * bLo, hilo = aHi * bLo, lohi = aLo * bHi, hihi = aHi * bHi;
+    const uint64_t cross = (lolo >> 32) + (hilo & 0xFFFFFFFFu) + lohi;
+    const uint64_t upper = (hilo >> 32) + (cross >> 32) + hihi;
+    const uint64_t lower = (cross << 32) | (lolo & 0xFFFFFFFFu);
+    return lower ^ upper;
+#endif
+}
+
+inline uint64_t avalanche(uint64_t h) {
+    h ^= h >> 37;
+    h *= 0x165667919E3779F9ull;
+    return h ^ (h >> 32);
+}
+
+inline uint64_t mix16(const uint8_t* p, const uint8_t* key, uint64_t seed) {
+    return mulFold64(read64(p) ^ (read64(key) + seed), read64(p + 8) ^ (read64(key + 8) - seed));
+}
+
+inline uint64_t hashShort(const uint8_t* p, size_t length, uint64_t seed) {
+    const uint8_t* key = secret();
+    uint64_t acc = length * PRIME64_1;
+    if (length <= 16) {
+        uint64_t lo = 0, hi = 0;
+        if (length > 8) {
+            lo = read64(p);
+            hi = read64(p + length - 8);
+        } else if (length >= 4) {
+            lo = read32(p);
+            hi = read32(p + length - 4);
+        } else if (length > 0) {
+            lo = (uint64_t(p[0]) << 16) | (uint64_t(p[length >> 1]) << 24) | p[length - 1];
+        }
+        acc += mulFold64(lo ^ (read64(key + 24) + seed), hi ^ (read64(key + 32) - seed));
+        return avalanche(acc);
+    }
+    if (length > 32) {
+        if (length > 64) {
+            if (length > 96) {
+                acc += mix16(p + 48, key + 96, seed);
+                acc += mix16(p + length - 64, key + 112, seed);
+            }
+            acc += mix16(p + 32, key + 64, seed);
+            acc += mix16(p + length - 48, key + 80, seed);
+        }
+        acc += mix16(p + 16, key + 32, seed);
+        acc += mix16(p + length - 32, key + 48, seed);
+    }
+    acc += mix16(p, key, seed);
+    acc += mix16(p + length - 16, key + 16, seed);
+    return avalanche(acc);
+}
+
+inline void accumulateScalar(uint64_t* acc, const uint8_t* p, const uint8_t* key) {
+    for (int i = 0; i < 8; ++i) {
+        const uint64_t data = read64(p + 8 * i);
+        const uint64_t keyed = data ^ read64(key + 8 * i);
+        acc[i ^ 1] += data;
+        acc[i] += (keyed & 0xFFFFFFFFu) * (keyed >> 32);
+    }
+}
+
+inline void scrambleScalar(uint64_t* acc, const uint8_t* key) {
+    for (int i = 0; i < 8; ++i) {
+        uint64_t a = acc[i];
+        a ^= a >> 47;
+        a ^= read64(key + 8 * i);
+        acc[i] = a * PRIME32_1;
+    }
+}
+
+/**
+ * Stripe loop shared by the scalar and vector kernels: full blocks of
+ * HASH_STRIPES_PER_BLOCK stripes with a scramble after each, the
+ * remaining whole stripes, then the last 64 bytes (possibly overlapping).
+ */
+#define UNIQUEBUILD_HASH_LONG_LOOP(ACCUMULATE, SCRAMBLE)                                   \
+    const uint8_t* key = secret();                                                         \
+    const size_t blockLength = HASH_STRIPE_LENGTH * HASH_STRIPES_PER_BLOCK;                \
+    const size_t blocks = (length - 1) / blockLength;                                      \
+    for (size_t b = 0; b < blocks; ++b) {                                                  \
+        for (size_t s = 0; s < HASH_STRIPES_PER_BLOCK; ++s) {                              \
+            ACCUMULATE(p + b * blockLength + s * HASH_STRIPE_LENGTH, key + s * 8);         \
+        }                                                                                  \
+        SCRAMBLE(key + HASH_SECRET_SIZE - HASH_STRIPE_LENGTH);                             \
+    }                                                                                      \
+    const size_t stripes = ((length - 1) - blocks * blockLength) / HASH_STRIPE_LENGTH;     \
+    for (size_t s = 0; s < stripes; ++s) {                                                 \
+        ACCUMULATE(p + blocks * blockLength + s * HASH_STRIPE_LENGTH, key + s * 8);        \
+    }                                                                                      \
+    ACCUMULATE(p + length - HASH_STRIPE_LENGTH, key + HASH_SECRET_SIZE - HASH_STRIPE_LENGTH - 7);
+
+inline void hashLongScalar(uint64_t* acc, const uint8_t* p, size_t length) {
+#define UNIQUEBUILD_ACC(data, k) accumulateScalar(acc, data, k)
+#define UNIQUEBUILD_SCRAMBLE(k) scrambleScalar(acc, k)
+    UNIQUEBUILD_HASH_LONG_LOOP(UNIQUEBUILD_ACC, UNIQUEBUILD_SCRAMBLE)
+#undef UNIQUEBUILD_ACC
+#undef UNIQUEBUILD_SCRAMBLE
+}
+
+#ifdef UNIQUEBUILD_X86_DISPATCH
+UNIQUEBUILD_TARGET("avx2")
+inline void hashLongAvx2(uint64_t* acc, const uint8_t* p, size_t length) {
+    __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc));
+    __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + 4));
+    const __m256i prime = _mm256_set1_epi32(static_cast<int>(PRIME32_1));
+#define UNIQUEBUILD_ACC_HALF(A, data, k)                                                        \
+    {                                                                                           \
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));           \
+        const __m256i keyed = _mm256_xor_si256(d, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(k))); \
+        const __m256i product = _mm256_mul_epu32(keyed, _mm256_srli_epi64(keyed, 32));         \
+        A = _mm256_add_epi64(A, _mm256_add_epi64(product, _mm256_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2)))); \
+    }
+#define UNIQUEBUILD_ACC(data, k)                 \
+    {                                            \
+        UNIQUEBUILD_ACC_HALF(a0, (data), (k))     \
+        UNIQUEBUILD_ACC_HALF(a1, (data) + 32, (k) + 32) \
+    }
+#define UNIQUEBUILD_SCRAMBLE_HALF(A, k)                                                         \
+    {                                                                                           \
+        __m256i x = _mm256_xor_si256(A, _mm256_srli_epi64(A, 47));                              \
+        x = _mm256_xor_si256(x, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(k)));       \
+        const __m256i lo = _mm256_mul_epu32(x, prime);                                          \
+        const __m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), prime);                   \
+        A = _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));                                    \
+    }
+#define UNIQUEBUILD_SCRAMBLE(k)                  \
+    {                                            \
+        UNIQUEBUILD_SCRAMBLE_HALF(a0, (k))        \
+        UNIQUEBUILD_SCRAMBLE_HALF(a1, (k) + 32)   \
+    }
+    UNIQUEBUILD_HASH_LONG_LOOP(UNIQUEBUILD_ACC, UNIQUEBUILD_SCRAMBLE)
+#undef UNIQUEBUILD_ACC_HALF
+#undef UNIQUEBUILD_ACC
+#undef UNIQUEBUILD_SCRAMBLE_HALF
+#undef UNIQUEBUILD_SCRAMBLE
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc), a0);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + 4), a1);
+}
+#endif
+
+/**
+ * Runs the stripe loop over an input longer than 128 bytes.
+ */
+inline void hashLong(uint64_t* acc, const uint8_t* p, size_t length, uint64_t seed) {
+    const uint64_t init[8] = {PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3,
+                              PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1};
+    for (int i = 0; i < 8; ++i) {
+        acc[i] = init[i] ^ seed;
+    }
+#ifdef UNIQUEBUILD_X86_DISPATCH
+    if (Cpu::hasAvx2()) {
+        hashLongAvx2(acc, p, length);
+        return;
+    }
+#endif
+    hashLongScalar(acc, p, length);
+}
+
+inline uint64_t mergeAccumulators(const uint64_t* acc, const uint8_t* key, uint64_t start) {
+    uint64_t result = start;
+    for (int i = 0; i < 4; ++i) {
+        result += mulFold64(acc[2 * i] ^ read64(key + 16 * i), acc[2 * i + 1] ^ read64(key + 16 * i + 8));
+    }
+    return avalanche(result);
+}
+
+#undef UNIQUEBUILD_HASH_LONG_LOOP
+
+}  // namespace detail
+
+/**
+ * Computes a 64-bit non-cryptographic hash.
+ * @param data: The bytes to hash.
+ * @param length: Number of bytes.
+ * @param seed: Optional seed selecting an independent hash function.
+ * @return: The hash value.
+ */
+inline uint64_t hash64(const void* data, size_t length, uint64_t seed = 0) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    if (length <= 128) return detail::hashShort(p, length, seed);
+    uint64_t acc[8];
+    detail::hashLong(acc, p, length, seed);
+    return detail::mergeAccumulators(acc, detail::secret() + 11, length * detail::PRIME64_1);
+}
+
+inline uint64_t hash64(std::string_view text, uint64_t seed = 0) {
+    return hash64(text.data(), text.size(), seed);
+}
+
+/**
+ * Computes a 128-bit non-cryptographic hash, for content fingerprints
+ * where 64 bits would make collisions across millions of files plausible.
+ * @param data: The bytes to hash.
+ * @param length: Number of bytes.
+ * @param seed: Optional seed.
+ * @return: The hash value.
+ */
+inline Hash128 hash128(const void* data, size_t length, uint64_t seed = 0) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    Hash128 result;
+    if (length <= 128) {
+        result.low = detail::hashShort(p, length, seed);
+        result.high = detail::hashShort(p, length, seed ^ detail::PRIME64_4);
+        return result;
+    }
+    uint64_t acc[8];
+    detail::hashLong(acc, p, length, seed);
+    result.low = detail::mergeAccumulators(acc, detail::secret() + 11, length * detail::PRIME64_1);
+    result.high = detail::mergeAccumulators(acc, detail::secret() + HASH_SECRET_SIZE - 64 - 11,
+                                            ~(length * detail::PRIME64_2));
+    return result;
+}
+
+inline Hash128 hash128(std::string_view text, uint64_t seed = 0) {
+    return hash128(text.data(), text.size(), seed);
+}
+
+/**
+ * @struct StringHash
+ * Hash functor for unordered containers keyed by strings. Transparent, so
+ * C++20 heterogeneous lookup can probe with a std::string_view.
+ */
+struct StringHash {
+    typedef void is_transparent;
+    size_t operator()(std::string_view text) const { return static_cast<size_t>(hash64(text)); }
+};
+
+/**
+ * @struct Sha256Digest
+ * A SHA-256 digest.
+ */
+struct Sha256Digest {
+    uint8_t bytes[32];  // Digest in big-endian byte order
+
+    bool operator==(const Sha256Digest& other) const { return std::memcmp(bytes, other.bytes, 32) == 0; }
+    bool operator!=(const Sha256Digest& other) const { return !(*this == other); }
+
+    /**
+     * @return: The digest as 64 lowercase hex characters.
+     */
+    std::string hex() const {
+        static const char digits[] = "0123456789abcdef";
+        std::string out(64, '0');
+        for (int i = 0; i < 32; ++i) {
+            out[2 * i] = digits[bytes[i] >> 4];
+            out[2 * i + 1] = digits[bytes[i] & 15];
+        }
+        return out;
+    }
+};
+
+namespace detail {
+
+inline const uint32_t* sha256RoundConstants() {
+    static const uint32_t k[64] = {
+        0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+        0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+        0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+        0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+        0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+        0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+        0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+        0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2};
+    return k;
+}
+
+inline uint32_t rotr32(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+inline void sha256CompressScalar(uint32_t* state, const uint8_t* blocks, size_t count) {
+    const uint32_t* k = sha256RoundConstants();
+    for (size_t block = 0; block < count; ++block, blocks += 64) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = Endian::loadBig<uint32_t>(blocks + 4 * i);
+        }
+        for (int i = 16; i < 64; ++i) {
+            const uint32_t s0 = rotr32(w[i - 15], 7) ^ rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const uint32_t s1 = rotr32(w[i - 2], 17) ^ rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; ++i) {
+            const uint32_t t1 = h + (rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+            const uint32_t t2 = (rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+}
+
+#ifdef UNIQUEBUILD_X86_DISPATCH
+UNIQUEBUILD_TARGET("sha,sse4.1")
+inline void sha256CompressShaNi(uint32_t* state, const uint8_t* blocks, size_t count) {
+    const uint32_t* k = sha256RoundConstants();
+    const __m128i byteSwap = _mm_set_epi64x(0x0C0D0E0F08090A0Bll, 0x0405060700010203ll);
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0xB1);  // CDAB
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1B);  // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);  // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);  // CDGH
+    for (size_t block = 0; block < count; ++block, blocks += 64) {
+        const __m128i abefSave = state0;
+        const __m128i cdghSave = state1;
+        __m128i w[4];
+        for (int g = 0; g < 16; ++g) {
+            if (g < 4) {
+                w[g] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 16 * g)), byteSwap);
+            }
+            const __m128i current = w[g & 3];
+            __m128i msg = _mm_add_epi32(current, _mm_loadu_si128(reinterpret_cast<const __m128i*>(k + 4 * g)));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+            if (g >= 3 && g <= 14) {
+                __m128i& next = w[(g + 1) & 3];
+                next = _mm_add_epi32(next, _mm_alignr_epi8(current, w[(g + 3) & 3], 4));
+                next = _mm_sha256msg2_epu32(next, current);
+            }
+            msg = _mm_shuffle_epi32(msg, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+            if (g >= 1 && g <= 12) {
+                w[(g + 3) & 3] = _mm_sha256msg1_epu32(w[(g + 3) & 3], current);
+            }
+        }
+        state0 = _mm_add_epi32(state0, abefSave);
+        state1 = _mm_add_epi32(state1, cdghSave);
+    }
+    tmp = _mm_shuffle_epi32(state0, 0x1B);  // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);  // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);  // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);  // HGFE
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), state1);
+}
+#endif
+
+#if defined(UNIQUEBUILD_NEON) && (defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO))
+#define UNIQUEBUILD_ARM_SHA2 1
+inline void sha256CompressArm(uint32_t* state, const uint8_t* blocks, size_t count) {
+    const uint32_t* k = sha256RoundConstants();
+    uint32x4_t state0 = vld1q_u32(state);
+    uint32x4_t state1 = vld1q_u32(state + 4);
+    for (size_t block = 0; block < count; ++block, blocks += 64) {
+        const uint32x4_t abcdSave = state0;
+        const uint32x4_t efghSave = state1;
+        uint32x4_t w[4];
+        for (int i = 0; i < 4; ++i) {
+            w[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(blocks + 16 * i)));
+        }
+        for (int g = 0; g < 16; ++g) {
+            const uint32x4_t wk = vaddq_u32(w[g & 3], vld1q_u32(k + 4 * g));
+            const uint32x4_t abcd = state0;
+            state0 = vsha256hq_u32(state0, state1, wk);
+            state1 = vsha256h2q_u32(state1, abcd, wk);
+            if (g < 12) {
+                w[g & 3] = vsha256su1q_u32(vsha256su0q_u32(w[g & 3], w[(g + 1) & 3]), w[(g + 2) & 3], w[(g + 3) & 3]);
+            }
+        }
+        state0 = vaddq_u32(state0, abcdSave);
+        state1 = vaddq_u32(state1, efghSave);
+    }
+    vst1q_u32(state, state0);
+    vst1q_u32(state + 4, state1);
+}
+#endif
+
+inline void sha256Compress(uint32_t* state, const uint8_t* blocks, size_t count) {
+#if defined(UNIQUEBUILD_X86_DISPATCH)
+    if (Cpu::hasSha()) {
+        sha256CompressShaNi(state, blocks, count);
+        return;
+    }
+#elif defined(UNIQUEBUILD_ARM_SHA2)
+    sha256CompressArm(state, blocks, count);
+    return;
+#endif
+    sha256CompressScalar(state, blocks, count);
+}
+
+}  // namespace detail
+
+/**
+ * @class Sha256
+ * Streaming SHA-256. Feed data with update() in pieces of any size and
+ * call finish() once; reset() starts a new digest.
+ */
+class Sha256 {
+public:
+    Sha256() { reset(); }
+
+    void reset() {
+        static const uint32_t initial[8] = {0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+                                            0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19};
+        std::memcpy(state_, initial, sizeof(state_));
+        buffered_ = 0;
+        total_ = 0;
+    }
+
+    /**
+     * Adds bytes to the digest.
+     * @param data: The bytes.
+     * @param length: Number of bytes.
+     */
+    void update(const void* data, size_t length) {
+        // Empty input may come with a null pointer, which memcpy must not see.
+        if (length == 0) return;
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        total_ += length;
+        if (buffered_ > 0) {
+            const size_t take = MIN(length, size_t(64) - buffered_);
+            std::memcpy(buffer_ + buffered_, p, take);
+            buffered_ += take;
+            p += take;
+            length -= take;
+            if (buffered_ < 64) return;
+            detail::sha256Compress(state_, buffer_, 1);
+            buffered_ = 0;
+        }
+        if (length >= 64) {
+            detail::sha256Compress(state_, p, length / 64);
+            p += length & ~size_t(63);
+            length &= 63;
+        }
+        std::memcpy(buffer_, p, length);
+        buffered_ = length;
+    }
+
+    void update(std::string_view text) { update(text.data(), text.size()); }
+
+    /**
+     * Pads and finishes the digest. Call reset() before reusing the object.
+     * @return: The digest.
+     */
+    Sha256Digest finish() {
+        const uint64_t bits = total_ * 8;
+        uint8_t padding[72] = {0x80};
+        const size_t padLength = (buffered_ < 56) ? (56 - buffered_) : (120 - buffered_);
+        for (int i = 0; i < 8; ++i) {
+            padding[padLength + i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+        }
+        update(padding, padLength + 8);
+        Sha256Digest digest;
+        for (int i = 0; i < 8; ++i) {
+            digest.bytes[4 * i] = static_cast<uint8_t>(state_[i] >> 24);
+            digest.bytes[4 * i + 1] = static_cast<uint8_t>(state_[i] >> 16);
+            digest.bytes[4 * i + 2] = static_cast<uint8_t>(state_[i] >> 8);
+            digest.bytes[4 * i + 3] = static_cast<uint8_t>(state_[i]);
+        }
+        return digest;
+    }
+
+    /**
+     * One-shot digest of a buffer.
+     */
+    static Sha256Digest digest(const void* data, size_t length) {
+        Sha256 sha;
+        sha.update(data, length);
+        return sha.finish();
+    }
+
+private:
+    uint32_t state_[8];  // Chaining value
+    uint8_t buffer_[64];  // Partial block
+    size_t buffered_;  // Bytes in buffer_
+    uint64_t total_;  // Bytes hashed so far
+};
+
+/**
+ * Hashes a file through a read-only mapping.
+ * @param filename: The file to hash.
+ * @param out: Receives the 128-bit hash.
+ * @return: True on success, false if the file cannot be opened or mapped.
+ */
+inline bool hashFile(const std::string& filename, Hash128& out) {
+    FileUtils::MappedFile file;
+    if (!file.open(filename)) return false;
+    file.adviseSequential();
+    out = hash128(file.data(), file.size());
+    return true;
+}
+
+/**
+ * SHA-256 of a file through a read-only mapping.
+ * @param filename: The file to hash.
+ * @param out: Receives the digest.
+ * @return: True on success, false if the file cannot be opened or mapped.
+ */
+inline bool sha256File(const std::string& filename, Sha256Digest& out) {
+    FileUtils::MappedFile file;
+    if (!file.open(filename)) return false;
+    file.adviseSequential();
+    out = Sha256::digest(file.data(), file.size());
+    return true;
+}
+
+namespace detail {
+
+/**
+ * Runs hashOne(i) for every file on up to THREAD_POOL_SIZE threads.
+ * Files are handed out one at a time so large files do not stall a chunk.
+ */
+template<typename F>
+size_t forEachFile(size_t count, std::vector<uint8_t>* ok, F hashOne) {
+    if (ok) ok->assign(count, 0);
+    std::atomic<size_t> next(0);
+    std::atomic<size_t> succeeded(0);
+    Parallel::forChunks(count, 1, [&](size_t, size_t, size_t) {
+        for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            if (hashOne(i)) {
+                if (ok) (*ok)[i] = 1;
+                succeeded.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    });
+    return succeeded.load();
+}
+
+}  // namespace detail
+
+/**
+ * Computes hashFile for many files in parallel.
+ * @param filenames: The files to hash.
+ * @param out: Resized to match; entries of failed files are zero.
+ * @param ok: Optional; resized to match, 1 where the file was hashed.
+ * @return: Number of files hashed successfully.
+ */
+inline size_t hashFiles(const std::vector<std::string>& filenames, std::vector<Hash128>& out,
+                        std::vector<uint8_t>* ok = nullptr) {
+    out.assign(filenames.size(), Hash128{0, 0});
+    return detail::forEachFile(filenames.size(), ok, [&](size_t i) { return hashFile(filenames[i], out[i]); });
+}
+
+/**
+ * Computes sha256File for many files in parallel.
+ * @param filenames: The files to hash.
+ * @param out: Resized to match; entries of failed files are zero.
+ * @param ok: Optional; resized to match, 1 where the file was hashed.
+ * @return: Number of files hashed successfully.
+ */
+inline size_t sha256Files(const std::vector<std::string>& filenames, std::vector<Sha256Digest>& out,
+                          std::vector<uint8_t>* ok = nullptr) {
+    out.assign(filenames.size(), Sha256Digest());
+    return detail::forEachFile(filenames.size(), ok, [&](size_t i) { return sha256File(filenames[i], out[i]); });
+}
+
+}  // namespace Hash
+
+}  // namespace UniqueBuild
+
+#endif  // UNIQUEBUILD_HASH_H
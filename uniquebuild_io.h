@@ -0,0 +1,676 @@
+/***************************************
+ * uniquebuild_io.h
+ * Batched file I/O: many whole-file reads, writes, stats and removals
+ * submitted at once through io_uring on Linux, or a pool of threads
+ * making blocking calls elsewhere.
+ *
+ * Part of uniquebuild; see uniquebuild.h.
+ ***************************************/
+
+#ifndef UNIQUEBUILD_IO_H
+#define UNIQUEBUILD_IO_H
+
+#include "uniquebuild_core.h"
+#include "uniquebuild_log.h"
+#include "uniquebuild_fs.h"
+
+#include <deque>        // Required for std::deque
+#include <functional>   // Required for std::function
+#include <future>       // Required for std::future, std::promise
+
+#if defined(OS_LINUX) && defined(__has_include)
+    #if __has_include(<linux/io_uring.h>)
+        #define UNIQUEBUILD_IO_URING
+        #include <linux/io_uring.h>
+        #include <sys/syscall.h>
+    #endif
+#endif
+
+/***************************************
+ * SECTION: Batched File I/O
+ * A recipe that reads or writes tens of thousands of small files pays
+ * one open/read/close round trip per file when it loops over
+ * FileUtils::readFile. BatchIO queues those operations and runs them
+ * together: with io_uring, every file's next step goes into one
+ * submission queue and a single io_uring_enter call starts hundreds of
+ * them; without it, BATCH_IO_THREADS threads make the blocking calls.
+ *
+ * Results are delivered through callbacks or futures. Callbacks always
+ * run on the thread that called run(), one at a time, and may queue
+ * more operations, which the same run() picks up.
+ ***************************************/
+
+/**
+ * BATCH_IO_QUEUE_DEPTH: io_uring submission queue size. Up to half as
+ * many files are in flight at once, each holding one descriptor.
+ */
+#define BATCH_IO_QUEUE_DEPTH 256
+
+/**
+ * BATCH_IO_THREADS: Threads making blocking calls when io_uring is
+ * unavailable. Higher than THREAD_POOL_SIZE since they mostly wait.
+ */
+#define BATCH_IO_THREADS 16
+
+/**
+ * BATCH_IO_MAX_TRANSFER: Largest single read or write submitted.
+ */
+#define BATCH_IO_MAX_TRANSFER (size_t(1) << 30)
+
+namespace UniqueBuild {
+
+namespace FileUtils {
+
+/**
+ * @enum IoBackend
+ * How a BatchIO runs its operations.
+ */
+enum class IoBackend {
+    IO_URING,  // Linux io_uring, one submission per batch of steps
+    THREADS  // Blocking calls on worker threads
+};
+
+/**
+ * @struct IoResult
+ * Outcome of one batched operation.
+ */
+struct IoResult {
+    int error = 0;  // 0 on success, otherwise an errno value
+    std::string data;  // read: the file's contents
+    uint64_t size = 0;  // read/write: bytes transferred; stat: file size
+    int64_t mtimeNs = 0;  // read/stat: modification time
+    uint32_t mode = 0;  // read/stat: st_mode bits
+
+    bool ok() const { return error == 0; }
+};
+
+/**
+ * @class BatchIO
+ * Queue of whole-file operations run together by run(). Not thread-safe;
+ * use one per thread.
+ */
+class BatchIO {
+public:
+    typedef std::function<void(IoResult&)> Callback;
+
+    /**
+     * @param preferred: IO_URING to use io_uring when the kernel offers
+     *                   every operation needed, THREADS to never use it.
+     * @param queueDepth: Submission queue size for io_uring.
+     */
+    explicit BatchIO(IoBackend preferred = IoBackend::IO_URING, unsigned queueDepth = BATCH_IO_QUEUE_DEPTH)
+        : backend_(IoBackend::THREADS) {
+#ifdef UNIQUEBUILD_IO_URING
+        if (preferred == IoBackend::IO_URING && ring_.setup(queueDepth)) backend_ = IoBackend::IO_URING;
+#else
+        (void)preferred;
+        (void)queueDepth;
+#endif
+    }
+
+    BatchIO(const BatchIO&) = delete;
+    BatchIO& operator=(const BatchIO&) = delete;
+
+    /**
+     * @return: The backend run() uses.
+     */
+    IoBackend backend() const { return backend_; }
+
+    /**
+     * Queues reading a whole file; the callback receives it in data.
+     */
+    void read(const std::string& path, Callback callback) { queue(OP_READ, path, std::string(), std::move(callback)); }
+
+    /**
+     * Queues creating or truncating a file and writing content to it.
+     */
+    void write(const std::string& path, std::string content, Callback callback) {
+        queue(OP_WRITE, path, std::move(content), std::move(callback));
+    }
+
+    /**
+     * Queues a stat; a missing file completes with error ENOENT.
+     */
+    void stat(const std::string& path, Callback callback) { queue(OP_STAT, path, std::string(), std::move(callback)); }
+
+    /**
+     * Queues unlinking a file.
+     */
+    void remove(const std::string& path, Callback callback) {
+        queue(OP_REMOVE, path, std::string(), std::move(callback));
+    }
+
+    /**
+     * Future-returning forms of the above; the futures become ready
+     * during run().
+     */
+    std::future<IoResult> read(const std::string& path) { return promised(OP_READ, path, std::string()); }
+    std::future<IoResult> write(const std::string& path, std::string content) {
+        return promised(OP_WRITE, path, std::move(content));
+    }
+    std::future<IoResult> stat(const std::string& path) { return promised(OP_STAT, path, std::string()); }
+    std::future<IoResult> remove(const std::string& path) { return promised(OP_REMOVE, path, std::string()); }
+
+    /**
+     * @return: Number of operations queued and not yet run.
+     */
+    size_t pending() const { return requests_.size(); }
+
+    /**
+     * Runs every queued operation, including ones queued by callbacks
+     * meanwhile, and returns once all have completed.
+     * @return: Number of operations that failed.
+     */
+    size_t run() {
+        failures_ = 0;
+        size_t begin = 0;
+#ifdef UNIQUEBUILD_IO_URING
+        if (backend_ == IoBackend::IO_URING) {
+            runRing();
+            begin = requests_.size();
+        }
+#endif
+        while (begin < requests_.size()) {
+            const size_t end = requests_.size();
+            runThreads(begin, end);
+            begin = end;
+        }
+        requests_.clear();
+        return failures_;
+    }
+
+private:
+    enum OpKind : uint8_t { OP_READ, OP_WRITE, OP_STAT, OP_REMOVE };
+
+    /**
+     * One queued operation. Lives in a deque so the path and buffers
+     * stay put while the kernel refers to them.
+     */
+    struct Request {
+        OpKind kind;  // What to do
+        std::string path;  // File operated on
+        Callback callback;  // Called once with the result
+        IoResult result;  // Filled in as steps complete
+        int fd = -1;  // Open descriptor between steps
+        unsigned outstanding = 0;  // io_uring completions still expected
+        uint64_t offset = 0;  // Bytes transferred so far
+        bool done = false;  // Whether the callback has run
+#ifdef UNIQUEBUILD_IO_URING
+        struct statx info;  // statx target
+#endif
+    };
+
+    void queue(OpKind kind, const std::string& path, std::string content, Callback callback) {
+        requests_.emplace_back();
+        Request& request = requests_.back();
+        request.kind = kind;
+        request.path = path;
+        request.callback = std::move(callback);
+        request.result.data = std::move(content);
+    }
+
+    std::future<IoResult> promised(OpKind kind, const std::string& path, std::string content) {
+        std::shared_ptr<std::promise<IoResult>> promise = std::make_shared<std::promise<IoResult>>();
+        std::future<IoResult> future = promise->get_future();
+        queue(kind, path, std::move(content), [promise](IoResult& result) { promise->set_value(std::move(result)); });
+        return future;
+    }
+
+    void complete(Request& request) {
+        if (request.kind == OP_WRITE && request.result.ok()) request.result.data.clear();
+        if (!request.result.ok()) ++failures_;
+        request.done = true;
+        if (request.callback) request.callback(request.result);
+        request.callback = nullptr;
+        request.result.data = std::string();
+    }
+
+    /**
+     * Runs one request with blocking calls.
+     */
+    static void runBlocking(Request& request) {
+        IoResult& result = request.result;
+#ifdef UNIQUEBUILD_POSIX
+        struct stat info;
+        switch (request.kind) {
+            case OP_READ: {
+                const int fd = ::open(request.path.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0 || ::fstat(fd, &info) != 0) {
+                    result.error = errno;
+                    if (fd >= 0) ::close(fd);
+                    return;
+                }
+                setStat(result, info);
+                result.data.resize(size_t(info.st_size) + 1);
+                size_t filled = 0;
+                for (;;) {
+                    if (filled == result.data.size()) result.data.resize(result.data.size() * 2);
+                    const ssize_t n = ::read(fd, &result.data[filled], MIN(result.data.size() - filled, BATCH_IO_MAX_TRANSFER));
+                    if (n < 0 && errno == EINTR) continue;
+                    if (n < 0) result.error = errno;
+                    if (n <= 0) break;
+                    filled += size_t(n);
+                }
+                ::close(fd);
+                result.data.resize(filled);
+                result.size = filled;
+                return;
+            }
+            case OP_WRITE: {
+                const int fd = ::open(request.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+                if (fd < 0) {
+                    result.error = errno;
+                    return;
+                }
+                size_t written = 0;
+                while (written < result.data.size()) {
+                    const ssize_t n = ::write(fd, result.data.data() + written, MIN(result.data.size() - written, BATCH_IO_MAX_TRANSFER));
+                    if (n < 0 && errno == EINTR) continue;
+                    if (n < 0) {
+                        result.error = errno;
+                        break;
+                    }
+                    written += size_t(n);
+                }
+                if (::close(fd) != 0 && result.error == 0) result.error = errno;
+                result.size = written;
+                return;
+            }
+            case OP_STAT:
+                if (::stat(request.path.c_str(), &info) != 0) {
+                    result.error = errno;
+                } else {
+                    setStat(result, info);
+                }
+                return;
+            case OP_REMOVE:
+                if (::unlink(request.path.c_str()) != 0) result.error = errno;
+                return;
+        }
+#else
+        std::error_code ec;
+        switch (request.kind) {
+            case OP_READ: {
+                std::ifstream in(request.path, std::ios::binary);
+                if (!in) {
+                    result.error = ENOENT;
+                    return;
+                }
+                result.data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+                result.size = result.data.size();
+                return;
+            }
+            case OP_WRITE: {
+                std::ofstream out(request.path, std::ios::binary | std::ios::trunc);
+                if (!out.write(result.data.data(), std::streamsize(result.data.size()))) result.error = EIO;
+                result.size = result.data.size();
+                return;
+            }
+            case OP_STAT:
+                result.size = std::filesystem::file_size(request.path, ec);
+                if (ec) result.error = ec.value();
+                return;
+            case OP_REMOVE:
+                if (!std::filesystem::remove(request.path, ec)) result.error = ec ? ec.value() : ENOENT;
+                return;
+        }
+#endif
+    }
+
+#ifdef UNIQUEBUILD_POSIX
+    static void setStat(IoResult& result, const struct stat& info) {
+        result.size = uint64_t(info.st_size);
+        result.mode = uint32_t(info.st_mode);
+#if defined(OS_MAC)
+        result.mtimeNs = int64_t(info.st_mtimespec.tv_sec) * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+        result.mtimeNs = int64_t(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+    }
+#endif
+
+    /**
+     * Runs the queued requests on worker threads, then their callbacks
+     * on this thread in queue order.
+     */
+    void runThreads(size_t begin, size_t end) {
+        std::atomic<size_t> next(begin);
+        auto work = [this, &next, end] {
+            for (size_t i = next.fetch_add(1); i < end; i = next.fetch_add(1)) runBlocking(requests_[i]);
+        };
+#if ENABLE_MULTITHREADING
+        std::vector<std::thread> workers;
+        const size_t threads = MIN(size_t(BATCH_IO_THREADS), end - begin);
+        for (size_t t = 1; t < threads; ++t) workers.emplace_back(work);
+        work();
+        for (auto& worker : workers) worker.join();
+#else
+        work();
+#endif
+        for (size_t i = begin; i < end; ++i) complete(requests_[i]);
+    }
+
+#ifdef UNIQUEBUILD_IO_URING
+    /**
+     * @class Ring
+     * Minimal io_uring wrapper over the raw system calls: the mapped
+     * submission and completion rings and the SQE array.
+     */
+    class Ring {
+    public:
+        Ring() : fd_(-1), ringBase_(nullptr), ringSize_(0), completionBase_(nullptr), completionSize_(0), sqes_(nullptr), sqeSize_(0) {}
+
+        ~Ring() {
+            if (sqes_) ::munmap(sqes_, sqeSize_);
+            if (completionBase_ && completionBase_ != ringBase_) ::munmap(completionBase_, completionSize_);
+            if (ringBase_) ::munmap(ringBase_, ringSize_);
+            if (fd_ >= 0) ::close(fd_);
+        }
+
+        /**
+         * Creates the ring and checks that the kernel supports every
+         * operation BatchIO submits.
+         * @return: False if io_uring is unavailable or too old.
+         */
+        bool setup(unsigned entries) {
+            struct io_uring_params params;
+            std::memset(&params, 0, sizeof(params));
+            params.flags = IORING_SETUP_CQSIZE;
+            params.cq_entries = entries * 2;
+            fd_ = int(::syscall(__NR_io_uring_setup, entries, &params));
+            if (fd_ < 0) return false;
+            if (!(params.features & IORING_FEAT_NODROP) || !supportsOps()) return false;
+
+            ringSize_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+            completionSize_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+            const bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (single) ringSize_ = completionSize_ = MAX(ringSize_, completionSize_);
+            ringBase_ = map(ringSize_, IORING_OFF_SQ_RING);
+            if (ringBase_ == nullptr) return false;
+            completionBase_ = single ? ringBase_ : map(completionSize_, IORING_OFF_CQ_RING);
+            if (completionBase_ == nullptr) return false;
+            sqeSize_ = params.sq_entries * sizeof(struct io_uring_sqe);
+            sqes_ = static_cast<struct io_uring_sqe*>(map(sqeSize_, IORING_OFF_SQES));
+            if (sqes_ == nullptr) return false;
+
+            uint8_t* sq = static_cast<uint8_t*>(ringBase_);
+            sqHead_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+            sqTail_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+            sqMask_ = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+            sqArray_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+            uint8_t* cq = static_cast<uint8_t*>(completionBase_);
+            cqHead_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+            cqTail_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+            cqMask_ = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+            cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+            entries_ = params.sq_entries;
+            localTail_ = *sqTail_;
+            unsubmitted_ = 0;
+            return true;
+        }
+
+        unsigned entries() const { return entries_; }
+
+        /**
+         * @return: A cleared SQE to fill in. The caller keeps the number
+         *          of SQEs in flight at or below entries(), so one is
+         *          always free.
+         */
+        struct io_uring_sqe* next(uint64_t userData) {
+            const uint32_t index = localTail_ & sqMask_;
+            struct io_uring_sqe* sqe = &sqes_[index];
+            std::memset(sqe, 0, sizeof(*sqe));
+            sqe->user_data = userData;
+            sqArray_[index] = index;
+            ++localTail_;
+            ++unsubmitted_;
+            return sqe;
+        }
+
+        /**
+         * Publishes the new SQEs and waits for at least one completion.
+         * EINTR is retried; on EBUSY or EAGAIN the caller reaps and calls
+         * again. Other errors mean the SQEs are malformed, and since the
+         * kernel may still own buffers of the ones in flight, there is no
+         * safe way to continue.
+         */
+        void submitAndWait() {
+            __atomic_store_n(sqTail_, localTail_, __ATOMIC_RELEASE);
+            for (;;) {
+                const long submitted = ::syscall(__NR_io_uring_enter, fd_, unsubmitted_, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+                if (submitted >= 0) {
+                    unsubmitted_ -= unsigned(submitted);
+                    return;
+                }
+                if (errno == EINTR) continue;
+                if (errno == EBUSY || errno == EAGAIN) return;
+                LOG_ERROR("BatchIO: io_uring_enter failed");
+                std::abort();
+            }
+        }
+
+        /**
+         * Calls fn(userData, res) for every completion available.
+         */
+        template <typename F>
+        void reap(F&& fn) {
+            uint32_t head = *cqHead_;
+            for (;;) {
+                const uint32_t tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+                if (head == tail) break;
+                while (head != tail) {
+                    const struct io_uring_cqe& cqe = cqes_[head & cqMask_];
+                    const uint64_t userData = cqe.user_data;
+                    const int32_t res = cqe.res;
+                    ++head;
+                    __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+                    fn(userData, res);
+                }
+            }
+        }
+
+    private:
+        void* map(size_t size, uint64_t offset) {
+            void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, off_t(offset));
+            return p == MAP_FAILED ? nullptr : p;
+        }
+
+        bool supportsOps() {
+            const unsigned count = IORING_OP_UNLINKAT + 1;
+            std::vector<uint8_t> buffer(sizeof(struct io_uring_probe) + count * sizeof(struct io_uring_probe_op), 0);
+            struct io_uring_probe* probe = reinterpret_cast<struct io_uring_probe*>(buffer.data());
+            if (::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_PROBE, probe, count) < 0) return false;
+            const int needed[] = {IORING_OP_OPENAT, IORING_OP_CLOSE, IORING_OP_STATX,
+                                  IORING_OP_READ, IORING_OP_WRITE, IORING_OP_UNLINKAT};
+            for (int op : needed) {
+                if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) return false;
+            }
+            return true;
+        }
+
+        int fd_;  // io_uring descriptor
+        void* ringBase_;  // Submission ring mapping (and completion ring with SINGLE_MMAP)
+        size_t ringSize_;  // Its length
+        void* completionBase_;  // Completion ring mapping
+        size_t completionSize_;  // Its length
+        struct io_uring_sqe* sqes_;  // SQE array
+        size_t sqeSize_;  // Its length
+        uint32_t* sqHead_;  // Kernel-owned submission head
+        uint32_t* sqTail_;  // Our submission tail
+        uint32_t sqMask_;  // Submission index mask
+        uint32_t* sqArray_;  // Submission index array
+        uint32_t* cqHead_;  // Our completion head
+        uint32_t* cqTail_;  // Kernel-owned completion tail
+        uint32_t cqMask_;  // Completion index mask
+        struct io_uring_cqe* cqes_;  // Completion entries
+        unsigned entries_;  // Submission queue size
+        uint32_t localTail_;  // Tail including SQEs not yet published
+        unsigned unsubmitted_;  // SQEs not yet consumed by the kernel
+    };
+
+    // Steps of a request, kept in the low bits of user_data.
+    enum Step : uint64_t { STEP_OPEN = 0, STEP_STAT = 1, STEP_TRANSFER = 2, STEP_CLOSE = 3 };
+
+    static uint64_t tag(Request& request, Step step) { return reinterpret_cast<uint64_t>(&request) | step; }
+
+    void submitOpen(Request& request, int flags) {
+        struct io_uring_sqe* sqe = ring_.next(tag(request, STEP_OPEN));
+        sqe->opcode = IORING_OP_OPENAT;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = reinterpret_cast<uint64_t>(request.path.c_str());
+        sqe->open_flags = uint32_t(flags | O_CLOEXEC);
+        sqe->len = 0666;
+        ++request.outstanding;
+    }
+
+    void submitStat(Request& request) {
+        struct io_uring_sqe* sqe = ring_.next(tag(request, STEP_STAT));
+        sqe->opcode = IORING_OP_STATX;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = reinterpret_cast<uint64_t>(request.path.c_str());
+        sqe->len = STATX_TYPE | STATX_MODE | STATX_SIZE | STATX_MTIME;
+        sqe->off = reinterpret_cast<uint64_t>(&request.info);
+        ++request.outstanding;
+    }
+
+    void submitTransfer(Request& request) {
+        struct io_uring_sqe* sqe = ring_.next(tag(request, STEP_TRANSFER));
+        std::string& data = request.result.data;
+        sqe->opcode = request.kind == OP_READ ? IORING_OP_READ : IORING_OP_WRITE;
+        sqe->fd = request.fd;
+        sqe->addr = reinterpret_cast<uint64_t>(&data[0] + request.offset);
+        sqe->len = uint32_t(MIN(size_t(data.size() - request.offset), BATCH_IO_MAX_TRANSFER));
+        sqe->off = request.offset;
+        ++request.outstanding;
+    }
+
+    void submitClose(Request& request) {
+        struct io_uring_sqe* sqe = ring_.next(tag(request, STEP_CLOSE));
+        sqe->opcode = IORING_OP_CLOSE;
+        sqe->fd = request.fd;
+        request.fd = -1;
+        ++request.outstanding;
+    }
+
+    void submitRemove(Request& request) {
+        struct io_uring_sqe* sqe = ring_.next(tag(request, STEP_TRANSFER));
+        sqe->opcode = IORING_OP_UNLINKAT;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = reinterpret_cast<uint64_t>(request.path.c_str());
+        ++request.outstanding;
+    }
+
+    /**
+     * Submits the first step of a request: open and statx together for
+     * reads, open for writes, statx or unlinkat otherwise.
+     */
+    void start(Request& request) {
+        switch (request.kind) {
+            case OP_READ:
+                submitOpen(request, O_RDONLY);
+                submitStat(request);
+                break;
+            case OP_WRITE:
+                submitOpen(request, O_WRONLY | O_CREAT | O_TRUNC);
+                break;
+            case OP_STAT:
+                submitStat(request);
+                break;
+            case OP_REMOVE:
+                submitRemove(request);
+                break;
+        }
+    }
+
+    /**
+     * Advances a request by one completion; submits its next step or
+     * closes it and, once closed, completes it.
+     */
+    void advance(Request& request, Step step, int32_t res) {
+        IoResult& result = request.result;
+        --request.outstanding;
+        if (res < 0 && result.error == 0 && step != STEP_CLOSE) result.error = -res;
+        switch (step) {
+            case STEP_OPEN:
+                if (res >= 0) request.fd = res;
+                break;
+            case STEP_STAT:
+                if (res >= 0) {
+                    result.size = request.info.stx_size;
+                    result.mode = request.info.stx_mode;
+                    result.mtimeNs = int64_t(request.info.stx_mtime.tv_sec) * 1000000000 + request.info.stx_mtime.tv_nsec;
+                    if (request.kind == OP_READ) result.data.resize(size_t(request.info.stx_size) + 1);
+                }
+                break;
+            case STEP_TRANSFER:
+                if (res > 0) request.offset += uint64_t(res);
+                if (request.kind == OP_READ && res >= 0) {
+                    // Done at end of file, or once a regular file's stat size is in.
+                    const bool done = res == 0 || (S_ISREG(result.mode) && request.offset == result.size && request.offset < result.data.size());
+                    if (!done) {
+                        if (request.offset == result.data.size()) result.data.resize(result.data.size() * 2);
+                        submitTransfer(request);
+                        return;
+                    }
+                    result.data.resize(size_t(request.offset));
+                    result.size = request.offset;
+                } else if (request.kind == OP_WRITE && res >= 0) {
+                    result.size = request.offset;
+                    if (request.offset < result.data.size()) {
+                        submitTransfer(request);
+                        return;
+                    }
+                }
+                break;
+            case STEP_CLOSE:
+                if (res < 0 && result.error == 0 && request.kind == OP_WRITE) result.error = -res;
+                break;
+        }
+        if (request.outstanding > 0) return;
+        if (request.fd >= 0) {
+            if (result.error == 0 && (step == STEP_OPEN || step == STEP_STAT)) {
+                if (request.kind == OP_WRITE && result.data.empty()) {
+                    submitClose(request);
+                } else {
+                    submitTransfer(request);
+                }
+            } else {
+                submitClose(request);
+            }
+            return;
+        }
+        complete(request);
+    }
+
+    /**
+     * Runs the queue through the ring, keeping at most half its entries'
+     * worth of requests in flight so every step's SQE fits.
+     */
+    void runRing() {
+        const size_t limit = ring_.entries() / 2;
+        size_t next = 0;
+        size_t active = 0;
+        while (next < requests_.size() || active > 0) {
+            for (; next < requests_.size() && active < limit; ++next, ++active) start(requests_[next]);
+            ring_.submitAndWait();
+            ring_.reap([this, &active](uint64_t userData, int32_t res) {
+                Request& request = *reinterpret_cast<Request*>(userData & ~uint64_t(3));
+                advance(request, Step(userData & 3), res);
+                if (request.done) --active;
+            });
+        }
+    }
+
+    Ring ring_;  // io_uring instance when backend_ is IO_URING
+#endif
+
+    IoBackend backend_;  // Backend run() uses
+    std::deque<Request> requests_;  // Queued requests, in queue order
+    size_t failures_ = 0;  // Requests that failed in the current run
+};
+
+}  // namespace FileUtils
+
+}  // namespace UniqueBuild
+
+#endif  // UNIQUEBUILD_IO_H
@@ -0,0 +1,681 @@
+/***************************************
+ * uniquebuild_log.h
+ * Logging macros, fast number formatting, buffered output, the print
+ * helpers and the streaming JSON writer.
+ *
+ * Part of uniquebuild; see uniquebuild.h.
+ ***************************************/
+
+#ifndef UNIQUEBUILD_LOG_H
+#define UNIQUEBUILD_LOG_H
+
+#include "uniquebuild_core.h"
+
+#include <charconv>     // Required for std::to_chars
+#include <cmath>        // Required for std::isfinite
+
+/***************************************
+ * SECTION: Logging Macros
+ * These macros provide a simple way to log messages to the console.
+ * Each log type has a different format for clarity.
+ ***************************************/
+
+/**
+ * LOG_INFO(msg): Logs an informational message to the console.
+ * @param msg: The message to log.
+ */
+#define LOG_INFO(msg) printf("[INFO] %s\n", msg)
+
+/**
+ * LOG_WARN(msg): Logs a warning message to the console.
+ * Warnings indicate potential issues but do not stop program execution.
+ * @param msg: The warning message.
+ */
+#define LOG_WARN(msg) printf("[WARN] %s\n", msg)
+
+/**
+ * LOG_ERROR(msg): Logs an error message to the console.
+ * Error messages should indicate critical failures that need attention.
+ * @param msg: The error message.
+ */
+#define LOG_ERROR(msg) printf("[ERROR] %s\n", msg)
+
+/**
+ * LOG_DEBUG(msg): Logs a debug message to the console.
+ * These are typically used during development for troubleshooting.
+ * @param msg: The debug message.
+ */
+#define LOG_DEBUG(msg) printf("[DEBUG] %s\n", msg)
+
+/***************************************
+ * SECTION: Fast Formatting
+ * Number formatting without iostreams, and a buffered sink that collects
+ * formatted text and hands it to a FILE* in large writes. Integers use a
+ * two-digits-per-step lookup table; floating-point values use the
+ * shortest representation that reads back to the same value.
+ ***************************************/
+
+/**
+ * OUTPUT_SINK_CAPACITY: Bytes a BufferedSink collects before it writes.
+ */
+#define OUTPUT_SINK_CAPACITY 65536
+
+/**
+ * FORMAT_BUFFER_SIZE: Enough room for any integer or shortest double.
+ */
+#define FORMAT_BUFFER_SIZE 32
+
+namespace UniqueBuild {
+
+/**
+ * @namespace Format
+ * Integer and floating-point to text conversion and buffered output.
+ */
+namespace Format {
+
+namespace detail {
+
+inline const char* digitPairs() {
+    static const char table[201] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+    return table;
+}
+
+inline int digitCount(uint64_t value) {
+    int count = 1;
+    for (;;) {
+        if (value < 10) return count;
+        if (value < 100) return count + 1;
+        if (value < 1000) return count + 2;
+        if (value < 10000) return count + 3;
+        value /= 10000u;
+        count += 4;
+    }
+}
+
+}  // namespace detail
+
+/**
+ * Writes the decimal digits of value to out. No terminator is written.
+ * @param out: Destination with room for at least 20 characters.
+ * @param value: The value.
+ * @return: Pointer past the last character written.
+ */
+inline char* formatUint(char* out, uint64_t value) {
+    const char* pairs = detail::digitPairs();
+    char* end = out + detail::digitCount(value);
+    char* p = end;
+    while (value >= 100) {
+        const unsigned index = static_cast<unsigned>(value % 100) * 2;
+        value /= 100;
+        p -= 2;
+        p[0] = pairs[index];
+        p[1] = pairs[index + 1];
+    }
+    if (value >= 10) {
+        p -= 2;
+        p[0] = pairs[value * 2];
+        p[1] = pairs[value * 2 + 1];
+    } else {
+        *--p = static_cast<char>('0' + value);
+    }
+    return end;
+}
+
+/**
+ * Writes value in decimal, with a leading '-' when negative.
+ * @param out: Destination with room for at least 20 characters.
+ * @param value: The value.
+ * @return: Pointer past the last character written.
+ */
+inline char* formatInt(char* out, int64_t value) {
+    uint64_t magnitude = static_cast<uint64_t>(value);
+    if (value < 0) {
+        *out++ = '-';
+        magnitude = 0 - magnitude;
+    }
+    return formatUint(out, magnitude);
+}
+
+/**
+ * Writes the shortest decimal form of value that parses back to exactly
+ * value ("0.1", "1e+100", "inf", "nan"). Uses std::to_chars, which
+ * implements the Ryu algorithm in current standard libraries, and falls
+ * back to increasing %g precision elsewhere.
+ * @param out: Destination with room for FORMAT_BUFFER_SIZE characters.
+ * @param value: The value.
+ * @return: Pointer past the last character written.
+ */
+inline char* formatDouble(char* out, double value) {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    return std::to_chars(out, out + FORMAT_BUFFER_SIZE, value).ptr;
+#else
+    int length = 0;
+    for (int precision = 15; precision <= 17; ++precision) {
+        length = std::snprintf(out, FORMAT_BUFFER_SIZE, "%.*g", precision, value);
+        if (std::strtod(out, nullptr) == value || value != value) break;
+    }
+    return out + length;
+#endif
+}
+
+/**
+ * Float version of formatDouble; shortest form that reads back as the same float.
+ */
+inline char* formatFloat(char* out, float value) {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    return std::to_chars(out, out + FORMAT_BUFFER_SIZE, value).ptr;
+#else
+    int length = 0;
+    for (int precision = 6; precision <= 9; ++precision) {
+        length = std::snprintf(out, FORMAT_BUFFER_SIZE, "%.*g", precision, static_cast<double>(value));
+        if (std::strtof(out, nullptr) == value || value != value) break;
+    }
+    return out + length;
+#endif
+}
+
+/**
+ * @class BufferedSink
+ * Collects text in a fixed buffer and writes it to a FILE* only when the
+ * buffer fills, on flush(), or on destruction. Newlines never flush, so a
+ * thousand lines cost one write instead of a thousand.
+ * Writes go through stdio, so output stays ordered with printf and with
+ * std::cout (which is synchronized with stdio by default).
+ */
+class BufferedSink {
+public:
+    explicit BufferedSink(std::FILE* file = stdout) : file_(file), used_(0) {}
+    ~BufferedSink() { flush(); }
+
+    BufferedSink(const BufferedSink&) = delete;
+    BufferedSink& operator=(const BufferedSink&) = delete;
+
+    /**
+     * Appends raw text.
+     * @param text: The text to append.
+     */
+    void append(std::string_view text) {
+        if (text.size() > OUTPUT_SINK_CAPACITY - used_) {
+            flush();
+            if (text.size() >= OUTPUT_SINK_CAPACITY) {
+                std::fwrite(text.data(), 1, text.size(), file_);
+                return;
+            }
+        }
+        std::memcpy(buffer_ + used_, text.data(), text.size());
+        used_ += text.size();
+    }
+
+    void put(char c) {
+        if (used_ == OUTPUT_SINK_CAPACITY) flush();
+        buffer_[used_++] = c;
+    }
+
+    void appendInt(int64_t value) {
+        reserve(FORMAT_BUFFER_SIZE);
+        used_ = size_t(formatInt(buffer_ + used_, value) - buffer_);
+    }
+
+    void appendUint(uint64_t value) {
+        reserve(FORMAT_BUFFER_SIZE);
+        used_ = size_t(formatUint(buffer_ + used_, value) - buffer_);
+    }
+
+    void appendDouble(double value) {
+        reserve(FORMAT_BUFFER_SIZE);
+        used_ = size_t(formatDouble(buffer_ + used_, value) - buffer_);
+    }
+
+    void appendFloat(float value) {
+        reserve(FORMAT_BUFFER_SIZE);
+        used_ = size_t(formatFloat(buffer_ + used_, value) - buffer_);
+    }
+
+    /**
+     * Hands the buffered text to the FILE*. Does not fflush the FILE
+     * itself; use flushOutput() for that.
+     */
+    void flush() {
+        if (used_ > 0) {
+            std::fwrite(buffer_, 1, used_, file_);
+            used_ = 0;
+        }
+    }
+
+    /**
+     * @return: Number of bytes waiting in the buffer.
+     */
+    size_t size() const { return used_; }
+
+private:
+    void reserve(size_t bytes) {
+        if (OUTPUT_SINK_CAPACITY - used_ < bytes) flush();
+    }
+
+    std::FILE* file_;  // Destination stream
+    size_t used_;  // Bytes currently buffered
+    char buffer_[OUTPUT_SINK_CAPACITY];  // Pending output
+};
+
+/**
+ * @return: This thread's sink for stdout, used by printArray and
+ *          printVector. It lives on the heap so they stay cheap on small
+ *          stacks; callers flush it before returning.
+ */
+inline BufferedSink& threadOutput() {
+    thread_local std::unique_ptr<BufferedSink> sink;
+    if (!sink) sink.reset(new BufferedSink(stdout));
+    return *sink;
+}
+
+/**
+ * Overloads used by printArray and printVector to format one element.
+ * Narrow integer types promote to the int overload.
+ */
+inline void appendValue(BufferedSink& sink, int value) { sink.appendInt(value); }
+inline void appendValue(BufferedSink& sink, long value) { sink.appendInt(value); }
+inline void appendValue(BufferedSink& sink, long long value) { sink.appendInt(value); }
+inline void appendValue(BufferedSink& sink, unsigned value) { sink.appendUint(value); }
+inline void appendValue(BufferedSink& sink, unsigned long value) { sink.appendUint(value); }
+inline void appendValue(BufferedSink& sink, unsigned long long value) { sink.appendUint(value); }
+inline void appendValue(BufferedSink& sink, float value) { sink.appendFloat(value); }
+inline void appendValue(BufferedSink& sink, double value) { sink.appendDouble(value); }
+inline void appendValue(BufferedSink& sink, const char* value) { sink.append(value); }
+inline void appendValue(BufferedSink& sink, const std::string& value) { sink.append(value); }
+
+/**
+ * Explicit flush point: pushes everything written to stdout so far to the
+ * terminal or file. Call before blocking on input or handing off to a
+ * child process.
+ */
+inline void flushOutput() {
+    std::fflush(stdout);
+}
+
+}  // namespace Format
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: JSON Writer
+ * Streams JSON straight into a sink: no document tree, no intermediate
+ * strings. Used for compile_commands.json and meant for any other
+ * machine-readable output (trace files, benchmark results).
+ ***************************************/
+
+namespace UniqueBuild {
+
+/**
+ * @namespace Json
+ * Streaming JSON output.
+ */
+namespace Json {
+
+/**
+ * @class StringSink
+ * Sink that collects output in a std::string, e.g. to cache a fragment.
+ */
+class StringSink {
+public:
+    void append(std::string_view text) { text_.append(text.data(), text.size()); }
+    void put(char c) { text_.push_back(c); }
+    void clear() { text_.clear(); }
+    const std::string& str() const { return text_; }
+
+private:
+    std::string text_;  // Collected output
+};
+
+/**
+ * @class Writer
+ * Writes one JSON value to a sink. Commas, colons and, optionally,
+ * indentation are inserted automatically; string escaping copies runs of
+ * plain characters in one append. The caller is responsible for pairing
+ * begin/end calls and for calling key() before each value in an object.
+ * An end call with nothing open is ignored.
+ * @tparam Sink: Any type with append(std::string_view) and put(char),
+ *               e.g. Format::BufferedSink or Json::StringSink.
+ */
+template <typename Sink>
+class Writer {
+public:
+    /**
+     * @param sink: Receives the output; must outlive the writer.
+     * @param indent: Spaces per nesting level; 0 writes everything on one line.
+     */
+    explicit Writer(Sink& sink, int indent = 0) : sink_(sink), indent_(indent), depth_(0), hasItems_(false), afterKey_(false) {}
+
+    Writer& beginObject() { return open('{'); }
+    Writer& endObject() { return close('}'); }
+    Writer& beginArray() { return open('['); }
+    Writer& endArray() { return close(']'); }
+
+    /**
+     * Writes an object key; the next call writes its value.
+     */
+    Writer& key(std::string_view name) {
+        separate();
+        writeString(name);
+        sink_.put(':');
+        if (indent_ > 0) sink_.put(' ');
+        afterKey_ = true;
+        return *this;
+    }
+
+    Writer& value(std::string_view text) {
+        separate();
+        writeString(text);
+        return *this;
+    }
+
+    Writer& value(const char* text) { return value(std::string_view(text)); }
+
+    Writer& value(const std::string& text) { return value(std::string_view(text)); }
+
+    Writer& value(bool flag) { return raw(flag ? "true" : "false"); }
+
+    Writer& value(int64_t number) {
+        char buffer[FORMAT_BUFFER_SIZE];
+        return raw(std::string_view(buffer, size_t(Format::formatInt(buffer, number) - buffer)));
+    }
+
+    Writer& value(uint64_t number) {
+        char buffer[FORMAT_BUFFER_SIZE];
+        return raw(std::string_view(buffer, size_t(Format::formatUint(buffer, number) - buffer)));
+    }
+
+    Writer& value(int number) { return value(int64_t(number)); }
+
+    Writer& value(unsigned number) { return value(uint64_t(number)); }
+
+    /**
+     * Writes a number; NaN and infinities, which JSON cannot express, become null.
+     */
+    Writer& value(double number) {
+        if (!std::isfinite(number)) return null();
+        char buffer[FORMAT_BUFFER_SIZE];
+        return raw(std::string_view(buffer, size_t(Format::formatDouble(buffer, number) - buffer)));
+    }
+
+    Writer& null() { return raw("null"); }
+
+    /**
+     * Writes text that is already valid JSON, such as a cached fragment.
+     */
+    Writer& raw(std::string_view json) {
+        separate();
+        sink_.append(json);
+        return *this;
+    }
+
+    /**
+     * Shorthand for key(name).value(v).
+     */
+    template <typename T>
+    Writer& field(std::string_view name, const T& v) {
+        key(name);
+        return value(v);
+    }
+
+    /**
+     * @return: Current nesting depth; 0 once the top-level value is complete.
+     */
+    int depth() const { return depth_; }
+
+    /**
+     * Writes a string literal with JSON escaping.
+     */
+    static void escape(Sink& sink, std::string_view text) {
+        static const char HEX[] = "0123456789abcdef";
+        sink.put('"');
+        size_t run = 0;
+        for (size_t i = 0; i < text.size(); ++i) {
+            const unsigned char c = static_cast<unsigned char>(text[i]);
+            if (c >= 0x20 && c != '"' && c != '\\') continue;
+            sink.append(text.substr(run, i - run));
+            run = i + 1;
+            switch (c) {
+                case '"': sink.append("\\\""); break;
+                case '\\': sink.append("\\\\"); break;
+                case '\n': sink.append("\\n"); break;
+                case '\r': sink.append("\\r"); break;
+                case '\t': sink.append("\\t"); break;
+                case '\b': sink.append("\\b"); break;
+                case '\f': sink.append("\\f"); break;
+                default: {
+                    const char code[6] = {'\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 15]};
+                    sink.append(std::string_view(code, 6));
+                }
+            }
+        }
+        sink.append(text.substr(run));
+        sink.put('"');
+    }
+
+private:
+    void writeString(std::string_view text) { escape(sink_, text); }
+
+    void newline() {
+        sink_.put('\n');
+        for (int i = 0; i < depth_ * indent_; ++i) {
+            sink_.put(' ');
+        }
+    }
+
+    // Emits the comma and line break that precede a value or key.
+    void separate() {
+        if (afterKey_) {
+            afterKey_ = false;
+            return;
+        }
+        if (depth_ == 0) return;
+        if (hasItems_) sink_.put(',');
+        hasItems_ = true;
+        if (indent_ > 0) newline();
+    }
+
+    Writer& open(char bracket) {
+        separate();
+        sink_.put(bracket);
+        ++depth_;
+        hasItems_ = false;
+        return *this;
+    }
+
+    // The enclosing level always has an item afterwards: the one closed.
+    Writer& close(char bracket) {
+        if (depth_ == 0) return *this;
+        --depth_;
+        if (indent_ > 0 && hasItems_) newline();
+        sink_.put(bracket);
+        hasItems_ = true;
+        return *this;
+    }
+
+    Sink& sink_;  // Output
+    int indent_;  // Spaces per level, 0 for compact output
+    int depth_;  // Open objects and arrays
+    bool hasItems_;  // The innermost open level has an item
+    bool afterKey_;  // The next value follows a key
+};
+
+}  // namespace Json
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: Overloaded Functions
+ * These functions have the same name but different parameter types
+ * or numbers of parameters, demonstrating function overloading.
+ ***************************************/
+
+/**
+ * Overloaded function to print a message.
+ * Writes to stdout and ends the line with '\n' without flushing;
+ * see UniqueBuild::Format::flushOutput for explicit flush points.
+ * @param message: The message string.
+ */
+void print(const std::string& message);
+
+/**
+ * Overloaded function to print an integer.
+ * @param number: The integer to print.
+ */
+void print(int number);
+
+/**
+ * Overloaded function to print a floating-point number.
+ * Prints the shortest text that reads back as the same float.
+ * @param number: The float to print.
+ */
+void print(float number);
+
+/**
+ * Overloaded function to print a double-precision number.
+ * Prints the shortest text that reads back as the same double.
+ * @param number: The double to print.
+ */
+void print(double number);
+
+/***************************************
+ * SECTION: Function Templates
+ * Templates allow functions to work with any data type.
+ ***************************************/
+
+/**
+ * A generic template function to print the elements of an array, one per line.
+ * The whole array is formatted into the thread's output buffer and written in large blocks.
+ * @tparam T: The type of the array elements; needs a UniqueBuild::Format::appendValue overload.
+ * @param arr: The array to print.
+ * @param size: The size of the array.
+ */
+template<typename T>
+void printArray(const T arr[], int size) {
+    UniqueBuild::Format::BufferedSink& sink = UniqueBuild::Format::threadOutput();
+    for (int i = 0; i < size; i++) {
+        UniqueBuild::Format::appendValue(sink, arr[i]);
+        sink.put('\n');
+    }
+    sink.flush();
+}
+
+/***************************************
+ * SECTION: Specialized Template Functions
+ * Specialized templates provide custom implementations for specific types.
+ ***************************************/
+
+/**
+ * A specialized template function to print a bool array.
+ * Prints "true" for true and "false" for false.
+ * @param arr: The bool array.
+ * @param size: The size of the array.
+ */
+template<>
+inline void printArray<bool>(const bool arr[], int size) {
+    UniqueBuild::Format::BufferedSink& sink = UniqueBuild::Format::threadOutput();
+    for (int i = 0; i < size; i++) {
+        sink.append(arr[i] ? "true\n" : "false\n");
+    }
+    sink.flush();
+}
+
+/***************************************
+ * SECTION: Utility Functions
+ * These functions are general-purpose utilities that are commonly
+ * used across various parts of the program.
+ ***************************************/
+
+/**
+ * Utility function to print a line of dashes for formatting output.
+ */
+void printLine();
+
+/**
+ * Utility function to print a vector of integers.
+ * @param vec: The input vector of integers.
+ */
+void printVector(const std::vector<int>& vec);
+
+/**
+ * Utility function to get the current timestamp as a string.
+ * @return: The current timestamp.
+ */
+std::string getCurrentTimestamp();
+
+#endif  // UNIQUEBUILD_LOG_H
+
+
+/***************************************
+ * Out-of-line definitions, compiled in the one translation unit that
+ * defines UNIQUEBUILD_IMPLEMENTATION before including this header.
+ ***************************************/
+
+#if defined(UNIQUEBUILD_IMPLEMENTATION) && !defined(UNIQUEBUILD_LOG_IMPLEMENTED)
+#define UNIQUEBUILD_LOG_IMPLEMENTED
+
+#include <iostream>     // Required for std::cout
+#include <sstream>      // Required for std::stringstream
+#include <iomanip>      // Required for std::put_time
+#include <chrono>       // Required for std::chrono::system_clock
+#include <ctime>        // Required for std::localtime
+
+void print(const std::string& message) {
+    std::fwrite(message.data(), 1, message.size(), stdout);
+    std::fputc('\n', stdout);
+}
+
+void print(int number) {
+    char buffer[FORMAT_BUFFER_SIZE];
+    char* end = UniqueBuild::Format::formatInt(buffer, number);
+    *end++ = '\n';
+    std::fwrite(buffer, 1, size_t(end - buffer), stdout);
+}
+
+void print(float number) {
+    char buffer[FORMAT_BUFFER_SIZE + 1];
+    char* end = UniqueBuild::Format::formatFloat(buffer, number);
+    *end++ = '\n';
+    std::fwrite(buffer, 1, size_t(end - buffer), stdout);
+}
+
+void print(double number) {
+    char buffer[FORMAT_BUFFER_SIZE + 1];
+    char* end = UniqueBuild::Format::formatDouble(buffer, number);
+    *end++ = '\n';
+    std::fwrite(buffer, 1, size_t(end - buffer), stdout);
+}
+
+void printLine() {
+    std::cout << "----------------------------------------" << std::endl;
+}
+
+void printVector(const std::vector<int>& vec) {
+    UniqueBuild::Format::BufferedSink& sink = UniqueBuild::Format::threadOutput();
+    sink.append("[ ");
+    for (const int& val : vec) {
+        sink.appendInt(val);
+        sink.put(' ');
+    }
+    sink.append("]\n");
+    sink.flush();
+}
+
+std::string getCurrentTimestamp() {
+    auto now = std::chrono::system_clock::now();
+    auto in_time_t = std::chrono::system_clock::to_time_t(now);
+    std::stringstream ss;
+    ss << std::put_time(std::localtime(&in_time_t), "%Y-%m-%d %X");
+    return ss.str();
+}
+
+#endif  // UNIQUEBUILD_IMPLEMENTATION
@@ -0,0 +1,1466 @@
+/***************************************
+ * uniquebuild_math.h
+ * GCD/LCM, random numbers, vectorized integer search, and the small
+ * arithmetic helpers.
+ *
+ * Part of uniquebuild; see uniquebuild.h.
+ ***************************************/
+
+#ifndef UNIQUEBUILD_MATH_H
+#define UNIQUEBUILD_MATH_H
+
+#include "uniquebuild_core.h"
+#include "uniquebuild_cpu.h"
+
+#include <algorithm>    // Required for std::sort
+
+/***************************************
+ * SECTION: Namespaces
+ * The following namespaces are designed to group related functionalities.
+ * They help avoid naming collisions in larger projects and provide better
+ * code organization.
+ ***************************************/
+
+namespace UniqueBuild {
+
+/**
+ * @namespace MathUtils
+ * Contains various utility functions for mathematical calculations.
+ */
+namespace MathUtils {
+
+/**
+ * Computes the factorial of a number.
+ * @param n: The number to compute the factorial of.
+ * @return: The factorial of the number.
+ */
+int factorialInt(int n);           // Returns factorial as an int (for smaller n)
+unsigned long long factorial_ull(int n); // Returns factorial as unsigned long long (for larger n)
+
+/**
+ * Computes the greatest common divisor (GCD) of two numbers.
+ * Implemented with Stein's binary algorithm, see SECTION: GCD and LCM.
+ * @param a: First number.
+ * @param b: Second number.
+ * @return: The GCD of the two numbers.
+ */
+inline int gcd(int a, int b);
+
+}  // namespace MathUtils
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: Classes
+ * The following classes are designed to encapsulate related data and functions.
+ * Classes provide a blueprint for creating objects in the program.
+ ***************************************/
+
+/**
+ * @class MathOperations
+ * Provides various mathematical operations.
+ */
+class MathOperations {
+public:
+    /**
+     * Computes the square of a number.
+     * @param x: The number to square.
+     * @return: The square of the number.
+     */
+    int square(int x);
+
+    /**
+     * Computes the cube of a number.
+     * @param x: The number to cube.
+     * @return: The cube of the number.
+     */
+    int cube(int x);
+
+    /**
+     * Checks if a number is prime.
+     * @param x: The number to check.
+     * @return: True if the number is prime, false otherwise.
+     */
+    bool isPrime(int x);
+};
+
+/***************************************
+ * SECTION: GCD and LCM
+ * Stein's binary GCD for 8 to 128-bit integers, overflow-checked LCM,
+ * and array reductions that run in parallel chunks.
+ * The binary algorithm replaces Euclid's divisions with shifts by the
+ * trailing-zero count, which is a single instruction on x86 and ARM.
+ ***************************************/
+
+namespace UniqueBuild {
+
+namespace MathUtils {
+
+namespace detail {
+
+template<typename T>
+struct IsInteger : std::integral_constant<bool,
+    std::is_integral<T>::value && !std::is_same<T, bool>::value> {};
+
+template<typename T>
+struct IsSignedInteger : std::is_signed<T> {};
+
+template<typename T>
+struct MakeUnsigned : std::make_unsigned<T> {};
+
+#ifdef __SIZEOF_INT128__
+template<> struct IsInteger<__int128> : std::true_type {};
+template<> struct IsInteger<unsigned __int128> : std::true_type {};
+template<> struct IsSignedInteger<__int128> : std::true_type {};
+template<> struct IsSignedInteger<unsigned __int128> : std::false_type {};
+template<> struct MakeUnsigned<__int128> { typedef unsigned __int128 type; };
+template<> struct MakeUnsigned<unsigned __int128> { typedef unsigned __int128 type; };
+#endif
+
+inline int countTrailingZeros32(uint32_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(x);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, x);
+    return static_cast<int>(index);
+#else
+    int n = 0;
+    while (!(x & 1u)) { x >>= 1; ++n; }
+    return n;
+#endif
+}
+
+inline int countTrailingZeros64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return static_cast<int>(index);
+#else
+    const uint32_t low = static_cast<uint32_t>(x);
+    return low ? countTrailingZeros32(low) : 32 + countTrailingZeros32(static_cast<uint32_t>(x >> 32));
+#endif
+}
+
+/**
+ * Counts trailing zero bits. x must be non-zero.
+ */
+template<typename U>
+inline int countTrailingZeros(U x) {
+    return sizeof(U) <= sizeof(uint32_t) ? countTrailingZeros32(static_cast<uint32_t>(x))
+                                         : countTrailingZeros64(static_cast<uint64_t>(x));
+}
+
+#ifdef __SIZEOF_INT128__
+inline int countTrailingZeros(unsigned __int128 x) {
+    const uint64_t low = static_cast<uint64_t>(x);
+    return low ? countTrailingZeros64(low) : 64 + countTrailingZeros64(static_cast<uint64_t>(x >> 64));
+}
+#endif
+
+/**
+ * Returns |value| in the unsigned type of the same width.
+ * Well defined for the most negative value as well.
+ */
+template<typename T>
+inline typename MakeUnsigned<T>::type magnitude(T value) {
+    typedef typename MakeUnsigned<T>::type U;
+    return (IsSignedInteger<T>::value && value < T(0)) ? U(U(0) - U(value)) : U(value);
+}
+
+/**
+ * Stein's binary GCD on unsigned values.
+ */
+template<typename U>
+U binaryGcd(U a, U b) {
+    if (a == 0) return b;
+    if (b == 0) return a;
+    const int shift = countTrailingZeros(U(a | b));
+    a = U(a >> countTrailingZeros(a));
+    do {
+        b = U(b >> countTrailingZeros(b));
+        if (a > b) {
+            const U t = a;
+            a = b;
+            b = t;
+        }
+        b = U(b - a);
+    } while (b != 0);
+    return U(a << shift);
+}
+
+/**
+ * Largest value of U that still fits in T.
+ */
+template<typename T, typename U>
+inline U maxValue() {
+    return IsSignedInteger<T>::value ? U(U(~U(0)) >> 1) : U(~U(0));
+}
+
+/**
+ * LCM of two magnitudes; sets overflow instead of wrapping.
+ */
+template<typename T, typename U>
+U checkedLcm(U a, U b, bool& overflow) {
+    if (a == 0 || b == 0) return 0;
+    const U q = U(a / binaryGcd(a, b));
+    if (q > U(maxValue<T, U>() / b)) {
+        overflow = true;
+        return 0;
+    }
+    return U(q * b);
+}
+
+}  // namespace detail
+
+/**
+ * Computes the greatest common divisor of two integers of any width,
+ * including __int128 where the compiler provides it.
+ * The result is always non-negative; gcd(0, 0) is 0. For signed types the
+ * result is not representable when both inputs are the most negative value
+ * (or one is and the other is zero).
+ * @tparam T: An integer type.
+ * @param a: First number.
+ * @param b: Second number.
+ * @return: The GCD of |a| and |b|.
+ */
+template<typename T>
+T gcd(T a, T b) {
+    static_assert(detail::IsInteger<T>::value, "gcd requires an integer type");
+    return static_cast<T>(detail::binaryGcd(detail::magnitude(a), detail::magnitude(b)));
+}
+
+inline int gcd(int a, int b) {
+    return gcd<int>(a, b);
+}
+
+/**
+ * Computes the least common multiple of two integers without overflow.
+ * lcm(x, 0) is 0.
+ * @tparam T: An integer type.
+ * @param a: First number.
+ * @param b: Second number.
+ * @param error: Optional; set to MATH_ERROR_OVERFLOW if the result does not fit in T.
+ * @return: The LCM of |a| and |b|, or 0 on overflow.
+ */
+template<typename T>
+T lcm(T a, T b, MathError* error = nullptr) {
+    static_assert(detail::IsInteger<T>::value, "lcm requires an integer type");
+    bool overflow = false;
+    const auto result = detail::checkedLcm<T>(detail::magnitude(a), detail::magnitude(b), overflow);
+    if (error) *error = overflow ? MATH_ERROR_OVERFLOW : MATH_ERROR_NONE;
+    return static_cast<T>(result);
+}
+
+/**
+ * Computes the GCD of every element of an array.
+ * Large arrays are reduced in parallel chunks; each chunk stops early once
+ * its running GCD reaches 1.
+ * @tparam T: An integer type.
+ * @param values: The array.
+ * @param count: Number of elements.
+ * @return: The GCD of all elements, 0 for an empty array.
+ */
+template<typename T>
+T gcdArray(const T* values, size_t count) {
+    static_assert(detail::IsInteger<T>::value, "gcdArray requires an integer type");
+    typedef typename detail::MakeUnsigned<T>::type U;
+    std::vector<U> partial(Parallel::chunkCount(count, PARALLEL_MIN_CHUNK), U(0));
+    Parallel::forChunks(count, PARALLEL_MIN_CHUNK, [&](size_t chunk, size_t begin, size_t end) {
+        U g = 0;
+        for (size_t i = begin; i < end && g != 1; ++i) {
+            g = detail::binaryGcd(g, detail::magnitude(values[i]));
+        }
+        partial[chunk] = g;
+    });
+    U g = 0;
+    for (const U& p : partial) {
+        g = detail::binaryGcd(g, p);
+    }
+    return static_cast<T>(g);
+}
+
+template<typename T>
+T gcdArray(const std::vector<T>& values) {
+    return gcdArray(values.data(), values.size());
+}
+
+/**
+ * Computes the LCM of every element of an array.
+ * Large arrays are reduced in parallel chunks.
+ * @tparam T: An integer type.
+ * @param values: The array.
+ * @param count: Number of elements.
+ * @param error: Optional; set to MATH_ERROR_OVERFLOW if the result does not fit in T.
+ * @return: The LCM of all elements, 1 for an empty array, 0 if any element
+ *          is 0 or on overflow.
+ */
+template<typename T>
+T lcmArray(const T* values, size_t count, MathError* error = nullptr) {
+    static_assert(detail::IsInteger<T>::value, "lcmArray requires an integer type");
+    typedef typename detail::MakeUnsigned<T>::type U;
+    const size_t chunks = Parallel::chunkCount(count, PARALLEL_MIN_CHUNK);
+    std::vector<U> partial(chunks, U(1));
+    std::vector<char> overflowed(chunks, 0);
+    Parallel::forChunks(count, PARALLEL_MIN_CHUNK, [&](size_t chunk, size_t begin, size_t end) {
+        U l = 1;
+        bool overflow = false;
+        for (size_t i = begin; i < end && l != 0; ++i) {
+            l = detail::checkedLcm<T>(l, detail::magnitude(values[i]), overflow);
+        }
+        partial[chunk] = l;
+        overflowed[chunk] = overflow;
+    });
+    U l = 1;
+    bool overflow = false;
+    for (size_t c = 0; c < chunks; ++c) {
+        overflow = overflow || overflowed[c];
+        l = overflow ? U(0) : detail::checkedLcm<T>(l, partial[c], overflow);
+    }
+    if (error) *error = overflow ? MATH_ERROR_OVERFLOW : MATH_ERROR_NONE;
+    return static_cast<T>(l);
+}
+
+template<typename T>
+T lcmArray(const std::vector<T>& values, MathError* error = nullptr) {
+    return lcmArray(values.data(), values.size(), error);
+}
+
+}  // namespace MathUtils
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: Random Numbers
+ * Per-thread pseudo-random generators. Each thread owns its own state, so
+ * there is no shared lock as with rand(), and results are reproducible
+ * per thread once seeded. Range reduction uses Lemire's multiply-shift,
+ * which is unbiased and avoids the modulo of rand() % range.
+ ***************************************/
+
+namespace UniqueBuild {
+
+/**
+ * @namespace Random
+ * xoshiro256++ and PCG32 engines, SplitMix64 seeding, unbiased ranges,
+ * shuffles and bulk fills. The engines satisfy UniformRandomBitGenerator
+ * and can be passed to std::shuffle or <random> distributions.
+ */
+namespace Random {
+
+/**
+ * @class SplitMix64
+ * Tiny generator used to expand one 64-bit seed into engine state.
+ */
+class SplitMix64 {
+public:
+    typedef uint64_t result_type;
+
+    explicit SplitMix64(uint64_t seed = 0) : state_(seed) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~uint64_t(0); }
+
+    result_type operator()() {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+private:
+    uint64_t state_;
+};
+
+inline uint64_t rotl64(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * @class Xoshiro256pp
+ * xoshiro256++ 1.0: 256 bits of state, 64-bit output, period 2^256 - 1.
+ * The default engine of this namespace.
+ */
+class Xoshiro256pp {
+public:
+    typedef uint64_t result_type;
+
+    explicit Xoshiro256pp(uint64_t seed = 0) { this->seed(seed); }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~uint64_t(0); }
+
+    /**
+     * Resets the state from a 64-bit seed via SplitMix64.
+     * @param value: The seed.
+     */
+    void seed(uint64_t value) {
+        SplitMix64 mix(value);
+        for (uint64_t& word : s_) {
+            word = mix();
+        }
+    }
+
+    result_type operator()() {
+        const uint64_t result = rotl64(s_[0] + s_[3], 23) + s_[0];
+        const uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl64(s_[3], 45);
+        return result;
+    }
+
+private:
+    uint64_t s_[4];
+};
+
+/**
+ * @class Pcg32
+ * PCG-XSH-RR with 64-bit state and 32-bit output. Smaller state than
+ * xoshiro256++; the stream selector gives independent sequences per seed.
+ */
+class Pcg32 {
+public:
+    typedef uint32_t result_type;
+
+    explicit Pcg32(uint64_t seed = 0, uint64_t stream = 0xDA3E39CB94B95BDBull) {
+        this->seed(seed, stream);
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~uint32_t(0); }
+
+    /**
+     * Resets the state.
+     * @param value: The seed.
+     * @param stream: Stream selector; any value, only its low 63 bits are used.
+     */
+    void seed(uint64_t value, uint64_t stream = 0xDA3E39CB94B95BDBull) {
+        state_ = 0;
+        inc_ = (stream << 1) | 1u;
+        (*this)();
+        state_ += value;
+        (*this)();
+    }
+
+    result_type operator()() {
+        const uint64_t old = state_;
+        state_ = old * 6364136223846793005ull + inc_;
+        const uint32_t xorshifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+        const uint32_t rot = static_cast<uint32_t>(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((0u - rot) & 31));
+    }
+
+private:
+    uint64_t state_;
+    uint64_t inc_;
+};
+
+/**
+ * @class Xoshiro256ppX4
+ * Four independent xoshiro256++ lanes stored as structure-of-arrays.
+ * The lane loops have no cross-lane dependencies, so the compiler turns
+ * them into 256-bit vector code where AVX2/NEON is enabled. Used for the
+ * bulk fill functions.
+ */
+class Xoshiro256ppX4 {
+public:
+    explicit Xoshiro256ppX4(uint64_t seed = 0) { this->seed(seed); }
+
+    void seed(uint64_t value) {
+        SplitMix64 mix(value);
+        for (int word = 0; word < 4; ++word) {
+            for (int lane = 0; lane < 4; ++lane) {
+                s_[word][lane] = mix();
+            }
+        }
+    }
+
+    /**
+     * Writes count raw 64-bit values to out.
+     */
+    void fill(uint64_t* out, size_t count) {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            next4(out + i);
+        }
+        if (i < count) {
+            uint64_t tail[4];
+            next4(tail);
+            for (size_t j = 0; i < count; ++i, ++j) {
+                out[i] = tail[j];
+            }
+        }
+    }
+
+private:
+    void next4(uint64_t* out) {
+        uint64_t t[4];
+        for (int lane = 0; lane < 4; ++lane) {
+            const uint64_t sum = s_[0][lane] + s_[3][lane];
+            out[lane] = ((sum << 23) | (sum >> 41)) + s_[0][lane];
+            t[lane] = s_[1][lane] << 17;
+        }
+        for (int lane = 0; lane < 4; ++lane) {
+            s_[2][lane] ^= s_[0][lane];
+            s_[3][lane] ^= s_[1][lane];
+            s_[1][lane] ^= s_[2][lane];
+            s_[0][lane] ^= s_[3][lane];
+            s_[2][lane] ^= t[lane];
+            s_[3][lane] = (s_[3][lane] << 45) | (s_[3][lane] >> 19);
+        }
+    }
+
+    uint64_t s_[4][4];
+};
+
+namespace detail {
+
+template<typename Engine>
+inline uint32_t next32(Engine& engine) {
+    return sizeof(typename Engine::result_type) > sizeof(uint32_t)
+        ? static_cast<uint32_t>(static_cast<uint64_t>(engine()) >> 32)
+        : static_cast<uint32_t>(engine());
+}
+
+template<typename Engine>
+inline uint64_t next64(Engine& engine) {
+    if (sizeof(typename Engine::result_type) > sizeof(uint32_t)) {
+        return static_cast<uint64_t>(engine());
+    }
+    const uint64_t high = static_cast<uint32_t>(engine());
+    return (high << 32) | static_cast<uint32_t>(engine());
+}
+
+inline std::atomic<uint64_t>& baseSeed() {
+    static std::atomic<uint64_t> seed(static_cast<uint64_t>(
+        std::chrono::high_resolution_clock::now().time_since_epoch().count()));
+    return seed;
+}
+
+inline std::atomic<uint64_t>& threadCounter() {
+    static std::atomic<uint64_t> counter(0);
+    return counter;
+}
+
+/**
+ * Generators owned by one thread: a scalar engine and a 4-lane bulk engine.
+ */
+struct ThreadState {
+    Xoshiro256pp scalar;
+    Xoshiro256ppX4 bulk;
+
+    ThreadState() {
+        const uint64_t index = threadCounter().fetch_add(1, std::memory_order_relaxed);
+        reseed(baseSeed().load(std::memory_order_relaxed) + index * 0x9E3779B97F4A7C15ull);
+    }
+
+    void reseed(uint64_t value) {
+        scalar.seed(value);
+        bulk.seed(SplitMix64(value ^ 0x6A09E667F3BCC909ull)());
+    }
+};
+
+inline ThreadState& threadState() {
+    thread_local ThreadState state;
+    return state;
+}
+
+}  // namespace detail
+
+/**
+ * Seeds the calling thread's generators, making its sequence reproducible.
+ * Threads that have not drawn a number yet derive their seed from this
+ * value and the order in which they first use the generator.
+ * @param value: The seed.
+ */
+inline void seed(uint64_t value) {
+    detail::baseSeed().store(value, std::memory_order_relaxed);
+    detail::threadCounter().store(1, std::memory_order_relaxed);
+    detail::threadState().reseed(value);
+}
+
+/**
+ * Returns the calling thread's scalar engine, for use with std::shuffle
+ * or <random> distributions.
+ */
+inline Xoshiro256pp& threadEngine() {
+    return detail::threadState().scalar;
+}
+
+/**
+ * Returns an unbiased value in [0, range) using Lemire's multiply-shift.
+ * @param engine: The engine to draw from.
+ * @param range: Exclusive upper bound; must be non-zero.
+ */
+template<typename Engine>
+uint32_t bounded32(Engine& engine, uint32_t range) {
+    uint64_t m = uint64_t(detail::next32(engine)) * range;
+    uint32_t low = static_cast<uint32_t>(m);
+    if (low < range) {
+        const uint32_t threshold = (0u - range) % range;
+        while (low < threshold) {
+            m = uint64_t(detail::next32(engine)) * range;
+            low = static_cast<uint32_t>(m);
+        }
+    }
+    return static_cast<uint32_t>(m >> 32);
+}
+
+/**
+ * 64-bit version of bounded32.
+ * @param engine: The engine to draw from.
+ * @param range: Exclusive upper bound; must be non-zero.
+ */
+template<typename Engine>
+uint64_t bounded64(Engine& engine, uint64_t range) {
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 m = static_cast<unsigned __int128>(detail::next64(engine)) * range;
+    uint64_t low = static_cast<uint64_t>(m);
+    if (low < range) {
+        const uint64_t threshold = (0ull - range) % range;
+        while (low < threshold) {
+            m = static_cast<unsigned __int128>(detail::next64(engine)) * range;
+            low = static_cast<uint64_t>(m);
+        }
+    }
+    return static_cast<uint64_t>(m >> 64);
+#else
+    const uint64_t threshold = (0ull - range) % range;
+    uint64_t x = detail::next64(engine);
+    while (x < threshold) {
+        x = detail::next64(engine);
+    }
+    return x % range;
+#endif
+}
+
+/**
+ * Returns a uniformly distributed integer in [min, max].
+ * @param engine: The engine to draw from.
+ * @param min: The minimum value.
+ * @param max: The maximum value; must not be less than min.
+ */
+template<typename Engine>
+int uniformInt(Engine& engine, int min, int max) {
+    const uint32_t range = static_cast<uint32_t>(max) - static_cast<uint32_t>(min) + 1u;
+    const uint32_t offset = range == 0 ? detail::next32(engine) : bounded32(engine, range);
+    return static_cast<int>(static_cast<uint32_t>(min) + offset);
+}
+
+/**
+ * uniformInt on the calling thread's engine.
+ */
+inline int uniformInt(int min, int max) {
+    return uniformInt(threadEngine(), min, max);
+}
+
+/**
+ * Returns a uniformly distributed double in [0, 1) with 53 random bits.
+ */
+template<typename Engine>
+double uniformDouble(Engine& engine) {
+    return static_cast<double>(detail::next64(engine) >> 11) * 0x1.0p-53;
+}
+
+inline double uniformDouble() {
+    return uniformDouble(threadEngine());
+}
+
+/**
+ * Shuffles an array in place (Fisher-Yates). With a seeded engine the
+ * permutation is the same on every platform, unlike std::shuffle whose
+ * algorithm is implementation-defined.
+ * @param data: The array.
+ * @param count: Number of elements.
+ * @param engine: The engine to draw from.
+ */
+template<typename T, typename Engine>
+void shuffle(T* data, size_t count, Engine& engine) {
+    for (size_t i = count; i > 1; --i) {
+        const size_t j = static_cast<size_t>(bounded64(engine, i));
+        std::swap(data[i - 1], data[j]);
+    }
+}
+
+template<typename T>
+void shuffle(std::vector<T>& values) {
+    shuffle(values.data(), values.size(), threadEngine());
+}
+
+template<typename T>
+void shuffle(std::vector<T>& values, uint64_t seed) {
+    Xoshiro256pp engine(seed);
+    shuffle(values.data(), values.size(), engine);
+}
+
+/**
+ * RANDOM_FILL_BLOCK: Number of raw 64-bit values generated per batch by
+ * the bulk fill functions.
+ */
+#define RANDOM_FILL_BLOCK 256
+
+/**
+ * Fills an array with raw 64-bit random values from the calling thread's
+ * bulk engine.
+ * @param out: Destination array.
+ * @param count: Number of values.
+ */
+inline void fillUint64(uint64_t* out, size_t count) {
+    detail::threadState().bulk.fill(out, count);
+}
+
+/**
+ * Fills an array with unbiased integers in [min, max].
+ * @param out: Destination array.
+ * @param count: Number of values.
+ * @param min: The minimum value.
+ * @param max: The maximum value; must not be less than min.
+ */
+inline void fillInts(int* out, size_t count, int min, int max) {
+    detail::ThreadState& state = detail::threadState();
+    const uint32_t range = static_cast<uint32_t>(max) - static_cast<uint32_t>(min) + 1u;
+    const uint32_t threshold = range == 0 ? 0 : (0u - range) % range;
+    uint64_t raw[RANDOM_FILL_BLOCK];
+    for (size_t done = 0; done < count; done += RANDOM_FILL_BLOCK) {
+        const size_t n = MIN(size_t(RANDOM_FILL_BLOCK), count - done);
+        state.bulk.fill(raw, n);
+        for (size_t i = 0; i < n; ++i) {
+            const uint64_t m = (raw[i] >> 32) * range;
+            uint32_t offset = range == 0 ? static_cast<uint32_t>(raw[i] >> 32) : static_cast<uint32_t>(m >> 32);
+            if (static_cast<uint32_t>(m) < threshold) {
+                offset = bounded32(state.scalar, range);
+            }
+            out[done + i] = static_cast<int>(static_cast<uint32_t>(min) + offset);
+        }
+    }
+}
+
+/**
+ * Fills an array with floats in [0, 1) carrying 24 random bits each.
+ * @param out: Destination array.
+ * @param count: Number of values.
+ */
+inline void fillFloats(float* out, size_t count) {
+    uint64_t raw[RANDOM_FILL_BLOCK];
+    for (size_t done = 0; done < count; done += RANDOM_FILL_BLOCK) {
+        const size_t n = MIN(size_t(RANDOM_FILL_BLOCK), count - done);
+        detail::threadState().bulk.fill(raw, n);
+        for (size_t i = 0; i < n; ++i) {
+            out[done + i] = static_cast<float>(raw[i] >> 40) * 0x1.0p-24f;
+        }
+    }
+}
+
+/**
+ * Fills an array with doubles in [0, 1) carrying 53 random bits each.
+ * @param out: Destination array.
+ * @param count: Number of values.
+ */
+inline void fillDoubles(double* out, size_t count) {
+    uint64_t raw[RANDOM_FILL_BLOCK];
+    for (size_t done = 0; done < count; done += RANDOM_FILL_BLOCK) {
+        const size_t n = MIN(size_t(RANDOM_FILL_BLOCK), count - done);
+        detail::threadState().bulk.fill(raw, n);
+        for (size_t i = 0; i < n; ++i) {
+            out[done + i] = static_cast<double>(raw[i] >> 11) * 0x1.0p-53;
+        }
+    }
+}
+
+}  // namespace Random
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: Search
+ * Vectorized linear search for one-off lookups, and reusable indexes for
+ * repeated membership queries over the same data. Scanning a vector once
+ * per query makes m queries over n elements cost O(n*m); building an
+ * index once brings each query down to O(1) (IntIndex) or a branchless
+ * O(log n) walk (SortedIntIndex).
+ ***************************************/
+
+namespace UniqueBuild {
+
+/**
+ * @namespace Search
+ * SIMD find kernels and index structures over 32-bit integers.
+ */
+namespace Search {
+
+namespace detail {
+
+inline size_t findScalar(const int32_t* data, size_t begin, size_t count, int32_t value) {
+    for (size_t i = begin; i < count; ++i) {
+        if (data[i] == value) return i;
+    }
+    return count;
+}
+
+#ifdef UNIQUEBUILD_X86_DISPATCH
+UNIQUEBUILD_TARGET("avx2")
+inline size_t findAvx2(const int32_t* data, size_t count, int32_t value) {
+    const __m256i key = _mm256_set1_epi32(value);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i a = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), key);
+        const __m256i b = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 8)), key);
+        const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(a))) |
+                              (static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(b))) << 8);
+        if (mask) return i + static_cast<size_t>(__builtin_ctz(mask));
+    }
+    return findScalar(data, i, count, value);
+}
+
+inline size_t findSse2(const int32_t* data, size_t count, int32_t value) {
+    const __m128i key = _mm_set1_epi32(value);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint32_t mask = 0;
+        for (int v = 0; v < 4; ++v) {
+            const __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 4 * v)), key);
+            mask |= static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(eq))) << (4 * v);
+        }
+        if (mask) return i + static_cast<size_t>(__builtin_ctz(mask));
+    }
+    return findScalar(data, i, count, value);
+}
+#endif
+
+#ifdef UNIQUEBUILD_NEON
+inline size_t findNeon(const int32_t* data, size_t count, int32_t value) {
+    const int32x4_t key = vdupq_n_s32(value);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const uint32x4_t any = vorrq_u32(
+            vorrq_u32(vceqq_s32(vld1q_s32(data + i), key), vceqq_s32(vld1q_s32(data + i + 4), key)),
+            vorrq_u32(vceqq_s32(vld1q_s32(data + i + 8), key), vceqq_s32(vld1q_s32(data + i + 12), key)));
+        if (vmaxvq_u32(any)) return findScalar(data, i, i + 16, value);
+    }
+    return findScalar(data, i, count, value);
+}
+#endif
+
+}  // namespace detail
+
+/**
+ * Finds the first occurrence of value, comparing 16 ints per loop
+ * iteration with AVX2, SSE2 or NEON depending on the CPU.
+ * @param data: The array to search.
+ * @param count: Number of elements.
+ * @param value: The value to find.
+ * @return: Index of the first match, or count if there is none.
+ */
+inline size_t findInt32(const int32_t* data, size_t count, int32_t value) {
+#if defined(UNIQUEBUILD_X86_DISPATCH)
+    return Cpu::hasAvx2() ? detail::findAvx2(data, count, value) : detail::findSse2(data, count, value);
+#elif defined(UNIQUEBUILD_NEON)
+    return detail::findNeon(data, count, value);
+#else
+    return detail::findScalar(data, 0, count, value);
+#endif
+}
+
+namespace detail {
+
+inline uint32_t hashInt32(int32_t value, int bits) {
+    return (static_cast<uint32_t>(value) * 0x9E3779B1u) >> (32 - bits);
+}
+
+}  // namespace detail
+
+/**
+ * @class IntIndex
+ * Open-addressing hash table from value to the index of its first
+ * occurrence in the source array. Linear probing at a load factor of at
+ * most one half keeps lookups to one or two cache lines.
+ * The index is a snapshot; rebuild it after the source changes.
+ */
+class IntIndex {
+public:
+    IntIndex() { build(nullptr, 0); }
+
+    explicit IntIndex(const std::vector<int>& values) { build(values.data(), values.size()); }
+
+    IntIndex(const int32_t* values, size_t count) { build(values, count); }
+
+    /**
+     * Rebuilds the index from an array.
+     * @param values: The source array.
+     * @param count: Number of elements; at most 2^31 - 1.
+     */
+    void build(const int32_t* values, size_t count) {
+        bits_ = 1;
+        while ((size_t(1) << bits_) < count * 2) ++bits_;
+        keys_.assign(size_t(1) << bits_, 0);
+        positions_.assign(size_t(1) << bits_, -1);
+        const uint32_t mask = (uint32_t(1) << bits_) - 1;
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t slot = detail::hashInt32(values[i], bits_);
+            while (positions_[slot] >= 0 && keys_[slot] != values[i]) {
+                slot = (slot + 1) & mask;
+            }
+            if (positions_[slot] < 0) {
+                keys_[slot] = values[i];
+                positions_[slot] = static_cast<int32_t>(i);
+            }
+        }
+    }
+
+    /**
+     * @param value: The value to find.
+     * @return: Index of its first occurrence in the source array, or -1.
+     */
+    int find(int32_t value) const {
+        const uint32_t mask = (uint32_t(1) << bits_) - 1;
+        uint32_t slot = detail::hashInt32(value, bits_);
+        while (positions_[slot] >= 0) {
+            if (keys_[slot] == value) return positions_[slot];
+            slot = (slot + 1) & mask;
+        }
+        return -1;
+    }
+
+    bool contains(int32_t value) const { return find(value) >= 0; }
+
+    /**
+     * Looks up many values at once. Home slots are prefetched a few
+     * queries ahead so several cache misses are in flight together.
+     * @param queries: Values to look up.
+     * @param count: Number of queries.
+     * @param out: Receives find() for each query.
+     */
+    void findBatch(const int32_t* queries, size_t count, int* out) const {
+        const size_t distance = 8;
+        for (size_t i = 0; i < count; ++i) {
+            if (i + distance < count) {
+                const uint32_t ahead = detail::hashInt32(queries[i + distance], bits_);
+                prefetch(&positions_[ahead]);
+                prefetch(&keys_[ahead]);
+            }
+            out[i] = find(queries[i]);
+        }
+    }
+
+    /**
+     * Membership test for many values at once.
+     * @param queries: Values to look up.
+     * @param count: Number of queries.
+     * @param out: Receives 1 for each query that is present, 0 otherwise.
+     */
+    void containsBatch(const int32_t* queries, size_t count, uint8_t* out) const {
+        const size_t block = 256;
+        int found[block];
+        for (size_t done = 0; done < count; done += block) {
+            const size_t n = MIN(block, count - done);
+            findBatch(queries + done, n, found);
+            for (size_t i = 0; i < n; ++i) {
+                out[done + i] = found[i] >= 0;
+            }
+        }
+    }
+
+private:
+    static void prefetch(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(address);
+#else
+        (void)address;
+#endif
+    }
+
+    int bits_;  // log2 of the table size
+    std::vector<int32_t> keys_;  // Stored values, valid where positions_ >= 0
+    std::vector<int32_t> positions_;  // First index in the source array, -1 for empty slots
+};
+
+/**
+ * @class SortedIntIndex
+ * The distinct values of an array in Eytzinger (BFS) order: the children
+ * of slot k are 2k and 2k+1. The search is branchless and the next levels
+ * are prefetched together, so it stays fast well beyond cache size, and it
+ * answers ordered queries (lowerBound) that a hash table cannot.
+ */
+class SortedIntIndex {
+public:
+    SortedIntIndex() : tree_(1, 0) {}
+
+    explicit SortedIntIndex(const std::vector<int>& values) { build(values.data(), values.size()); }
+
+    SortedIntIndex(const int32_t* values, size_t count) { build(values, count); }
+
+    /**
+     * Rebuilds the index from an array.
+     * @param values: The source array, in any order.
+     * @param count: Number of elements.
+     */
+    void build(const int32_t* values, size_t count) {
+        std::vector<int32_t> sorted(values, values + count);
+        std::sort(sorted.begin(), sorted.end());
+        sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+        tree_.assign(sorted.size() + 1, 0);
+        size_t next = 0;
+        fill(sorted, next, 1);
+    }
+
+    /**
+     * @return: Number of distinct values.
+     */
+    size_t size() const { return tree_.size() - 1; }
+
+    /**
+     * Finds the smallest stored value that is not less than value.
+     * @param value: The probe.
+     * @param result: Receives the value found.
+     * @return: False if every stored value is less than value.
+     */
+    bool lowerBound(int32_t value, int32_t& result) const {
+        const size_t slot = lowerBoundSlot(value);
+        if (slot == 0) return false;
+        result = tree_[slot];
+        return true;
+    }
+
+    bool contains(int32_t value) const {
+        const size_t slot = lowerBoundSlot(value);
+        return slot != 0 && tree_[slot] == value;
+    }
+
+    /**
+     * Membership test for many values at once.
+     * @param queries: Values to look up.
+     * @param count: Number of queries.
+     * @param out: Receives 1 for each query that is present, 0 otherwise.
+     */
+    void containsBatch(const int32_t* queries, size_t count, uint8_t* out) const {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = contains(queries[i]);
+        }
+    }
+
+private:
+    void fill(const std::vector<int32_t>& sorted, size_t& next, size_t slot) {
+        if (slot < tree_.size()) {
+            fill(sorted, next, 2 * slot);
+            tree_[slot] = sorted[next++];
+            fill(sorted, next, 2 * slot + 1);
+        }
+    }
+
+    size_t lowerBoundSlot(int32_t value) const {
+        const size_t n = tree_.size();
+        size_t k = 1;
+        while (k < n) {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(tree_.data() + MIN(k * 16, n - 1));
+#endif
+            k = 2 * k + (tree_[k] < value);
+        }
+        // Undo the trailing right turns plus one left turn to land on the answer.
+#if defined(__GNUC__) || defined(__clang__)
+        k >>= __builtin_ffsll(static_cast<long long>(~k));
+#else
+        while (k & 1) k >>= 1;
+        k >>= 1;
+#endif
+        return k;
+    }
+
+    std::vector<int32_t> tree_;  // Slot 0 unused; slots 1..n hold the values in BFS order
+};
+
+}  // namespace Search
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: Function Declarations
+ * This section contains declarations for various functions
+ * used throughout the project.
+ ***************************************/
+
+/**
+ * Computes the sum of two integers.
+ * @param a: The first integer.
+ * @param b: The second integer.
+ * @return: The sum of the two integers.
+ */
+int add(int a, int b);
+
+/**
+ * Computes the sum of two floating-point numbers.
+ * @param a: The first float.
+ * @param b: The second float.
+ * @return: The sum of the two floats.
+ */
+float add(float a, float b);
+
+/**
+ * Finds the minimum of two integers.
+ * @param a: The first integer.
+ * @param b: The second integer.
+ * @return: The smaller of the two integers.
+ */
+int min(int a, int b);
+
+/**
+ * Finds the minimum of two floating-point numbers.
+ * @param a: The first float.
+ * @param b: The second float.
+ * @return: The smaller of the two floats.
+ */
+float min(float a, float b);
+
+/***************************************
+ * SECTION: Overloaded Functions
+ * These functions have the same name but different parameter types
+ * or numbers of parameters, demonstrating function overloading.
+ ***************************************/
+
+/**
+ * Overloaded function to compute the absolute value of an integer.
+ * @param value: The integer value.
+ * @return: The absolute value of the integer.
+ */
+int absolute(int value);
+
+/**
+ * Overloaded function to compute the absolute value of a float.
+ * @param value: The floating-point value.
+ * @return: The absolute value of the float.
+ */
+float absolute(float value);
+
+/**
+ * Overloaded function to compute the absolute value of a double.
+ * @param value: The double value.
+ * @return: The absolute value of the double.
+ */
+double absolute(double value);
+
+/***************************************
+ * SECTION: Function Templates
+ * Templates allow functions to work with any data type.
+ ***************************************/
+
+/**
+ * A generic template function to swap two values.
+ * @tparam T: The type of the values to swap.
+ * @param a: The first value.
+ * @param b: The second value.
+ */
+template<typename T>
+void swap(T& a, T& b) {
+    T temp = a;
+    a = b;
+    b = temp;
+}
+
+/**
+ * A generic template function to find the maximum of two values.
+ * @tparam T: The type of the values.
+ * @param a: The first value.
+ * @param b: The second value.
+ * @return: The larger of the two values.
+ */
+template<typename T>
+T max(const T& a, const T& b) {
+    return (a > b) ? a : b;
+}
+
+/**
+ * A generic template function to find the minimum of two values.
+ * @tparam T: The type of the values.
+ * @param a: The first value.
+ * @param b: The second value.
+ * @return: The smaller of the two values.
+ */
+template<typename T>
+T min(const T& a, const T& b) {
+    return (a < b) ? a : b;
+}
+
+/**
+ * A generic template function to sort an array.
+ * @tparam T: The type of the array elements.
+ * @param arr: The array to sort.
+ * @param size: The size of the array.
+ */
+template<typename T>
+void sortArray(T arr[], int size) {
+    for (int i = 0; i < size - 1; i++) {
+        for (int j = 0; j < size - i - 1; j++) {
+            if (arr[j] > arr[j + 1]) {
+                swap(arr[j], arr[j + 1]);
+            }
+        }
+    }
+}
+
+/**
+ * A generic template function to reverse an array.
+ * @tparam T: The type of the array elements.
+ * @param arr: The array to reverse.
+ * @param size: The size of the array.
+ */
+template<typename T>
+void reverseArray(T arr[], int size) {
+    for (int i = 0; i < size / 2; i++) {
+        swap(arr[i], arr[size - i - 1]);
+    }
+}
+
+/**
+ * A generic template function to find the sum of array elements.
+ * @tparam T: The type of the array elements.
+ * @param arr: The array whose elements will be summed.
+ * @param size: The size of the array.
+ * @return: The sum of the array elements.
+ */
+template<typename T>
+T arraySum(const T arr[], int size) {
+    T sum = 0;
+    for (int i = 0; i < size; i++) {
+        sum += arr[i];
+    }
+    return sum;
+}
+
+/***************************************
+ * SECTION: Specialized Template Functions
+ * Specialized templates provide custom implementations for specific types.
+ ***************************************/
+
+/**
+ * A specialized template function to find the sum of a char array.
+ * Treats each char as its ASCII value.
+ * @param arr: The char array.
+ * @param size: The size of the array.
+ * @return: The sum of the ASCII values of the chars in the array.
+ */
+template<>
+inline char arraySum<char>(const char arr[], int size) {
+    char sum = 0;
+    for (int i = 0; i < size; i++) {
+        sum += static_cast<int>(arr[i]);
+    }
+    return sum;
+}
+
+/***************************************
+ * SECTION: Helper Functions
+ * These functions assist in performing smaller, modular tasks
+ * that are often reused across the application.
+ ***************************************/
+
+/**
+ * Helper function to check if a number is even.
+ * @param number: The number to check.
+ * @return: True if the number is even, false otherwise.
+ */
+bool isEven(int number);
+
+/**
+ * Helper function to check if a number is odd.
+ * @param number: The number to check.
+ * @return: True if the number is odd, false otherwise.
+ */
+bool isOdd(int number);
+
+/**
+ * Helper function to find the factorial of a number.
+ * @param n: The input number.
+ * @return: The factorial of the number.
+ */
+int factorial(int n);
+
+/**
+ * Helper function to calculate the power of a number.
+ * @param base: The base number.
+ * @param exponent: The exponent.
+ * @return: The result of base raised to the power of exponent.
+ */
+double power(double base, int exponent);
+
+/**
+ * Helper function to generate a random number between min and max.
+ * Draws from the calling thread's generator (see SECTION: Random Numbers),
+ * so it is unbiased, lock-free and reproducible after UniqueBuild::Random::seed.
+ * @param min: The minimum value.
+ * @param max: The maximum value.
+ * @return: A random number between min and max.
+ */
+int randomInRange(int min, int max);
+
+/***************************************
+ * SECTION: Inline Functions
+ * These functions are marked as inline to suggest that the compiler
+ * should attempt to expand them inline rather than calling them.
+ ***************************************/
+
+/**
+ * Inline function to find the maximum of two integers.
+ * @param a: The first integer.
+ * @param b: The second integer.
+ * @return: The larger of the two integers.
+ */
+inline int max(int a, int b) {
+    return (a > b) ? a : b;
+}
+
+/**
+ * Inline function to find the minimum of two integers.
+ * @param a: The first integer.
+ * @param b: The second integer.
+ * @return: The smaller of the two integers.
+ */
+inline int min(int a, int b) {
+    return (a < b) ? a : b;
+}
+
+/**
+ * Inline function to compute the square of a number.
+ * @param x: The input number.
+ * @return: The square of the number.
+ */
+inline int square(int x) {
+    return x * x;
+}
+
+/**
+ * Inline function to check if a number is positive.
+ * @param x: The number to check.
+ * @return: True if the number is positive, false otherwise.
+ */
+inline bool isPositive(int x) {
+    return x > 0;
+}
+
+/**
+ * Inline function to compute the absolute value of a number.
+ * @param x: The input number.
+ * @return: The absolute value of the number.
+ */
+inline int absolute(int x) {
+    return (x < 0) ? -x : x;
+}
+
+/***************************************
+ * SECTION: Utility Functions
+ * These functions are general-purpose utilities that are commonly
+ * used across various parts of the program.
+ ***************************************/
+
+/**
+ * Utility function to find the index of an element in a vector.
+ * Uses the vectorized scan from SECTION: Search. For repeated lookups in
+ * the same vector, build a UniqueBuild::Search::IntIndex once instead.
+ * @param vec: The input vector.
+ * @param element: The element to find.
+ * @return: The index of the element if found, -1 otherwise.
+ */
+int findIndex(const std::vector<int>& vec, int element);
+
+/**
+ * Utility function to check if a vector contains a value.
+ * Uses the vectorized scan from SECTION: Search. For repeated checks
+ * against the same vector, build a UniqueBuild::Search::IntIndex once instead.
+ * @param vec: The input vector.
+ * @param value: The value to check.
+ * @return: True if the value is found, false otherwise.
+ */
+bool contains(const std::vector<int>& vec, int value);
+
+/**
+ * Utility function to sort a vector of integers.
+ * @param vec: The input vector.
+ */
+void sortVector(std::vector<int>& vec);
+
+/**
+ * Utility function to calculate the average of a vector of integers.
+ * @param vec: The input vector.
+ * @return: The average value of the elements.
+ */
+double calculateAverage(const std::vector<int>& vec);
+
+/**
+ * Utility function to find the median of a vector of integers.
+ * @param vec: The input vector.
+ * @return: The median value.
+ */
+double calculateMedian(std::vector<int>& vec);
+
+#endif  // UNIQUEBUILD_MATH_H
+
+
+/***************************************
+ * Out-of-line definitions, compiled in the one translation unit that
+ * defines UNIQUEBUILD_IMPLEMENTATION before including this header.
+ ***************************************/
+
+#if defined(UNIQUEBUILD_IMPLEMENTATION) && !defined(UNIQUEBUILD_MATH_IMPLEMENTED)
+#define UNIQUEBUILD_MATH_IMPLEMENTED
+
+#include <numeric>      // Required for std::accumulate
+
+bool isEven(int number) {
+    return number % 2 == 0;
+}
+
+bool isOdd(int number) {
+    return number % 2 != 0;
+}
+
+int factorial(int n) {
+    if (n <= 1) return 1;
+    return n * factorial(n - 1);
+}
+
+double power(double base, int exponent) {
+    double result = 1.0;
+    for (int i = 0; i < exponent; ++i) {
+        result *= base;
+    }
+    return result;
+}
+
+int randomInRange(int min, int max) {
+    return UniqueBuild::Random::uniformInt(min, max);
+}
+
+int findIndex(const std::vector<int>& vec, int element) {
+    const size_t index = UniqueBuild::Search::findInt32(vec.data(), vec.size(), element);
+    return (index != vec.size()) ? static_cast<int>(index) : -1;
+}
+
+bool contains(const std::vector<int>& vec, int value) {
+    return UniqueBuild::Search::findInt32(vec.data(), vec.size(), value) != vec.size();
+}
+
+void sortVector(std::vector<int>& vec) {
+    std::sort(vec.begin(), vec.end());
+}
+
+double calculateAverage(const std::vector<int>& vec) {
+    int sum = std::accumulate(vec.begin(), vec.end(), 0);
+    return static_cast<double>(sum) / vec.size();
+}
+
+double calculateMedian(std::vector<int>& vec) {
+    sortVector(vec);
+    int size = vec.size();
+    if (size % 2 == 0) {
+        return (vec[size / 2 - 1] + vec[size / 2]) / 2.0;
+    } else {
+        return vec[size / 2];
+    }
+}
+
+#endif  // UNIQUEBUILD_IMPLEMENTATION
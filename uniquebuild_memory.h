@@ -0,0 +1,718 @@
+/***************************************
+ * uniquebuild_memory.h
+ * Aligned allocation: cache-line and SIMD-width aligned blocks, an
+ * optional huge-page path for large blocks, an STL allocator on top,
+ * process-wide usage statistics and a typed slab object pool.
+ *
+ * Part of uniquebuild; see uniquebuild.h.
+ ***************************************/
+
+#ifndef UNIQUEBUILD_MEMORY_H
+#define UNIQUEBUILD_MEMORY_H
+
+#include "uniquebuild_core.h"
+
+#include <algorithm>  // Required for std::sort in ObjectPool::release
+#include <mutex>      // Required for std::mutex in ObjectPool
+#include <new>        // Required for std::bad_alloc
+
+/***************************************
+ * SECTION: Aligned Memory
+ * Every block carries a small header just below the returned pointer
+ * recording where the underlying memory starts and how it was obtained,
+ * so deallocate() needs only the pointer. Small blocks come from the
+ * heap. Large blocks can instead be mapped directly, 2 MB aligned and
+ * advised for transparent huge pages, or taken from the reserved
+ * MAP_HUGETLB pool; either cuts TLB misses on multi-GB working sets.
+ ***************************************/
+
+/**
+ * MEMORY_CACHE_LINE_SIZE: Alignment that keeps a block from sharing or
+ * straddling cache lines.
+ */
+#define MEMORY_CACHE_LINE_SIZE 64
+
+/**
+ * MEMORY_SIMD_ALIGNMENT: Alignment for vector loads of the widest
+ * registers in use (AVX-512); also a cache line.
+ */
+#define MEMORY_SIMD_ALIGNMENT 64
+
+/**
+ * MEMORY_HUGE_PAGE_SIZE: Size of a transparent or explicit huge page.
+ */
+#define MEMORY_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+/**
+ * MEMORY_HUGE_PAGE_THRESHOLD: Smallest block PageMode::LARGE maps with
+ * huge pages; below it the heap wastes less.
+ */
+#define MEMORY_HUGE_PAGE_THRESHOLD (32 * 1024 * 1024)
+
+namespace UniqueBuild {
+
+/**
+ * @namespace Memory
+ * Aligned allocate/deallocate, AlignedAllocator and statistics.
+ */
+namespace Memory {
+
+/**
+ * Where a block's memory comes from.
+ */
+enum class PageMode {
+    HEAP,  // operator new
+    LARGE,  // TRANSPARENT from MEMORY_HUGE_PAGE_THRESHOLD up, HEAP below
+    TRANSPARENT,  // Own 2 MB aligned mapping, madvise(MADV_HUGEPAGE)
+    EXPLICIT  // MAP_HUGETLB pool; TRANSPARENT when the pool is empty
+};
+
+/**
+ * @struct MemoryStats
+ * Snapshot of the allocations made through this namespace.
+ */
+struct MemoryStats {
+    size_t liveBlocks;  // Blocks not yet deallocated
+    size_t bytesRequested;  // Bytes asked for by live blocks
+    size_t bytesReserved;  // Bytes held for live blocks, with headers, padding and page rounding
+    size_t peakBytesReserved;  // Highest bytesReserved so far
+    size_t totalBlocks;  // Blocks allocated so far
+    size_t mappedBlocks;  // Live blocks with their own mapping
+    size_t hugePageBytes;  // Bytes of live mappings advised or backed by huge pages
+    size_t hugePageFallbacks;  // EXPLICIT requests the MAP_HUGETLB pool could not serve
+    size_t failures;  // Allocations that returned null
+
+    /**
+     * @return: Share of reserved bytes the callers cannot use, 0 to 1.
+     */
+    double fragmentation() const {
+        return bytesReserved == 0 ? 0.0 : 1.0 - double(bytesRequested) / double(bytesReserved);
+    }
+};
+
+namespace detail {
+
+const uint32_t HEADER_MAGIC = 0x4d454d42u;  // "MEMB"
+
+enum BlockKind : uint32_t {
+    BLOCK_HEAP,  // From operator new
+    BLOCK_MAPPED,  // Own mapping, advised for transparent huge pages
+    BLOCK_HUGETLB  // Own mapping from the explicit huge page pool
+};
+
+/**
+ * Stored immediately below every returned pointer.
+ */
+struct Header {
+    void* base;  // Start of the underlying memory
+    size_t reserved;  // Size of the underlying memory
+    size_t requested;  // Bytes the caller asked for
+    uint32_t kind;  // BlockKind
+    uint32_t magic;  // HEADER_MAGIC while the block is live
+};
+
+struct Counters {
+    std::atomic<size_t> liveBlocks{0};
+    std::atomic<size_t> bytesRequested{0};
+    std::atomic<size_t> bytesReserved{0};
+    std::atomic<size_t> peakBytesReserved{0};
+    std::atomic<size_t> totalBlocks{0};
+    std::atomic<size_t> mappedBlocks{0};
+    std::atomic<size_t> hugePageBytes{0};
+    std::atomic<size_t> hugePageFallbacks{0};
+    std::atomic<size_t> failures{0};
+};
+
+inline Counters& counters() {
+    static Counters instance;
+    return instance;
+}
+
+inline void recordAllocation(const Header& header) {
+    Counters& c = counters();
+    c.liveBlocks.fetch_add(1, std::memory_order_relaxed);
+    c.totalBlocks.fetch_add(1, std::memory_order_relaxed);
+    c.bytesRequested.fetch_add(header.requested, std::memory_order_relaxed);
+    const size_t reserved = c.bytesReserved.fetch_add(header.reserved, std::memory_order_relaxed) + header.reserved;
+    size_t peak = c.peakBytesReserved.load(std::memory_order_relaxed);
+    while (reserved > peak && !c.peakBytesReserved.compare_exchange_weak(peak, reserved, std::memory_order_relaxed)) {
+    }
+    if (header.kind != BLOCK_HEAP) {
+        c.mappedBlocks.fetch_add(1, std::memory_order_relaxed);
+        c.hugePageBytes.fetch_add(header.reserved, std::memory_order_relaxed);
+    }
+}
+
+inline void recordRelease(const Header& header) {
+    Counters& c = counters();
+    c.liveBlocks.fetch_sub(1, std::memory_order_relaxed);
+    c.bytesRequested.fetch_sub(header.requested, std::memory_order_relaxed);
+    c.bytesReserved.fetch_sub(header.reserved, std::memory_order_relaxed);
+    if (header.kind != BLOCK_HEAP) {
+        c.mappedBlocks.fetch_sub(1, std::memory_order_relaxed);
+        c.hugePageBytes.fetch_sub(header.reserved, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * Writes the header into base and returns the aligned pointer after it.
+ */
+inline void* place(void* base, size_t reserved, size_t bytes, size_t alignment, BlockKind kind) {
+    const uintptr_t user = ALIGN_UP(reinterpret_cast<uintptr_t>(base) + sizeof(Header), uintptr_t(alignment));
+    Header* header = reinterpret_cast<Header*>(user) - 1;
+    *header = Header{base, reserved, bytes, uint32_t(kind), HEADER_MAGIC};
+    recordAllocation(*header);
+    return reinterpret_cast<void*>(user);
+}
+
+#if defined(UNIQUEBUILD_POSIX) && defined(MAP_ANONYMOUS)
+/**
+ * Maps at least size bytes for a block, from the MAP_HUGETLB pool when
+ * explicitPages is set, otherwise as ordinary pages trimmed to a 2 MB aligned
+ * start and advised for transparent huge pages.
+ * @param reserved: Receives the length of the mapping.
+ * @return: The mapping, or null.
+ */
+inline void* mapBlock(size_t size, bool explicitPages, size_t& reserved) {
+#ifdef MAP_HUGETLB
+    if (explicitPages) {
+        reserved = ALIGN_UP(size, size_t(MEMORY_HUGE_PAGE_SIZE));
+        void* mapped = ::mmap(nullptr, reserved, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        return mapped == MAP_FAILED ? nullptr : mapped;
+    }
+#else
+    (void)explicitPages;
+#endif
+    reserved = ALIGN_UP(size, size_t(MEMORY_HUGE_PAGE_SIZE));
+    const size_t padded = reserved + MEMORY_HUGE_PAGE_SIZE;
+    void* mapped = ::mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapped == MAP_FAILED) return nullptr;
+    const uintptr_t start = reinterpret_cast<uintptr_t>(mapped);
+    const uintptr_t aligned = ALIGN_UP(start, uintptr_t(MEMORY_HUGE_PAGE_SIZE));
+    if (aligned > start) ::munmap(mapped, aligned - start);
+    const uintptr_t end = start + padded;
+    if (end > aligned + reserved) ::munmap(reinterpret_cast<void*>(aligned + reserved), end - aligned - reserved);
+#ifdef MADV_HUGEPAGE
+    ::madvise(reinterpret_cast<void*>(aligned), reserved, MADV_HUGEPAGE);
+#endif
+    return reinterpret_cast<void*>(aligned);
+}
+#endif
+
+}  // namespace detail
+
+/**
+ * Allocates an aligned, uninitialized block.
+ * @param bytes: Size of the block.
+ * @param alignment: Required alignment; a power of two.
+ * @param mode: Where the memory comes from. The mapped modes fall back
+ *              to the heap where mmap is unavailable.
+ * @return: The block, or null when out of memory.
+ */
+inline void* allocate(size_t bytes, size_t alignment = MEMORY_CACHE_LINE_SIZE, PageMode mode = PageMode::HEAP) {
+    if (alignment < alignof(detail::Header)) alignment = alignof(detail::Header);
+    const size_t size = bytes + sizeof(detail::Header) + alignment - 1;
+    if (size < bytes) {
+        detail::counters().failures.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    if (mode == PageMode::LARGE) {
+        mode = bytes >= MEMORY_HUGE_PAGE_THRESHOLD ? PageMode::TRANSPARENT : PageMode::HEAP;
+    }
+#if defined(UNIQUEBUILD_POSIX) && defined(MAP_ANONYMOUS)
+    if (mode != PageMode::HEAP && alignment <= MEMORY_HUGE_PAGE_SIZE) {
+        size_t reserved = 0;
+        if (mode == PageMode::EXPLICIT) {
+            if (void* base = detail::mapBlock(size, true, reserved)) {
+                return detail::place(base, reserved, bytes, alignment, detail::BLOCK_HUGETLB);
+            }
+            detail::counters().hugePageFallbacks.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (void* base = detail::mapBlock(size, false, reserved)) {
+            return detail::place(base, reserved, bytes, alignment, detail::BLOCK_MAPPED);
+        }
+    }
+#endif
+    void* base = ::operator new(size, std::nothrow);
+    if (base == nullptr) {
+        detail::counters().failures.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return detail::place(base, size, bytes, alignment, detail::BLOCK_HEAP);
+}
+
+/**
+ * Frees a block from allocate(). Null is ignored.
+ */
+inline void deallocate(void* block) {
+    if (block == nullptr) return;
+    detail::Header* header = static_cast<detail::Header*>(block) - 1;
+    const detail::Header copy = *header;
+    header->magic = 0;
+    detail::recordRelease(copy);
+#if defined(UNIQUEBUILD_POSIX) && defined(MAP_ANONYMOUS)
+    if (copy.kind != detail::BLOCK_HEAP) {
+        ::munmap(copy.base, copy.reserved);
+        return;
+    }
+#endif
+    ::operator delete(copy.base);
+}
+
+/**
+ * @return: Whether block is a live block from allocate(); for asserts.
+ */
+inline bool isLiveBlock(const void* block) {
+    return block != nullptr && (static_cast<const detail::Header*>(block) - 1)->magic == detail::HEADER_MAGIC;
+}
+
+/**
+ * @return: A snapshot of the counters. Counters are updated without
+ *          locking, so fields may be a few operations apart.
+ */
+inline MemoryStats stats() {
+    const detail::Counters& c = detail::counters();
+    MemoryStats out;
+    out.liveBlocks = c.liveBlocks.load(std::memory_order_relaxed);
+    out.bytesRequested = c.bytesRequested.load(std::memory_order_relaxed);
+    out.bytesReserved = c.bytesReserved.load(std::memory_order_relaxed);
+    out.peakBytesReserved = c.peakBytesReserved.load(std::memory_order_relaxed);
+    out.totalBlocks = c.totalBlocks.load(std::memory_order_relaxed);
+    out.mappedBlocks = c.mappedBlocks.load(std::memory_order_relaxed);
+    out.hugePageBytes = c.hugePageBytes.load(std::memory_order_relaxed);
+    out.hugePageFallbacks = c.hugePageFallbacks.load(std::memory_order_relaxed);
+    out.failures = c.failures.load(std::memory_order_relaxed);
+    return out;
+}
+
+/**
+ * Reads how much anonymous memory of the process the kernel currently
+ * backs with transparent huge pages (AnonHugePages in
+ * /proc/self/smaps_rollup), to check that advised blocks got them.
+ * @return: Bytes, or 0 where unavailable.
+ */
+inline size_t residentHugePageBytes() {
+#ifdef OS_LINUX
+    FILE* file = std::fopen("/proc/self/smaps_rollup", "r");
+    if (file == nullptr) return 0;
+    char line[256];
+    size_t kilobytes = 0;
+    while (std::fgets(line, sizeof(line), file)) {
+        if (std::strncmp(line, "AnonHugePages:", 14) == 0) {
+            kilobytes = size_t(std::strtoull(line + 14, nullptr, 10));
+            break;
+        }
+    }
+    std::fclose(file);
+    return kilobytes * 1024;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @class AlignedAllocator
+ * Standard allocator over allocate()/deallocate(), for containers whose
+ * data feeds vector kernels. Stateless; all instances compare equal.
+ */
+template <typename T, size_t Alignment = MEMORY_SIMD_ALIGNMENT, PageMode Mode = PageMode::LARGE>
+class AlignedAllocator {
+public:
+    static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+    static_assert(Alignment >= alignof(T), "Alignment must not be weaker than the type's own");
+
+    typedef T value_type;
+    typedef std::true_type is_always_equal;
+
+    template <typename U>
+    struct rebind {
+        typedef AlignedAllocator<U, Alignment, Mode> other;
+    };
+
+    AlignedAllocator() noexcept {}
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment, Mode>&) noexcept {}
+
+    T* allocate(size_t count) {
+        if (count > size_t(-1) / sizeof(T)) throw std::bad_alloc();
+        void* block = Memory::allocate(count * sizeof(T), Alignment, Mode);
+        if (block == nullptr) throw std::bad_alloc();
+        return static_cast<T*>(block);
+    }
+
+    void deallocate(T* block, size_t) noexcept { Memory::deallocate(block); }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment, Mode>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment, Mode>&) const noexcept { return false; }
+};
+
+/**
+ * std::vector whose data is SIMD aligned, and huge-page backed once it
+ * grows past MEMORY_HUGE_PAGE_THRESHOLD.
+ */
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+}  // namespace Memory
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: Object Pool
+ * Typed pool for objects created and destroyed by the million, such as
+ * FileInfo records of a directory scan. Memory comes in slabs carved out
+ * of larger regions; every slab belongs to one thread's cache, and that
+ * thread allocates by popping its free list or bumping a pointer through
+ * its current slab, with no lock and no atomic operation. A thread that
+ * frees an object of another thread's slab pushes it onto that cache's
+ * lock-free return stack, which the owner takes over in one exchange
+ * when its own list runs dry. Slabs are aligned to their size, so the
+ * slab header and with it the owner are found from any object pointer.
+ ***************************************/
+
+/**
+ * POOL_SLAB_BYTES: Smallest slab size; slabs grow to hold at least 64
+ * objects of large types.
+ */
+#define POOL_SLAB_BYTES (64 * 1024)
+
+/**
+ * POOL_REGION_SLABS: Slabs obtained from the allocator at once. One slab
+ * of each region is lost to aligning the rest.
+ */
+#define POOL_REGION_SLABS 32
+
+/**
+ * POOL_MAX_THREADS: Threads that get their own cache at the same time.
+ * Further threads share one cache behind a mutex. Slots of exited
+ * threads are reused, caches included.
+ */
+#define POOL_MAX_THREADS 64
+
+namespace UniqueBuild {
+
+namespace Memory {
+
+namespace detail {
+
+struct ThreadSlotRegistry {
+    std::mutex mutex;  // Guards used
+    uint64_t used[(POOL_MAX_THREADS + 63) / 64] = {};  // Bit per slot in use
+};
+
+inline ThreadSlotRegistry& threadSlotRegistry() {
+    static ThreadSlotRegistry instance;
+    return instance;
+}
+
+/**
+ * The calling thread's slot; UINT32_MAX until assigned. Trivially
+ * initialized, so reading it needs no TLS guard.
+ */
+inline uint32_t& cachedThreadSlot() {
+    static thread_local uint32_t slot = UINT32_MAX;
+    return slot;
+}
+
+/**
+ * Returns the thread's slot to the registry when the thread exits. The
+ * thread continues on the shared slot for any pool use in later
+ * thread-local destructors.
+ */
+struct ThreadSlotOwner {
+    uint32_t slot = POOL_MAX_THREADS;  // Slot held, or POOL_MAX_THREADS
+
+    ~ThreadSlotOwner() {
+        if (slot == POOL_MAX_THREADS) return;
+        ThreadSlotRegistry& registry = threadSlotRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.used[slot / 64] &= ~(1ull << (slot % 64));
+        cachedThreadSlot() = POOL_MAX_THREADS;
+    }
+};
+
+inline uint32_t acquireThreadSlot() {
+    static thread_local ThreadSlotOwner owner;
+    ThreadSlotRegistry& registry = threadSlotRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (uint32_t slot = 0; slot < POOL_MAX_THREADS; ++slot) {
+        if (!(registry.used[slot / 64] & (1ull << (slot % 64)))) {
+            registry.used[slot / 64] |= 1ull << (slot % 64);
+            owner.slot = slot;
+            return cachedThreadSlot() = slot;
+        }
+    }
+    return cachedThreadSlot() = POOL_MAX_THREADS;
+}
+
+/**
+ * @return: The calling thread's cache index in every ObjectPool, below
+ *          POOL_MAX_THREADS, or POOL_MAX_THREADS for the shared cache.
+ */
+inline uint32_t threadSlot() {
+    const uint32_t slot = cachedThreadSlot();
+    return slot != UINT32_MAX ? slot : acquireThreadSlot();
+}
+
+constexpr size_t nextPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) result <<= 1;
+    return result;
+}
+
+}  // namespace detail
+
+/**
+ * @class ObjectPool
+ * Pool of T objects. create/destroy and allocate/deallocate may be
+ * called from any thread; release() and the destructor must not race
+ * with them.
+ */
+template <typename T>
+class ObjectPool {
+private:
+    struct FreeSlot {
+        FreeSlot* next;  // Next free slot of the same list
+    };
+
+    struct SlabHeader {
+        uint32_t owner;  // Index of the cache the slab belongs to
+        char* limit;  // End of the last slot
+    };
+
+    struct alignas(MEMORY_CACHE_LINE_SIZE) Cache {
+        FreeSlot* freeList = nullptr;  // Slots freed by the owner
+        char* bump = nullptr;  // Next never-used slot of current
+        char* bumpEnd = nullptr;  // End of current's slots
+        SlabHeader* current = nullptr;  // Slab being bumped through
+        alignas(MEMORY_CACHE_LINE_SIZE) std::atomic<FreeSlot*> returned{nullptr};  // Slots freed by other threads
+    };
+
+public:
+    static constexpr size_t SLOT_ALIGNMENT = MAX(alignof(T), alignof(FreeSlot));
+    static constexpr size_t SLOT_SIZE = ALIGN_UP(MAX(sizeof(T), sizeof(FreeSlot)), SLOT_ALIGNMENT);
+    static constexpr size_t FIRST_SLOT = ALIGN_UP(sizeof(SlabHeader), SLOT_ALIGNMENT);
+    static constexpr size_t SLAB_BYTES = MAX(size_t(POOL_SLAB_BYTES), detail::nextPowerOfTwo(FIRST_SLOT + 64 * SLOT_SIZE));
+    static constexpr size_t SLOTS_PER_SLAB = (SLAB_BYTES - FIRST_SLOT) / SLOT_SIZE;
+    static_assert(SLOT_ALIGNMENT <= MEMORY_CACHE_LINE_SIZE, "ObjectPool supports alignments up to a cache line");
+
+    /**
+     * @struct Deleter
+     * unique_ptr deleter that destroys into the pool.
+     */
+    struct Deleter {
+        ObjectPool* pool;  // Pool the object came from
+
+        void operator()(T* object) const {
+            if (object) pool->destroy(object);
+        }
+    };
+
+    typedef std::unique_ptr<T, Deleter> Pointer;
+
+    ObjectPool() {}
+    ~ObjectPool() { release(); }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    /**
+     * Constructs an object in the pool.
+     */
+    template <typename... Args>
+    T* create(Args&&... args) {
+        void* slot = allocate();
+        if (slot == nullptr) throw std::bad_alloc();
+        try {
+            return new (slot) T(std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(slot);
+            throw;
+        }
+    }
+
+    /**
+     * Constructs an object owned by a unique_ptr that destroys it here.
+     */
+    template <typename... Args>
+    Pointer make(Args&&... args) {
+        return Pointer(create(std::forward<Args>(args)...), Deleter{this});
+    }
+
+    /**
+     * Destroys an object from create() and returns its slot.
+     */
+    void destroy(T* object) {
+        object->~T();
+        deallocate(object);
+    }
+
+    /**
+     * @return: Uninitialized storage for one T, or null when out of memory.
+     */
+    void* allocate() {
+        const uint32_t slot = detail::threadSlot();
+        if (slot == POOL_MAX_THREADS) {
+            std::lock_guard<std::mutex> lock(sharedMutex_);
+            return allocateFrom(slot);
+        }
+        return allocateFrom(slot);
+    }
+
+    /**
+     * Returns storage from allocate(); the object must already be
+     * destroyed.
+     */
+    void deallocate(void* storage) {
+        FreeSlot* freed = static_cast<FreeSlot*>(storage);
+        const uint32_t owner = slabOf(storage)->owner;
+        const uint32_t slot = detail::threadSlot();
+        if (owner == slot && slot != POOL_MAX_THREADS) {
+            Cache& cache = caches_[slot];
+            freed->next = cache.freeList;
+            cache.freeList = freed;
+            return;
+        }
+        std::atomic<FreeSlot*>& returned = caches_[owner].returned;
+        FreeSlot* head = returned.load(std::memory_order_relaxed);
+        do {
+            freed->next = head;
+        } while (!returned.compare_exchange_weak(head, freed, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    /**
+     * Destroys every object still alive and returns all memory at once,
+     * without touching objects one by one when T is trivially
+     * destructible. Every pointer into the pool becomes invalid.
+     */
+    void release() {
+        std::lock_guard<std::mutex> lock(slabMutex_);
+        if (!std::is_trivially_destructible<T>::value) destroyLive();
+        for (void* region : regions_) Memory::deallocate(region);
+        regions_.clear();
+        slabs_.clear();
+        spareSlabs_.clear();
+        for (Cache& cache : caches_) {
+            cache.freeList = nullptr;
+            cache.bump = cache.bumpEnd = nullptr;
+            cache.current = nullptr;
+            cache.returned.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @return: Slabs handed out to caches.
+     */
+    size_t slabCount() const {
+        std::lock_guard<std::mutex> lock(slabMutex_);
+        return slabs_.size();
+    }
+
+    /**
+     * @return: Bytes held from the allocator.
+     */
+    size_t bytesReserved() const {
+        std::lock_guard<std::mutex> lock(slabMutex_);
+        return regions_.size() * (POOL_REGION_SLABS + 1) * SLAB_BYTES;
+    }
+
+private:
+    static SlabHeader* slabOf(const void* storage) {
+        return reinterpret_cast<SlabHeader*>(ALIGN_DOWN(reinterpret_cast<uintptr_t>(storage), uintptr_t(SLAB_BYTES)));
+    }
+
+    void* allocateFrom(uint32_t slot) {
+        Cache& cache = caches_[slot];
+        if (FreeSlot* freed = cache.freeList) {
+            cache.freeList = freed->next;
+            return freed;
+        }
+        if (cache.returned.load(std::memory_order_relaxed) != nullptr) {
+            FreeSlot* freed = cache.returned.exchange(nullptr, std::memory_order_acquire);
+            cache.freeList = freed->next;
+            return freed;
+        }
+        if (cache.bump == cache.bumpEnd && !takeSlab(slot)) return nullptr;
+        void* storage = cache.bump;
+        cache.bump += SLOT_SIZE;
+        return storage;
+    }
+
+    /**
+     * Gives a cache a fresh slab, carving a new region when none is spare.
+     */
+    bool takeSlab(uint32_t slot) {
+        std::lock_guard<std::mutex> lock(slabMutex_);
+        if (spareSlabs_.empty()) {
+            const size_t bytes = (POOL_REGION_SLABS + 1) * SLAB_BYTES;
+            char* region = static_cast<char*>(Memory::allocate(bytes, MEMORY_CACHE_LINE_SIZE, PageMode::LARGE));
+            if (region == nullptr) return false;
+            regions_.push_back(region);
+            char* slab = reinterpret_cast<char*>(ALIGN_UP(reinterpret_cast<uintptr_t>(region), uintptr_t(SLAB_BYTES)));
+            for (; slab + SLAB_BYTES <= region + bytes; slab += SLAB_BYTES) {
+                spareSlabs_.push_back(reinterpret_cast<SlabHeader*>(slab));
+            }
+        }
+        SlabHeader* slab = spareSlabs_.back();
+        spareSlabs_.pop_back();
+        slabs_.push_back(slab);
+        char* first = reinterpret_cast<char*>(slab) + FIRST_SLOT;
+        slab->owner = slot;
+        slab->limit = first + SLOTS_PER_SLAB * SLOT_SIZE;
+        Cache& cache = caches_[slot];
+        cache.current = slab;
+        cache.bump = first;
+        cache.bumpEnd = slab->limit;
+        return true;
+    }
+
+    /**
+     * Runs the destructor of every slot that was handed out and not
+     * returned: marks the free slots of all caches in per-slab bitmaps,
+     * then walks the used part of every slab.
+     */
+    void destroyLive() {
+        std::vector<SlabHeader*> sorted(slabs_);
+        std::sort(sorted.begin(), sorted.end());
+        const size_t words = (SLOTS_PER_SLAB + 63) / 64;
+        std::vector<uint64_t> freeBits(sorted.size() * words, 0);
+        auto markFree = [&](const FreeSlot* list) {
+            for (; list != nullptr; list = list->next) {
+                SlabHeader* slab = slabOf(list);
+                const size_t s = size_t(std::lower_bound(sorted.begin(), sorted.end(), slab) - sorted.begin());
+                const size_t index = (reinterpret_cast<const char*>(list) - reinterpret_cast<char*>(slab) - FIRST_SLOT) / SLOT_SIZE;
+                freeBits[s * words + index / 64] |= 1ull << (index % 64);
+            }
+        };
+        for (const Cache& cache : caches_) {
+            markFree(cache.freeList);
+            markFree(cache.returned.load(std::memory_order_acquire));
+        }
+        for (size_t s = 0; s < sorted.size(); ++s) {
+            SlabHeader* slab = sorted[s];
+            const Cache& owner = caches_[slab->owner];
+            const char* first = reinterpret_cast<char*>(slab) + FIRST_SLOT;
+            const char* end = owner.current == slab ? owner.bump : slab->limit;
+            for (size_t index = 0; first + index * SLOT_SIZE < end; ++index) {
+                if (!(freeBits[s * words + index / 64] & (1ull << (index % 64)))) {
+                    reinterpret_cast<T*>(const_cast<char*>(first + index * SLOT_SIZE))->~T();
+                }
+            }
+        }
+    }
+
+    Cache caches_[POOL_MAX_THREADS + 1];  // Per-thread caches, then the shared one
+    std::mutex sharedMutex_;  // Guards the shared cache's owner side
+    mutable std::mutex slabMutex_;  // Guards the slab and region lists
+    std::vector<void*> regions_;  // Blocks from Memory::allocate
+    std::vector<SlabHeader*> slabs_;  // Slabs handed to caches
+    std::vector<SlabHeader*> spareSlabs_;  // Carved slabs not yet handed out
+};
+
+}  // namespace Memory
+
+}  // namespace UniqueBuild
+
+#endif  // UNIQUEBUILD_MEMORY_H
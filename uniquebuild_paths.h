@@ -0,0 +1,262 @@
+/***************************************
+ * uniquebuild_paths.h
+ * Interned, canonical paths named by 32-bit ids.
+ *
+ * Part of uniquebuild; see uniquebuild.h.
+ ***************************************/
+
+#ifndef UNIQUEBUILD_PATHS_H
+#define UNIQUEBUILD_PATHS_H
+
+#include "uniquebuild_core.h"
+#include "uniquebuild_hash.h"
+
+/***************************************
+ * SECTION: Path Interning
+ * Every distinct path is stored once and named by a 32-bit PathId.
+ * Comparing two paths becomes an integer compare, hashing returns a
+ * precomputed value, and parent/child links make directory queries cheap.
+ * Build-graph nodes, stat caches and dependency records key on PathId.
+ ***************************************/
+
+namespace UniqueBuild {
+
+/**
+ * PathId: Handle to a path interned in a PathTable.
+ */
+typedef uint32_t PathId;
+
+/**
+ * INVALID_PATH_ID: Returned where there is no path, e.g. the parent of "/".
+ */
+#define INVALID_PATH_ID 0xFFFFFFFFu
+
+/**
+ * @class PathTable
+ * Interns paths in canonical form: separators collapsed, "." removed,
+ * ".." resolved lexically where a parent component exists, no trailing
+ * separator. "" and "./" both become ".". Symlinks are not resolved.
+ * On Windows, '\' is accepted as a separator and stored as '/'.
+ * Ids are dense, starting at 0, and stay valid for the table's lifetime.
+ * Not thread-safe.
+ */
+class PathTable {
+public:
+    PathTable() : arena_(ARENA_DEFAULT_CHUNK_SIZE), slots_(1024, 0) {}
+
+    PathTable(const PathTable&) = delete;
+    PathTable& operator=(const PathTable&) = delete;
+
+    /**
+     * Interns a path, and all its ancestors, if not already present.
+     * @param path: Any path; it is canonicalized first.
+     * @return: The id of the canonical path.
+     */
+    PathId intern(std::string_view path) {
+        canonicalize(path, scratch_);
+        return internCanonical(scratch_);
+    }
+
+    /**
+     * Looks up a path without interning it.
+     * @param path: Any path; it is canonicalized first.
+     * @return: Its id, or INVALID_PATH_ID if it was never interned.
+     */
+    PathId find(std::string_view path) {
+        canonicalize(path, scratch_);
+        const uint64_t h = hashPath(scratch_);
+        return slots_[findSlot(scratch_, h)] - 1;
+    }
+
+    /**
+     * Interns the path of an entry inside a directory.
+     * @param directory: The directory.
+     * @param name: Entry name, or a relative path below the directory.
+     * @return: The id of directory/name.
+     */
+    PathId child(PathId directory, std::string_view name) {
+        std::string joined;
+        joined.reserve(views_[directory].size() + 1 + name.size());
+        joined.append(views_[directory]);
+        joined.push_back('/');
+        joined.append(name);
+        return intern(joined);
+    }
+
+    /**
+     * @return: The canonical path text; valid for the table's lifetime and NUL-terminated.
+     */
+    std::string_view view(PathId id) const { return views_[id]; }
+
+    std::string str(PathId id) const { return std::string(views_[id]); }
+
+    /**
+     * @return: The precomputed 64-bit hash of the canonical path.
+     */
+    uint64_t hash(PathId id) const { return hashes_[id]; }
+
+    /**
+     * @return: The parent directory, or INVALID_PATH_ID for "/" and ".".
+     */
+    PathId parent(PathId id) const { return parents_[id]; }
+
+    /**
+     * @return: The last path component ("/" and "." return themselves).
+     */
+    std::string_view name(PathId id) const {
+        const std::string_view v = views_[id];
+        const size_t slash = v.rfind('/');
+        return (slash == std::string_view::npos || v.size() == 1) ? v : v.substr(slash + 1);
+    }
+
+    /**
+     * Lists the interned direct children of a directory.
+     * @param directory: The directory.
+     * @param out: Cleared, then filled with child ids.
+     */
+    void children(PathId directory, std::vector<PathId>& out) const {
+        out.clear();
+        for (PathId c = firstChild_[directory]; c != INVALID_PATH_ID; c = nextSibling_[c]) {
+            out.push_back(c);
+        }
+    }
+
+    /**
+     * @return: True if ancestor is id itself or one of its parents.
+     */
+    bool isUnder(PathId id, PathId ancestor) const {
+        for (; id != INVALID_PATH_ID; id = parents_[id]) {
+            if (id == ancestor) return true;
+        }
+        return false;
+    }
+
+    /**
+     * @return: Number of interned paths.
+     */
+    size_t size() const { return views_.size(); }
+
+    /**
+     * Writes the canonical form of a path.
+     * @param path: The input path.
+     * @param out: Receives the canonical path; its capacity is reused.
+     */
+    static void canonicalize(std::string_view path, std::string& out) {
+        out.clear();
+        const bool absolute = !path.empty() && isSeparator(path[0]);
+        if (absolute) out.push_back('/');
+        const size_t rootLength = out.size();
+        size_t i = 0;
+        while (i < path.size()) {
+            while (i < path.size() && isSeparator(path[i])) ++i;
+            const size_t start = i;
+            while (i < path.size() && !isSeparator(path[i])) ++i;
+            const std::string_view component = path.substr(start, i - start);
+            if (component.empty() || component == ".") continue;
+            if (component == "..") {
+                if (out.size() > rootLength) {
+                    const size_t slash = out.rfind('/');
+                    const size_t lastStart = (slash == std::string::npos) ? 0 : slash + 1;
+                    if (std::string_view(out).substr(lastStart) != "..") {
+                        out.resize((slash == std::string::npos || slash < rootLength) ? rootLength : slash);
+                        continue;
+                    }
+                } else if (absolute) {
+                    continue;  // "/.." is "/"
+                }
+            }
+            if (out.size() > rootLength) out.push_back('/');
+            out.append(component);
+        }
+        if (out.empty()) out = ".";
+    }
+
+private:
+    static bool isSeparator(char c) {
+#ifdef OS_WINDOWS
+        return c == '/' || c == '\\';
+#else
+        return c == '/';
+#endif
+    }
+
+    static uint64_t hashPath(std::string_view path) {
+        return Hash::hash64(path);
+    }
+
+    size_t findSlot(std::string_view canonical, uint64_t h) const {
+        const size_t mask = slots_.size() - 1;
+        size_t slot = static_cast<size_t>(h) & mask;
+        while (slots_[slot] != 0) {
+            const PathId id = slots_[slot] - 1;
+            if (hashes_[id] == h && views_[id] == canonical) break;
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    void grow() {
+        std::vector<uint32_t> old;
+        old.swap(slots_);
+        slots_.assign(old.size() * 2, 0);
+        const size_t mask = slots_.size() - 1;
+        for (uint32_t entry : old) {
+            if (entry == 0) continue;
+            size_t slot = static_cast<size_t>(hashes_[entry - 1]) & mask;
+            while (slots_[slot] != 0) slot = (slot + 1) & mask;
+            slots_[slot] = entry;
+        }
+    }
+
+    PathId internCanonical(std::string_view canonical) {
+        const uint64_t h = hashPath(canonical);
+        size_t slot = findSlot(canonical, h);
+        if (slots_[slot] != 0) return slots_[slot] - 1;
+
+        PathId parentId = INVALID_PATH_ID;
+        if (canonical != "/" && canonical != ".") {
+            const size_t cut = canonical.rfind('/');
+            const std::string_view parentPath = (cut == std::string_view::npos) ? std::string_view(".")
+                                              : (cut == 0) ? std::string_view("/") : canonical.substr(0, cut);
+            parentId = internCanonical(parentPath);
+            slot = findSlot(canonical, h);  // The table may have grown
+        }
+
+        const PathId id = static_cast<PathId>(views_.size());
+        views_.push_back(arena_.copyString(canonical));
+        hashes_.push_back(h);
+        parents_.push_back(parentId);
+        firstChild_.push_back(INVALID_PATH_ID);
+        nextSibling_.push_back(INVALID_PATH_ID);
+        if (parentId != INVALID_PATH_ID) {
+            nextSibling_[id] = firstChild_[parentId];
+            firstChild_[parentId] = id;
+        }
+        slots_[slot] = id + 1;
+        if (views_.size() * 2 > slots_.size()) grow();
+        return id;
+    }
+
+    Arena arena_;  // Storage for the path text
+    std::vector<uint32_t> slots_;  // Open-addressing table of id + 1, 0 for empty
+    std::vector<std::string_view> views_;  // Path text by id
+    std::vector<uint64_t> hashes_;  // Path hash by id
+    std::vector<PathId> parents_;  // Parent by id
+    std::vector<PathId> firstChild_;  // Most recently interned child by id
+    std::vector<PathId> nextSibling_;  // Next child of the same parent by id
+    std::string scratch_;  // Canonicalization buffer
+};
+
+/**
+ * @struct PathIdHash
+ * Hash functor for unordered containers keyed by PathId. Ids are dense,
+ * so identity is a good hash; prefer a plain vector indexed by id where
+ * the table is mostly full.
+ */
+struct PathIdHash {
+    size_t operator()(PathId id) const { return static_cast<size_t>(id); }
+};
+
+}  // namespace UniqueBuild
+
+#endif  // UNIQUEBUILD_PATHS_H
@@ -0,0 +1,538 @@
+/***************************************
+ * uniquebuild_records.h
+ * Binary record files: a versioned, aligned container for tables of
+ * User, Point and Rectangle that is read in place through mmap.
+ *
+ * Part of uniquebuild; see uniquebuild.h.
+ ***************************************/
+
+#ifndef UNIQUEBUILD_RECORDS_H
+#define UNIQUEBUILD_RECORDS_H
+
+#include "uniquebuild_core.h"
+#include "uniquebuild_endian.h"
+#include "uniquebuild_log.h"
+#include "uniquebuild_fs.h"
+#include "uniquebuild_hash.h"
+
+/***************************************
+ * SECTION: Record Files
+ * Layout, all integers little-endian:
+ *
+ *   offset 0   header, RECORD_HEADER_SIZE bytes:
+ *                u8[8]  magic "UBRECORD"
+ *                u32    format version (RECORD_FORMAT_VERSION)
+ *                u32    schema id, see RecordSchema
+ *                u64    record count
+ *                u32    record size in bytes
+ *                u32    flags, zero
+ *                u64    offset of the records
+ *                u64    offset of the string offset table, 0 if none
+ *                u64    offset of the string heap, 0 if none
+ *                u64    hash64 of the preceding 56 bytes
+ *   records    count fixed-size records, RECORD_ALIGNMENT-aligned
+ *   offsets    count + 1 u64 offsets into the heap, 8-aligned; the
+ *              string of record i spans [offsets[i], offsets[i + 1])
+ *   heap       string bytes up to the end of the file, not terminated
+ *
+ * Opening a file maps it and checks the header only, so it costs the
+ * same for ten records as for fifty million; records are decoded when
+ * they are accessed.
+ ***************************************/
+
+/**
+ * RECORD_FORMAT_VERSION: Bumped whenever the container layout changes.
+ */
+#define RECORD_FORMAT_VERSION 1
+
+/**
+ * RECORD_HEADER_SIZE: Size of the file header in bytes.
+ * RECORD_ALIGNMENT: Alignment of the record section.
+ */
+#define RECORD_HEADER_SIZE 64
+#define RECORD_ALIGNMENT 64
+
+namespace UniqueBuild {
+
+/**
+ * @namespace Records
+ * Binary record files.
+ */
+namespace Records {
+
+/**
+ * Derives a schema id from a layout description (FNV-1a), so that any
+ * change to a record layout yields a different id.
+ */
+constexpr uint32_t schemaId(const char* description, uint32_t hash = 0x811C9DC5u) {
+    return *description ? schemaId(description + 1, (hash ^ uint8_t(*description)) * 0x01000193u) : hash;
+}
+
+/**
+ * @struct RecordSchema
+ * Fixed layout of one record type. Specializations provide
+ *   ID            schema id stored in the header
+ *   SIZE          record size in bytes
+ *   HAS_STRING    true if records carry a string in the heap
+ *   View          zero-copy accessor over a mapped record
+ *   encode()      writes the fixed part of a record
+ *   string()      the string field, if HAS_STRING
+ *   decode()      builds the struct from a mapped record
+ */
+template <typename T>
+struct RecordSchema;
+
+template <>
+struct RecordSchema<Point> {
+    static const uint32_t ID = schemaId("Point{i32 x;i32 y}");
+    static const uint32_t SIZE = 8;
+    static const bool HAS_STRING = false;
+
+    struct View {
+        const uint8_t* p;  // The record
+
+        int32_t x() const { return Endian::loadLittle<int32_t>(p); }
+        int32_t y() const { return Endian::loadLittle<int32_t>(p + 4); }
+    };
+
+    static void encode(uint8_t* out, const Point& point) {
+        Endian::storeLittle(out, int32_t(point.x));
+        Endian::storeLittle(out + 4, int32_t(point.y));
+    }
+
+    static std::string_view string(const Point&) { return std::string_view(); }
+
+    static Point decode(const uint8_t* p, std::string_view) {
+        const View view = {p};
+        return Point{view.x(), view.y()};
+    }
+};
+
+template <>
+struct RecordSchema<Rectangle> {
+    static const uint32_t ID = schemaId("Rectangle{i32 x;i32 y;i32 width;i32 height}");
+    static const uint32_t SIZE = 16;
+    static const bool HAS_STRING = false;
+
+    struct View {
+        const uint8_t* p;  // The record
+
+        int32_t x() const { return Endian::loadLittle<int32_t>(p); }
+        int32_t y() const { return Endian::loadLittle<int32_t>(p + 4); }
+        int32_t width() const { return Endian::loadLittle<int32_t>(p + 8); }
+        int32_t height() const { return Endian::loadLittle<int32_t>(p + 12); }
+    };
+
+    static void encode(uint8_t* out, const Rectangle& rectangle) {
+        Endian::storeLittle(out, int32_t(rectangle.topLeft.x));
+        Endian::storeLittle(out + 4, int32_t(rectangle.topLeft.y));
+        Endian::storeLittle(out + 8, int32_t(rectangle.width));
+        Endian::storeLittle(out + 12, int32_t(rectangle.height));
+    }
+
+    static std::string_view string(const Rectangle&) { return std::string_view(); }
+
+    static Rectangle decode(const uint8_t* p, std::string_view) {
+        const View view = {p};
+        return Rectangle{Point{view.x(), view.y()}, view.width(), view.height()};
+    }
+};
+
+template <>
+struct RecordSchema<User> {
+    static const uint32_t ID = schemaId("User{i32 id;i32 age;str name}");
+    static const uint32_t SIZE = 8;
+    static const bool HAS_STRING = true;
+
+    struct View {
+        const uint8_t* p;  // The record
+        std::string_view name;  // Points into the mapped heap
+
+        int32_t id() const { return Endian::loadLittle<int32_t>(p); }
+        int32_t age() const { return Endian::loadLittle<int32_t>(p + 4); }
+    };
+
+    static void encode(uint8_t* out, const User& user) {
+        Endian::storeLittle(out, int32_t(user.id));
+        Endian::storeLittle(out + 4, int32_t(user.age));
+    }
+
+    static std::string_view string(const User& user) { return user.name; }
+
+    static User decode(const uint8_t* p, std::string_view name) {
+        const View view = {p, name};
+        return User{view.id(), std::string(name), view.age()};
+    }
+};
+
+namespace detail {
+
+const char RECORD_MAGIC[8] = {'U', 'B', 'R', 'E', 'C', 'O', 'R', 'D'};
+
+/**
+ * @struct Header
+ * The decoded file header.
+ */
+struct Header {
+    uint32_t version;
+    uint32_t schema;
+    uint64_t count;
+    uint32_t recordSize;
+    uint32_t flags;
+    uint64_t recordsOffset;
+    uint64_t offsetsOffset;
+    uint64_t heapOffset;
+    uint64_t heapSize;
+};
+
+inline void encodeHeader(uint8_t* out, const Header& header) {
+    std::memcpy(out, RECORD_MAGIC, 8);
+    Endian::storeLittle(out + 8, header.version);
+    Endian::storeLittle(out + 12, header.schema);
+    Endian::storeLittle(out + 16, header.count);
+    Endian::storeLittle(out + 24, header.recordSize);
+    Endian::storeLittle(out + 28, header.flags);
+    Endian::storeLittle(out + 32, header.recordsOffset);
+    Endian::storeLittle(out + 40, header.offsetsOffset);
+    Endian::storeLittle(out + 48, header.heapOffset);
+    Endian::storeLittle(out + 56, Hash::hash64(out, 56));
+}
+
+/**
+ * Decodes and checks a header against the file size.
+ * @return: Null on success, otherwise a description of the problem.
+ */
+inline const char* decodeHeader(const uint8_t* p, uint64_t fileSize, Header& header) {
+    if (fileSize < RECORD_HEADER_SIZE || std::memcmp(p, RECORD_MAGIC, 8) != 0) return "not a record file";
+    if (Endian::loadLittle<uint64_t>(p + 56) != Hash::hash64(p, 56)) return "corrupt header";
+    header.version = Endian::loadLittle<uint32_t>(p + 8);
+    header.schema = Endian::loadLittle<uint32_t>(p + 12);
+    header.count = Endian::loadLittle<uint64_t>(p + 16);
+    header.recordSize = Endian::loadLittle<uint32_t>(p + 24);
+    header.flags = Endian::loadLittle<uint32_t>(p + 28);
+    header.recordsOffset = Endian::loadLittle<uint64_t>(p + 32);
+    header.offsetsOffset = Endian::loadLittle<uint64_t>(p + 40);
+    header.heapOffset = Endian::loadLittle<uint64_t>(p + 48);
+    header.heapSize = 0;
+    if (header.version != RECORD_FORMAT_VERSION) return "unsupported format version";
+    if (header.recordsOffset < RECORD_HEADER_SIZE || header.recordsOffset % RECORD_ALIGNMENT != 0 ||
+        header.recordsOffset > fileSize || header.recordSize == 0 || header.count > (fileSize - header.recordsOffset) / header.recordSize) {
+        return "record section out of bounds";
+    }
+    if (header.offsetsOffset != 0) {
+        const uint64_t recordsEnd = header.recordsOffset + header.count * header.recordSize;
+        if (header.offsetsOffset < recordsEnd || header.offsetsOffset % 8 != 0 || header.offsetsOffset > fileSize ||
+            (fileSize - header.offsetsOffset) / 8 < header.count + 1 || header.heapOffset > fileSize ||
+            header.heapOffset < header.offsetsOffset + (header.count + 1) * 8) {
+            return "string section out of bounds";
+        }
+        header.heapSize = fileSize - header.heapOffset;
+    }
+    return nullptr;
+}
+
+inline uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace detail
+
+/**
+ * @class RecordReader
+ * A record file mapped read-only. Records are accessed in place: view()
+ * reads fields straight from the mapping, operator[] builds the struct.
+ */
+template <typename T>
+class RecordReader {
+public:
+    typedef RecordSchema<T> Schema;
+    typedef typename Schema::View View;
+
+    RecordReader() : error_(nullptr), count_(0), records_(nullptr), offsets_(nullptr), heap_(nullptr), heapSize_(0) {}
+
+    explicit RecordReader(const std::string& filename) : RecordReader() { open(filename); }
+
+    RecordReader(const RecordReader&) = delete;
+    RecordReader& operator=(const RecordReader&) = delete;
+
+    /**
+     * Maps a file and checks its header. The records are not touched.
+     * @param filename: A file written by RecordWriter<T>.
+     * @return: False if the file cannot be mapped or does not hold records
+     *          of type T; error() says why.
+     */
+    bool open(const std::string& filename) {
+        close();
+        if (!file_.open(filename)) {
+            error_ = "cannot open file";
+            return false;
+        }
+        detail::Header header;
+        error_ = detail::decodeHeader(file_.data(), file_.size(), header);
+        if (!error_ && (header.schema != Schema::ID || header.recordSize != Schema::SIZE)) {
+            error_ = "schema mismatch";
+        }
+        if (!error_ && Schema::HAS_STRING != (header.offsetsOffset != 0)) error_ = "schema mismatch";
+        if (error_) {
+            file_.close();
+            return false;
+        }
+        const uint8_t* base = file_.data();
+        count_ = size_t(header.count);
+        records_ = base + header.recordsOffset;
+        if (header.offsetsOffset != 0) {
+            offsets_ = base + header.offsetsOffset;
+            heap_ = base + header.heapOffset;
+            heapSize_ = header.heapSize;
+        }
+        return true;
+    }
+
+    void close() {
+        file_.close();
+        count_ = 0;
+        records_ = offsets_ = heap_ = nullptr;
+        heapSize_ = 0;
+    }
+
+    bool isOpen() const { return file_.isOpen(); }
+    const char* error() const { return error_ ? error_ : ""; }
+    size_t size() const { return count_; }
+
+    /**
+     * @return: The fixed-size bytes of record i.
+     */
+    const uint8_t* record(size_t i) const { return records_ + i * Schema::SIZE; }
+
+    /**
+     * @return: The string field of record i, pointing into the mapping;
+     *          empty if the type has none or the offsets are damaged.
+     */
+    std::string_view string(size_t i) const {
+        if (!offsets_) return std::string_view();
+        const uint64_t begin = Endian::loadLittle<uint64_t>(offsets_ + 8 * i);
+        const uint64_t end = Endian::loadLittle<uint64_t>(offsets_ + 8 * i + 8);
+        if (begin > end || end > heapSize_) return std::string_view();
+        return std::string_view(reinterpret_cast<const char*>(heap_) + begin, size_t(end - begin));
+    }
+
+    View view(size_t i) const { return makeView(i, std::integral_constant<bool, Schema::HAS_STRING>()); }
+
+    T operator[](size_t i) const { return Schema::decode(record(i), string(i)); }
+
+    /**
+     * Asks the kernel to read the whole file ahead, for full scans.
+     */
+    void adviseSequential() const { file_.adviseSequential(); }
+
+private:
+    View makeView(size_t i, std::true_type) const { return View{record(i), string(i)}; }
+    View makeView(size_t i, std::false_type) const { return View{record(i)}; }
+
+    FileUtils::MappedFile file_;  // The mapping
+    const char* error_;  // Why open() failed, or null
+    size_t count_;  // Number of records
+    const uint8_t* records_;  // Start of the record section
+    const uint8_t* offsets_;  // String offset table, or null
+    const uint8_t* heap_;  // String heap, or null
+    uint64_t heapSize_;  // Bytes in the heap
+};
+
+/**
+ * @class RecordWriter
+ * Writes a record file front to back through buffered streams. Records
+ * go straight to the file; string offsets and string bytes are staged in
+ * temporary files and appended by close(). The file is built under a
+ * temporary name and renamed into place, so readers never see a
+ * partial file. A writer destroyed without close() discards its file.
+ */
+template <typename T>
+class RecordWriter {
+public:
+    typedef RecordSchema<T> Schema;
+
+    RecordWriter() : file_(nullptr), offsets_(nullptr), heap_(nullptr), count_(0), heapSize_(0), failed_(false) {}
+
+    explicit RecordWriter(const std::string& filename) : RecordWriter() { open(filename); }
+
+    // Dropped on an error path: leave the previous file in place.
+    ~RecordWriter() {
+        if (file_) discard();
+    }
+
+    RecordWriter(const RecordWriter&) = delete;
+    RecordWriter& operator=(const RecordWriter&) = delete;
+
+    /**
+     * Starts a new file; it replaces filename when close() succeeds.
+     * @return: False if the temporary files cannot be created.
+     */
+    bool open(const std::string& filename) {
+        close();
+        filename_ = filename;
+        temporary_ = FileUtils::temporaryName(filename);
+        count_ = 0;
+        heapSize_ = 0;
+        failed_ = false;
+        file_ = std::fopen(temporary_.c_str(), FILE_MODE_WRITE_BINARY);
+        if (Schema::HAS_STRING) {
+            offsets_ = std::tmpfile();
+            heap_ = std::tmpfile();
+        }
+        if (!file_ || (Schema::HAS_STRING && (!offsets_ || !heap_))) {
+            discard();
+            return false;
+        }
+        fileSink_.reset(new Format::BufferedSink(file_));
+        const char zeros[RECORD_HEADER_SIZE] = {};
+        fileSink_->append(std::string_view(zeros, RECORD_HEADER_SIZE));
+        if (Schema::HAS_STRING) {
+            offsetsSink_.reset(new Format::BufferedSink(offsets_));
+            heapSink_.reset(new Format::BufferedSink(heap_));
+            appendOffset(0);
+        }
+        return true;
+    }
+
+    bool isOpen() const { return file_ != nullptr; }
+    size_t size() const { return count_; }
+
+    /**
+     * Appends one record.
+     */
+    void write(const T& value) {
+        if (!file_) return;
+        char fixed[Schema::SIZE];
+        Schema::encode(reinterpret_cast<uint8_t*>(fixed), value);
+        fileSink_->append(std::string_view(fixed, Schema::SIZE));
+        if (Schema::HAS_STRING) {
+            const std::string_view text = Schema::string(value);
+            heapSink_->append(text);
+            heapSize_ += text.size();
+            appendOffset(heapSize_);
+        }
+        ++count_;
+    }
+
+    void write(const std::vector<T>& values) {
+        for (const T& value : values) write(value);
+    }
+
+    /**
+     * Finishes the file: appends the string sections, writes the header
+     * and renames the file into place.
+     * @return: True if the file was written completely.
+     */
+    bool close() {
+        if (!file_) return false;
+        detail::Header header;
+        header.version = RECORD_FORMAT_VERSION;
+        header.schema = Schema::ID;
+        header.count = count_;
+        header.recordSize = Schema::SIZE;
+        header.flags = 0;
+        header.recordsOffset = RECORD_HEADER_SIZE;
+        header.offsetsOffset = 0;
+        header.heapOffset = 0;
+        header.heapSize = heapSize_;
+        uint64_t position = RECORD_HEADER_SIZE + uint64_t(count_) * Schema::SIZE;
+        if (Schema::HAS_STRING) {
+            header.offsetsOffset = detail::alignUp(position, 8);
+            pad(header.offsetsOffset - position);
+            offsetsSink_->flush();
+            copyStream(offsets_);
+            header.heapOffset = header.offsetsOffset + (uint64_t(count_) + 1) * 8;
+            heapSink_->flush();
+            copyStream(heap_);
+        }
+        fileSink_->flush();
+        uint8_t encoded[RECORD_HEADER_SIZE];
+        detail::encodeHeader(encoded, header);
+        if (std::fseek(file_, 0, SEEK_SET) != 0 ||
+            std::fwrite(encoded, 1, RECORD_HEADER_SIZE, file_) != RECORD_HEADER_SIZE) {
+            failed_ = true;
+        }
+        fileSink_.reset();
+        if (std::ferror(file_)) failed_ = true;
+        const bool closed = std::fclose(file_) == 0;
+        file_ = nullptr;
+        closeStaging();
+        if (failed_ || !closed || std::rename(temporary_.c_str(), filename_.c_str()) != 0) {
+            std::remove(temporary_.c_str());
+            return false;
+        }
+        return true;
+    }
+
+private:
+    void appendOffset(uint64_t offset) {
+        char bytes[8];
+        Endian::storeLittle(bytes, offset);
+        offsetsSink_->append(std::string_view(bytes, 8));
+    }
+
+    void pad(uint64_t bytes) {
+        const char zeros[8] = {};
+        fileSink_->append(std::string_view(zeros, size_t(bytes)));
+    }
+
+    void copyStream(std::FILE* stream) {
+        if (std::fflush(stream) != 0 || std::fseek(stream, 0, SEEK_SET) != 0) {
+            failed_ = true;
+            return;
+        }
+        fileSink_->flush();
+        char buffer[OUTPUT_SINK_CAPACITY];
+        size_t n;
+        while ((n = std::fread(buffer, 1, sizeof(buffer), stream)) > 0) {
+            if (std::fwrite(buffer, 1, n, file_) != n) failed_ = true;
+        }
+        if (std::ferror(stream)) failed_ = true;
+    }
+
+    void closeStaging() {
+        offsetsSink_.reset();
+        heapSink_.reset();
+        if (offsets_) std::fclose(offsets_);
+        if (heap_) std::fclose(heap_);
+        offsets_ = heap_ = nullptr;
+    }
+
+    void discard() {
+        fileSink_.reset();
+        if (file_) std::fclose(file_);
+        file_ = nullptr;
+        closeStaging();
+        std::remove(temporary_.c_str());
+    }
+
+    std::string filename_;  // Final name
+    std::string temporary_;  // Name while writing
+    std::FILE* file_;  // The record file
+    std::FILE* offsets_;  // Staged string offsets
+    std::FILE* heap_;  // Staged string bytes
+    std::unique_ptr<Format::BufferedSink> fileSink_;  // Buffers file_
+    std::unique_ptr<Format::BufferedSink> offsetsSink_;  // Buffers offsets_
+    std::unique_ptr<Format::BufferedSink> heapSink_;  // Buffers heap_
+    size_t count_;  // Records written
+    uint64_t heapSize_;  // String bytes written
+    bool failed_;  // Set on a write error
+};
+
+/**
+ * Writes a whole table.
+ * @return: True if the file was written completely.
+ */
+template <typename T>
+inline bool writeRecords(const std::string& filename, const std::vector<T>& values) {
+    RecordWriter<T> writer;
+    if (!writer.open(filename)) return false;
+    writer.write(values);
+    return writer.close();
+}
+
+}  // namespace Records
+
+}  // namespace UniqueBuild
+
+#endif  // UNIQUEBUILD_RECORDS_H
@@ -0,0 +1,1341 @@
+/***************************************
+ * uniquebuild_remote.h
+ * Remote execution: a framed protocol that ships build commands and
+ * their content-addressed inputs to worker processes over TCP or Unix
+ * sockets, the client that drives it from a Graph, and the worker.
+ *
+ * Part of uniquebuild; see uniquebuild.h.
+ ***************************************/
+
+#ifndef UNIQUEBUILD_REMOTE_H
+#define UNIQUEBUILD_REMOTE_H
+
+#include "uniquebuild_core.h"
+#include "uniquebuild_endian.h"
+#include "uniquebuild_log.h"
+#include "uniquebuild_fs.h"
+#include "uniquebuild_hash.h"
+#include "uniquebuild_paths.h"
+#include "uniquebuild_exec.h"
+
+#include <functional>          // Required for std::function
+#include <unordered_map>       // Required for std::unordered_map
+#include <mutex>               // Required for std::mutex
+#include <condition_variable>  // Required for std::condition_variable
+#include <deque>               // Required for std::deque
+
+#ifdef UNIQUEBUILD_POSIX
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <poll.h>
+#endif
+
+/***************************************
+ * SECTION: Protocol
+ * Every message is a frame: a little-endian u32 payload length, a u8
+ * message type and the payload. Integers in payloads are little-endian,
+ * strings and blobs are a u32 or u64 length followed by the bytes, and
+ * blobs are addressed by the Hash::hash128 of their content.
+ *
+ *   HELLO    both ways   u32 version
+ *   EXECUTE  to worker   u64 id, argv, inputs (path, digest, size,
+ *                        executable), output paths
+ *   FETCH    to client   digests of inputs the worker does not have
+ *   BLOBS    to worker   (digest, present, bytes) for fetched digests
+ *   RESULT   to client   u64 id, i32 exit status, command output,
+ *                        outputs (path, present, executable, bytes)
+ *
+ * Clients send EXECUTE messages without waiting for earlier results;
+ * RESULT messages arrive in completion order.
+ ***************************************/
+
+/**
+ * REMOTE_PROTOCOL_VERSION: Sent in HELLO; both sides must agree.
+ */
+#define REMOTE_PROTOCOL_VERSION 1
+
+/**
+ * REMOTE_WORKER_ENDPOINT: Default endpoint of the bundled worker.
+ */
+#define REMOTE_WORKER_ENDPOINT "unix:.uniquebuild-worker.sock"
+
+/**
+ * REMOTE_MAX_FRAME: Largest frame either side accepts, in bytes.
+ */
+#define REMOTE_MAX_FRAME (1u << 30)
+
+/**
+ * REMOTE_BATCH_BYTES: Small blobs are packed into BLOBS frames of up to
+ * this many bytes; larger blobs travel in a frame of their own.
+ */
+#define REMOTE_BATCH_BYTES (1024 * 1024)
+
+/**
+ * REMOTE_MAX_IN_FLIGHT: Actions a client keeps submitted to one worker
+ * before waiting for results.
+ */
+#define REMOTE_MAX_IN_FLIGHT (THREAD_POOL_SIZE * 4)
+
+namespace UniqueBuild {
+
+/**
+ * @namespace Remote
+ * Remote execution of build commands.
+ */
+namespace Remote {
+
+enum class MessageType : uint8_t {
+    HELLO = 1,
+    EXECUTE = 2,
+    FETCH = 3,
+    BLOBS = 4,
+    RESULT = 5
+};
+
+/**
+ * @struct RemoteInput
+ * A file an action reads, addressed by content.
+ */
+struct RemoteInput {
+    std::string path;  // Relative to the action's working directory
+    Hash::Hash128 digest;  // hash128 of the content
+    uint64_t size;  // Content size in bytes
+    bool executable;  // Materialized with the execute bit set
+};
+
+/**
+ * @struct RemoteAction
+ * A command together with everything it reads and writes.
+ */
+struct RemoteAction {
+    std::vector<std::string> argv;  // The command; run without a shell
+    std::vector<RemoteInput> inputs;  // Files the command reads
+    std::vector<std::string> outputs;  // Files the command writes
+};
+
+/**
+ * @struct RemoteOutput
+ * A file an action wrote.
+ */
+struct RemoteOutput {
+    std::string path;  // As named in RemoteAction::outputs
+    bool present;  // False if the command did not create it
+    bool executable;  // Execute bit on the worker
+    std::string data;  // The content
+};
+
+/**
+ * @struct RemoteResult
+ * What came back for an action.
+ */
+struct RemoteResult {
+    int status;  // Exit status as from Exec::runCommand; -1 on protocol errors
+    std::string log;  // stdout and stderr of the command
+    std::vector<RemoteOutput> outputs;  // One per requested output
+};
+
+/**
+ * @struct RemoteStats
+ * Traffic counters of a client, for diagnostics.
+ */
+struct RemoteStats {
+    size_t actions;  // EXECUTE messages sent
+    size_t fetches;  // Blobs the worker asked for
+    size_t blobFrames;  // BLOBS frames sent
+    uint64_t bytesSent;  // Frame bytes written
+    uint64_t bytesReceived;  // Frame bytes read
+};
+
+namespace detail {
+
+/**
+ * Appends little-endian values to a frame payload.
+ */
+class Encoder {
+public:
+    explicit Encoder(std::string& out) : out_(out) {}
+
+    void u8(uint8_t value) { out_.push_back(char(value)); }
+
+    void u32(uint32_t value) {
+        char bytes[4];
+        Endian::storeLittle(bytes, value);
+        out_.append(bytes, 4);
+    }
+
+    void u64(uint64_t value) {
+        char bytes[8];
+        Endian::storeLittle(bytes, value);
+        out_.append(bytes, 8);
+    }
+
+    void digest(const Hash::Hash128& value) {
+        u64(value.low);
+        u64(value.high);
+    }
+
+    void str(std::string_view value) {
+        u32(uint32_t(value.size()));
+        out_.append(value.data(), value.size());
+    }
+
+    void blob(std::string_view value) {
+        u64(value.size());
+        out_.append(value.data(), value.size());
+    }
+
+private:
+    std::string& out_;  // Payload being built
+};
+
+/**
+ * Reads little-endian values from a frame payload. Reading past the end
+ * sets a sticky error flag and yields zeros.
+ */
+class Decoder {
+public:
+    Decoder(const char* data, size_t size) : p_(data), end_(data + size), ok_(true) {}
+
+    bool ok() const { return ok_; }
+    bool done() const { return p_ == end_; }
+
+    uint8_t u8() { return uint8_t(take(1) ? p_[-1] : 0); }
+
+    uint32_t u32() { return take(4) ? Endian::loadLittle<uint32_t>(p_ - 4) : 0; }
+    uint64_t u64() { return take(8) ? Endian::loadLittle<uint64_t>(p_ - 8) : 0; }
+
+    Hash::Hash128 digest() {
+        Hash::Hash128 value;
+        value.low = u64();
+        value.high = u64();
+        return value;
+    }
+
+    std::string_view str() { return bytes(u32()); }
+    std::string_view blob() { return bytes(u64()); }
+
+    /**
+     * @return: A count that cannot exceed the remaining payload, assuming
+     *          each element takes at least minSize bytes.
+     */
+    uint32_t count(size_t minSize) {
+        const uint32_t n = u32();
+        if (size_t(end_ - p_) / minSize < n) {
+            ok_ = false;
+            return 0;
+        }
+        return n;
+    }
+
+private:
+    bool take(uint64_t n) {
+        if (!ok_ || uint64_t(end_ - p_) < n) {
+            ok_ = false;
+            return false;
+        }
+        p_ += n;
+        return true;
+    }
+
+    std::string_view bytes(uint64_t n) {
+        if (!take(n)) return std::string_view();
+        return std::string_view(p_ - n, size_t(n));
+    }
+
+    const char* p_;  // Read position
+    const char* end_;  // End of the payload
+    bool ok_;  // False after a short read
+};
+
+/**
+ * Starts a frame in out; finishFrame() fills in its length.
+ * @return: Offset of the frame header, for finishFrame().
+ */
+inline size_t beginFrame(std::string& out, MessageType type) {
+    const size_t start = out.size();
+    out.append(4, '\0');
+    out.push_back(char(type));
+    return start;
+}
+
+/**
+ * Overwrites four bytes at offset with a little-endian value.
+ */
+inline void patchU32(std::string& out, size_t offset, uint32_t value) {
+    Endian::storeLittle(&out[offset], value);
+}
+
+inline void finishFrame(std::string& out, size_t start) {
+    patchU32(out, start, uint32_t(out.size() - start - 5));
+}
+
+/**
+ * Parses a frame header at the front of buffer.
+ * @return: Payload length, or -1 if fewer than 5 bytes are buffered and
+ *          -2 if the length exceeds REMOTE_MAX_FRAME.
+ */
+inline int64_t frameLength(const std::string& buffer, size_t offset) {
+    if (buffer.size() - offset < 5) return -1;
+    const uint32_t length = Endian::loadLittle<uint32_t>(buffer.data() + offset);
+    if (length > REMOTE_MAX_FRAME) return -2;
+    return length;
+}
+
+inline std::string digestHex(const Hash::Hash128& digest) {
+    char buffer[40];
+    std::snprintf(buffer, sizeof(buffer), "%016llx%016llx", static_cast<unsigned long long>(digest.high),
+                  static_cast<unsigned long long>(digest.low));
+    return buffer;
+}
+
+struct DigestHash {
+    size_t operator()(const Hash::Hash128& digest) const { return size_t(digest.low ^ (digest.high * 31)); }
+};
+
+/**
+ * A relative path that stays inside the directory it is resolved in.
+ */
+inline bool isContainedPath(std::string_view path) {
+    if (path.empty() || path[0] == '/') return false;
+    size_t begin = 0;
+    while (begin <= path.size()) {
+        size_t end = path.find('/', begin);
+        if (end == std::string_view::npos) end = path.size();
+        if (path.substr(begin, end - begin) == "..") return false;
+        begin = end + 1;
+    }
+    return true;
+}
+
+inline bool readWholeFile(const std::string& filename, std::string& out) {
+    out.clear();
+    FileUtils::MappedFile file;
+    if (!file.open(filename)) {
+        std::FILE* empty = std::fopen(filename.c_str(), "rb");
+        if (!empty) return false;
+        std::fclose(empty);
+        return true;
+    }
+    out.assign(file.view());
+    return true;
+}
+
+/**
+ * Writes data to filename through a temporary file, creating parent
+ * directories as needed.
+ */
+inline bool writeWholeFile(const std::string& filename, std::string_view data, bool executable) {
+    const size_t slash = filename.find_last_of('/');
+    if (slash != std::string::npos && slash > 0) FileUtils::createDirectories(filename.substr(0, slash));
+    const std::string temporary = FileUtils::temporaryName(filename);
+    std::FILE* file = std::fopen(temporary.c_str(), FILE_MODE_WRITE_BINARY);
+    if (!file) return false;
+    const bool written = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    if (std::fclose(file) != 0 || !written) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+#ifdef UNIQUEBUILD_POSIX
+    ::chmod(temporary.c_str(), executable ? 0755 : 0644);
+#else
+    (void)executable;
+#endif
+    if (std::rename(temporary.c_str(), filename.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+#ifdef UNIQUEBUILD_POSIX
+
+/**
+ * Parses "unix:/path/to.sock" or "tcp:host:port".
+ * @return: A socket address in storage, or false if endpoint is malformed
+ *          or the host does not resolve.
+ */
+inline bool resolveEndpoint(const std::string& endpoint, sockaddr_storage& storage, socklen_t& length) {
+    std::memset(&storage, 0, sizeof(storage));
+    if (endpoint.compare(0, 5, "unix:") == 0) {
+        sockaddr_un& address = reinterpret_cast<sockaddr_un&>(storage);
+        if (!Build::detail::socketAddress(endpoint.substr(5), address)) return false;
+        length = sizeof(sockaddr_un);
+        return true;
+    }
+    if (endpoint.compare(0, 4, "tcp:") != 0) return false;
+    const size_t colon = endpoint.find_last_of(':');
+    if (colon <= 4) return false;
+    std::string host = endpoint.substr(4, colon - 4);
+    const std::string port = endpoint.substr(colon + 1);
+    if (host.size() > 2 && host.front() == '[' && host.back() == ']') host = host.substr(1, host.size() - 2);
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* found = nullptr;
+    if (::getaddrinfo(host.empty() || host == "*" ? nullptr : host.c_str(), port.c_str(), &hints, &found) != 0) {
+        return false;
+    }
+    std::memcpy(&storage, found->ai_addr, found->ai_addrlen);
+    length = found->ai_addrlen;
+    ::freeaddrinfo(found);
+    return true;
+}
+
+inline void tuneSocket(int fd, const sockaddr_storage& storage) {
+    if (storage.ss_family == AF_INET || storage.ss_family == AF_INET6) {
+        const int on = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    }
+}
+
+/**
+ * Reads exactly length bytes.
+ */
+inline bool readAll(int fd, char* data, size_t length) {
+    while (length > 0) {
+        const ssize_t n = ::recv(fd, data, length, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        length -= size_t(n);
+    }
+    return true;
+}
+
+/**
+ * Reads one frame with blocking reads.
+ */
+inline bool readFrame(int fd, MessageType& type, std::string& payload) {
+    std::string header(5, '\0');
+    if (!readAll(fd, &header[0], 5)) return false;
+    const int64_t length = frameLength(header, 0);
+    if (length < 0) return false;
+    type = MessageType(uint8_t(header[4]));
+    payload.resize(size_t(length));
+    return length == 0 || readAll(fd, &payload[0], size_t(length));
+}
+
+#endif  // UNIQUEBUILD_POSIX
+
+}  // namespace detail
+
+/***************************************
+ * SECTION: Client
+ * Submits actions to one worker and writes their outputs locally.
+ ***************************************/
+
+#ifdef UNIQUEBUILD_POSIX
+
+/**
+ * @class RemoteClient
+ * One connection to a worker. Not thread-safe; callbacks run on the
+ * thread that calls wait() or execute().
+ */
+class RemoteClient {
+public:
+    typedef std::function<void(const RemoteResult&)> Callback;
+
+    RemoteClient() : fd_(-1), nextId_(1), stats_() {}
+    ~RemoteClient() { close(); }
+
+    RemoteClient(const RemoteClient&) = delete;
+    RemoteClient& operator=(const RemoteClient&) = delete;
+
+    /**
+     * Connects and exchanges HELLO with the worker.
+     * @param endpoint: "unix:/path" or "tcp:host:port".
+     * @return: True if the worker speaks this protocol version.
+     */
+    bool connect(const std::string& endpoint) {
+        close();
+        sockaddr_storage storage;
+        socklen_t length = 0;
+        if (!detail::resolveEndpoint(endpoint, storage, length)) return false;
+        fd_ = ::socket(storage.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd_ < 0) return false;
+        if (::connect(fd_, reinterpret_cast<sockaddr*>(&storage), length) != 0) {
+            close();
+            return false;
+        }
+        detail::tuneSocket(fd_, storage);
+        IGNORE_SIGNAL(SIGPIPE);
+
+        std::string frame;
+        const size_t start = detail::beginFrame(frame, MessageType::HELLO);
+        detail::Encoder(frame).u32(REMOTE_PROTOCOL_VERSION);
+        detail::finishFrame(frame, start);
+        MessageType type;
+        std::string payload;
+        timeval timeout = {TIMEOUT_MS / 1000, (TIMEOUT_MS % 1000) * 1000};
+        ::setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        if (!Build::detail::writeAll(fd_, frame.data(), frame.size()) || !detail::readFrame(fd_, type, payload) ||
+            type != MessageType::HELLO || detail::Decoder(payload.data(), payload.size()).u32() != REMOTE_PROTOCOL_VERSION) {
+            close();
+            return false;
+        }
+        timeout = {0, 0};
+        ::setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        ::fcntl(fd_, F_SETFL, ::fcntl(fd_, F_GETFL) | O_NONBLOCK);
+        return true;
+    }
+
+    bool isConnected() const { return fd_ >= 0; }
+
+    /**
+     * Closes the connection. Actions still in flight complete with status -1.
+     */
+    void close() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        failAll();
+        outbox_.clear();
+        inbox_.clear();
+        blobPaths_.clear();
+    }
+
+    /**
+     * Queues an action. Up to REMOTE_MAX_IN_FLIGHT actions are sent ahead of
+     * their results; the rest wait in the client.
+     * @param action: Input paths must be readable until the action completes.
+     * @param done: Called with the result once its outputs have been written.
+     */
+    void submit(const RemoteAction& action, Callback done) {
+        const uint64_t id = nextId_++;
+        Pending& pending = pending_[id];
+        pending.action = action;
+        pending.done = std::move(done);
+        for (const RemoteInput& input : action.inputs) {
+            blobPaths_[input.digest] = input.path;
+        }
+        if (sent_ < REMOTE_MAX_IN_FLIGHT) {
+            send(id);
+        } else {
+            queued_.push_back(id);
+        }
+    }
+
+    /**
+     * Pumps the connection until every submitted action has completed.
+     * @return: False if the connection failed; the affected actions
+     *          completed with status -1.
+     */
+    bool wait() {
+        while (!pending_.empty()) {
+            if (fd_ < 0) {
+                failAll();
+                return false;
+            }
+            pollfd entry = {fd_, short(POLLIN | (outbox_.empty() ? 0 : POLLOUT)), 0};
+            if (::poll(&entry, 1, -1) < 0) {
+                if (errno == EINTR) continue;
+                close();
+                return false;
+            }
+            if ((entry.revents & POLLOUT) && !flush()) {
+                close();
+                return false;
+            }
+            if ((entry.revents & (POLLIN | POLLHUP | POLLERR)) && !receive()) {
+                close();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Runs one action and waits for it.
+     */
+    RemoteResult execute(const RemoteAction& action) {
+        RemoteResult result;
+        result.status = -1;
+        submit(action, [&result](const RemoteResult& r) { result = r; });
+        wait();
+        return result;
+    }
+
+    const RemoteStats& stats() const { return stats_; }
+
+private:
+    struct Pending {
+        RemoteAction action;
+        Callback done;
+    };
+
+    void send(uint64_t id) {
+        const RemoteAction& action = pending_[id].action;
+        const size_t start = detail::beginFrame(outbox_, MessageType::EXECUTE);
+        detail::Encoder out(outbox_);
+        out.u64(id);
+        out.u32(uint32_t(action.argv.size()));
+        for (const std::string& arg : action.argv) out.str(arg);
+        out.u32(uint32_t(action.inputs.size()));
+        for (const RemoteInput& input : action.inputs) {
+            out.str(input.path);
+            out.digest(input.digest);
+            out.u64(input.size);
+            out.u8(input.executable ? 1 : 0);
+        }
+        out.u32(uint32_t(action.outputs.size()));
+        for (const std::string& output : action.outputs) out.str(output);
+        detail::finishFrame(outbox_, start);
+        ++sent_;
+        ++stats_.actions;
+    }
+
+    bool flush() {
+        while (!outbox_.empty()) {
+            const ssize_t n = ::send(fd_, outbox_.data(), outbox_.size(), MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+            if (n <= 0) return false;
+            stats_.bytesSent += uint64_t(n);
+            outbox_.erase(0, size_t(n));
+        }
+        return true;
+    }
+
+    bool receive() {
+        char buffer[BUFFER_SIZE_2048 * 32];
+        for (;;) {
+            const ssize_t n = ::recv(fd_, buffer, sizeof(buffer), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            if (n <= 0) return false;
+            stats_.bytesReceived += uint64_t(n);
+            inbox_.append(buffer, size_t(n));
+        }
+        size_t offset = 0;
+        for (;;) {
+            const int64_t length = detail::frameLength(inbox_, offset);
+            if (length == -2) return false;
+            if (length < 0 || inbox_.size() - offset - 5 < uint64_t(length)) break;
+            const MessageType type = MessageType(uint8_t(inbox_[offset + 4]));
+            detail::Decoder in(inbox_.data() + offset + 5, size_t(length));
+            offset += 5 + size_t(length);
+            if (type == MessageType::FETCH) {
+                if (!answerFetch(in)) return false;
+            } else if (type == MessageType::RESULT) {
+                if (!complete(in)) return false;
+            } else {
+                return false;
+            }
+        }
+        inbox_.erase(0, offset);
+        return flush();
+    }
+
+    /**
+     * Answers a FETCH, packing blobs into BLOBS frames of up to
+     * REMOTE_BATCH_BYTES each.
+     */
+    bool answerFetch(detail::Decoder& in) {
+        const uint32_t count = in.count(16);
+        std::string frame;
+        size_t start = 0;
+        uint32_t entries = 0;
+        auto finishBatch = [&]() {
+            if (entries == 0) return;
+            detail::patchU32(frame, start + 5, entries);
+            detail::finishFrame(frame, start);
+            outbox_.append(frame);
+            ++stats_.blobFrames;
+            frame.clear();
+            entries = 0;
+        };
+        std::string content;
+        for (uint32_t i = 0; i < count; ++i) {
+            const Hash::Hash128 digest = in.digest();
+            const auto found = blobPaths_.find(digest);
+            const bool present = found != blobPaths_.end() && detail::readWholeFile(found->second, content) &&
+                                 Hash::hash128(content) == digest;
+            if (!present) content.clear();
+            if (entries > 0 && frame.size() + content.size() > REMOTE_BATCH_BYTES) finishBatch();
+            if (entries == 0) {
+                start = detail::beginFrame(frame, MessageType::BLOBS);
+                detail::Encoder(frame).u32(0);
+            }
+            detail::Encoder out(frame);
+            out.digest(digest);
+            out.u8(present ? 1 : 0);
+            out.blob(content);
+            ++entries;
+            ++stats_.fetches;
+        }
+        finishBatch();
+        return in.ok();
+    }
+
+    bool complete(detail::Decoder& in) {
+        const uint64_t id = in.u64();
+        RemoteResult result;
+        result.status = int(int32_t(in.u32()));
+        result.log.assign(in.str());
+        const uint32_t count = in.count(14);
+        for (uint32_t i = 0; i < count; ++i) {
+            RemoteOutput output;
+            output.path.assign(in.str());
+            output.present = in.u8() != 0;
+            output.executable = in.u8() != 0;
+            output.data.assign(in.blob());
+            result.outputs.push_back(std::move(output));
+        }
+        const auto found = pending_.find(id);
+        if (!in.ok() || found == pending_.end()) return false;
+        Pending pending = std::move(found->second);
+        pending_.erase(found);
+        --sent_;
+        if (!queued_.empty()) {
+            send(queued_.front());
+            queued_.pop_front();
+        }
+
+        if (!result.log.empty()) {
+            std::fwrite(result.log.data(), 1, result.log.size(), stdout);
+            std::fflush(stdout);
+        }
+        // Only the outputs the action named are written, never a path the
+        // worker chose.
+        const std::vector<std::string>& expected = pending.action.outputs;
+        bool matches = result.outputs.size() == expected.size();
+        for (size_t i = 0; matches && i < expected.size(); ++i) {
+            matches = result.outputs[i].path == expected[i] && detail::isContainedPath(expected[i]);
+        }
+        if (!matches) {
+            LOG_ERROR("worker returned outputs that do not match the action");
+            result.status = -1;
+            result.outputs.clear();
+        }
+        for (size_t i = 0; i < result.outputs.size(); ++i) {
+            const RemoteOutput& output = result.outputs[i];
+            if (!output.present) continue;
+            if (!detail::writeWholeFile(expected[i], output.data, output.executable) && result.status == 0) {
+                LOG_ERROR(("cannot write " + expected[i]).c_str());
+                result.status = -1;
+            }
+        }
+        if (pending.done) pending.done(result);
+        return true;
+    }
+
+    void failAll() {
+        RemoteResult failed;
+        failed.status = -1;
+        std::unordered_map<uint64_t, Pending> pending;
+        pending.swap(pending_);
+        queued_.clear();
+        sent_ = 0;
+        for (auto& entry : pending) {
+            if (entry.second.done) entry.second.done(failed);
+        }
+    }
+
+    int fd_;  // Connection, -1 when closed
+    uint64_t nextId_;  // Next action id
+    size_t sent_ = 0;  // Actions sent and not yet answered
+    std::unordered_map<uint64_t, Pending> pending_;  // Submitted actions by id
+    std::deque<uint64_t> queued_;  // Actions waiting for a free slot
+    std::unordered_map<Hash::Hash128, std::string, detail::DigestHash> blobPaths_;  // Where to read each digest
+    std::string outbox_;  // Frames not yet written
+    std::string inbox_;  // Bytes of incomplete frames
+    RemoteStats stats_;  // Traffic counters
+};
+
+/**
+ * @class RemoteRunner
+ * Runs the targets of a Graph on a worker. Each wave of independent
+ * targets is submitted at once, so up to REMOTE_MAX_IN_FLIGHT actions
+ * are pipelined on the connection. Inputs and dependencies discovered
+ * from depfiles are sent by content; files outside the working
+ * directory, such as system headers, are expected to exist on the
+ * worker. Targets that cannot be described completely run locally, and
+ * so do commands whose connection to the worker breaks.
+ */
+class RemoteRunner : public Build::CommandRunner {
+public:
+    /**
+     * @param graph: The graph whose caches provide input digests.
+     * @param endpoint: The worker, as for RemoteClient::connect.
+     */
+    RemoteRunner(Build::Graph& graph, const std::string& endpoint)
+        : graph_(graph), endpoint_(endpoint), directory_(FileUtils::currentDirectory() + "/"), unavailable_(false) {}
+
+    int run(const Build::Target& target) override {
+        RemoteAction action;
+        if (unavailable_ || !describe(target, action)) return Exec::runCommand(target.command);
+        if (!client_.isConnected() && !client_.connect(endpoint_)) {
+            LOG_WARN(("no worker at " + endpoint_ + "; running commands locally").c_str());
+            unavailable_ = true;
+            return Exec::runCommand(target.command);
+        }
+        LOG_INFO(("CMD: " + Exec::quoteCommand(target.command) + " [remote]").c_str());
+        const RemoteResult result = client_.execute(action);
+        if (!client_.isConnected()) {
+            // The connection broke, not the command: run it here instead.
+            // The next target tries to reconnect.
+            LOG_WARN(("lost worker at " + endpoint_ + "; running the command locally").c_str());
+            return Exec::runCommand(target.command);
+        }
+        return result.status;
+    }
+
+    void runBatch(const std::vector<const Build::Target*>& targets, std::vector<int>& statuses) override {
+        statuses.assign(targets.size(), -1);
+        // lost[i] is set when the action failed because the connection broke.
+        std::vector<uint8_t> lost(targets.size(), 0);
+        std::vector<size_t> local;
+        RemoteAction action;
+        for (size_t i = 0; i < targets.size(); ++i) {
+            const Build::Target& target = *targets[i];
+            action = RemoteAction();
+            if (unavailable_ || !describe(target, action)) {
+                local.push_back(i);
+                continue;
+            }
+            if (!client_.isConnected() && !client_.connect(endpoint_)) {
+                LOG_WARN(("no worker at " + endpoint_ + "; running commands locally").c_str());
+                unavailable_ = true;
+                local.push_back(i);
+                continue;
+            }
+            LOG_INFO(("CMD: " + Exec::quoteCommand(target.command) + " [remote]").c_str());
+            client_.submit(action, [this, i, &statuses, &lost](const RemoteResult& result) {
+                statuses[i] = result.status;
+                lost[i] = !client_.isConnected();
+            });
+        }
+        if (!client_.wait()) LOG_WARN(("lost worker at " + endpoint_ + "; running its commands locally").c_str());
+        for (size_t i = 0; i < targets.size(); ++i) {
+            if (lost[i]) local.push_back(i);
+        }
+        for (size_t i : local) {
+            statuses[i] = Exec::runCommand(targets[i]->command);
+        }
+    }
+
+    RemoteClient& client() { return client_; }
+
+private:
+    /**
+     * Makes a path relative to the working directory.
+     * @return: False for paths that leave it.
+     */
+    bool relative(const std::string& path, std::string& out, bool& workspace) const {
+        workspace = true;
+        if (!path.empty() && path[0] == '/') {
+            if (path.compare(0, directory_.size(), directory_) != 0) {
+                workspace = false;
+                return true;
+            }
+            out = path.substr(directory_.size());
+        } else {
+            out = path;
+        }
+        return detail::isContainedPath(out);
+    }
+
+    bool describe(const Build::Target& target, RemoteAction& action) {
+        if (target.command.empty()) return false;
+        if (target.depfile != INVALID_PATH_ID && target.discovered.empty()) return false;
+        action.argv = target.command;
+        PathTable& paths = graph_.paths();
+        std::string name;
+        bool workspace;
+        for (int pass = 0; pass < 2; ++pass) {
+            const std::vector<PathId>& ids = pass == 0 ? target.inputs : target.discovered;
+            for (PathId id : ids) {
+                const std::string& path = paths.str(id);
+                if (!relative(path, name, workspace)) return false;
+                if (!workspace) {
+                    if (pass == 0) return false;
+                    continue;
+                }
+                const Build::FileStamp stamp = graph_.statCache().stat(id);
+                if (!stamp.exists) return false;
+                RemoteInput input;
+                input.path = name;
+                input.digest = graph_.hashCache().contentHash(id, stamp);
+                input.size = stamp.size;
+                struct stat info;
+                input.executable = ::stat(path.c_str(), &info) == 0 && (info.st_mode & S_IXUSR);
+                action.inputs.push_back(input);
+            }
+        }
+        if (!relative(paths.str(target.output), name, workspace) || !workspace) return false;
+        action.outputs.push_back(name);
+        if (target.depfile != INVALID_PATH_ID) {
+            if (!relative(paths.str(target.depfile), name, workspace) || !workspace) return false;
+            action.outputs.push_back(name);
+        }
+        return true;
+    }
+
+    Build::Graph& graph_;  // Source of digests
+    std::string endpoint_;  // Worker address
+    std::string directory_;  // Working directory with a trailing slash
+    RemoteClient client_;  // Connection, opened on first use
+    bool unavailable_;  // Set once connecting failed
+};
+
+#endif  // UNIQUEBUILD_POSIX
+
+/***************************************
+ * SECTION: Worker
+ * Executes actions for clients: keeps a content-addressed blob store,
+ * fetches what it is missing and runs each action in its own sandbox
+ * directory.
+ ***************************************/
+
+#ifdef UNIQUEBUILD_POSIX
+
+/**
+ * @class BlobStore
+ * Content-addressed files in a directory, one per digest.
+ */
+class BlobStore {
+public:
+    explicit BlobStore(const std::string& directory) : directory_(directory) {
+        FileUtils::createDirectories(directory_);
+    }
+
+    std::string pathOf(const Hash::Hash128& digest) const { return directory_ + "/" + detail::digestHex(digest); }
+
+    bool has(const Hash::Hash128& digest) const {
+        struct stat info;
+        return ::stat(pathOf(digest).c_str(), &info) == 0;
+    }
+
+    /**
+     * Stores a blob after checking that it matches its digest.
+     */
+    bool put(const Hash::Hash128& digest, std::string_view data) {
+        if (Hash::hash128(data) != digest) return false;
+        if (has(digest)) return true;
+        return detail::writeWholeFile(pathOf(digest), data, false);
+    }
+
+private:
+    std::string directory_;  // Where blobs live
+};
+
+/**
+ * @class Worker
+ * Serves clients on one endpoint. Each connection is read by its own
+ * thread; its actions run on THREAD_POOL_SIZE executor threads as soon
+ * as their inputs are in the blob store.
+ */
+class Worker {
+public:
+    /**
+     * @param cacheDirectory: The blob store; can be shared between workers.
+     * @param workDirectory: Parent of the per-action sandboxes.
+     */
+    Worker(const std::string& cacheDirectory, const std::string& workDirectory)
+        : store_(cacheDirectory), workDirectory_(workDirectory), listenFd_(-1), unixPath_(), connections_(0),
+          stopping_(false) {
+        FileUtils::createDirectories(workDirectory_);
+    }
+
+    ~Worker() { stop(); }
+
+    Worker(const Worker&) = delete;
+    Worker& operator=(const Worker&) = delete;
+
+    /**
+     * Binds the endpoint.
+     * @param endpoint: "unix:/path" or "tcp:host:port"; port 0 picks a free port.
+     * @return: True if the worker is ready to serve.
+     */
+    bool start(const std::string& endpoint) {
+        {
+            std::lock_guard<std::mutex> lock(clientsMutex_);
+            stopping_ = false;
+        }
+        sockaddr_storage storage;
+        socklen_t length = 0;
+        if (!detail::resolveEndpoint(endpoint, storage, length)) {
+            LOG_ERROR(("bad endpoint " + endpoint).c_str());
+            return false;
+        }
+        if (storage.ss_family == AF_UNIX) {
+            unixPath_ = endpoint.substr(5);
+            ::unlink(unixPath_.c_str());
+        }
+        const int fd = ::socket(storage.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) return false;
+        listenFd_ = fd;
+        const int on = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&storage), length) != 0 || ::listen(fd, MAX_CONNECTIONS) != 0) {
+            stop();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @return: The TCP port the worker listens on, or 0.
+     */
+    int port() const {
+        sockaddr_storage storage;
+        socklen_t length = sizeof(storage);
+        const int fd = listenFd_;
+        if (fd < 0 || ::getsockname(fd, reinterpret_cast<sockaddr*>(&storage), &length) != 0) return 0;
+        if (storage.ss_family == AF_INET) return ntohs(reinterpret_cast<sockaddr_in&>(storage).sin_port);
+        if (storage.ss_family == AF_INET6) return ntohs(reinterpret_cast<sockaddr_in6&>(storage).sin6_port);
+        return 0;
+    }
+
+    /**
+     * Accepts clients until the listening socket fails or stop() is
+     * called; each is served on its own thread. Returns once every
+     * connection has ended.
+     * @return: 1 if the endpoint could not be bound.
+     */
+    int serve(const std::string& endpoint) {
+        if (listenFd_ < 0 && !start(endpoint)) return 1;
+        IGNORE_SIGNAL(SIGPIPE);
+        LOG_INFO(("worker listening on " + endpoint).c_str());
+        for (;;) {
+            const int client = ::accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                break;
+            }
+            const int on = 1;
+            ::setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            {
+                std::lock_guard<std::mutex> lock(clientsMutex_);
+                if (stopping_) {
+                    ::close(client);
+                    break;
+                }
+                clients_.push_back(client);
+            }
+            const size_t serial = ++connections_;
+            std::thread([this, client, serial]() {
+                Connection connection(*this, client, serial);
+                connection.run();
+                // Unregister and close under the lock, so stop() never shuts
+                // down a reused descriptor; nothing touches the worker after.
+                std::lock_guard<std::mutex> lock(clientsMutex_);
+                clients_.erase(std::find(clients_.begin(), clients_.end(), client));
+                ::close(client);
+                clientsIdle_.notify_all();
+            }).detach();
+        }
+        stop();
+        return 0;
+    }
+
+    /**
+     * Closes the listening socket, disconnects every client and waits
+     * until their connection threads are done with the worker. Actions
+     * already running are waited for.
+     */
+    void stop() {
+        const int fd = listenFd_.exchange(-1);
+        if (fd >= 0) {
+            // shutdown wakes a serve() blocked in accept on another thread.
+            ::shutdown(fd, SHUT_RDWR);
+            ::close(fd);
+            if (!unixPath_.empty()) ::unlink(unixPath_.c_str());
+        }
+        std::unique_lock<std::mutex> lock(clientsMutex_);
+        stopping_ = true;
+        for (int client : clients_) {
+            ::shutdown(client, SHUT_RDWR);
+        }
+        clientsIdle_.wait(lock, [this]() { return clients_.empty(); });
+    }
+
+private:
+    struct Job {
+        uint64_t id;
+        std::vector<std::string> argv;
+        std::vector<RemoteInput> inputs;
+        std::vector<std::string> outputs;
+        size_t missing = 0;  // Inputs not yet in the store
+        bool failed = false;  // An input could not be fetched
+    };
+
+    /**
+     * State of one client connection.
+     */
+    class Connection {
+    public:
+        Connection(Worker& worker, int fd, size_t serial) : worker_(worker), fd_(fd), serial_(serial), closing_(false) {}
+
+        void run() {
+            std::vector<std::thread> executors;
+            for (int i = 0; i < THREAD_POOL_SIZE; ++i) {
+                executors.emplace_back([this]() { execute(); });
+            }
+            MessageType type;
+            std::string payload;
+            while (detail::readFrame(fd_, type, payload)) {
+                detail::Decoder in(payload.data(), payload.size());
+                bool ok = true;
+                if (type == MessageType::HELLO) {
+                    ok = in.u32() == REMOTE_PROTOCOL_VERSION;
+                    std::string frame;
+                    const size_t start = detail::beginFrame(frame, MessageType::HELLO);
+                    detail::Encoder(frame).u32(REMOTE_PROTOCOL_VERSION);
+                    detail::finishFrame(frame, start);
+                    write(frame);
+                } else if (type == MessageType::EXECUTE) {
+                    ok = enqueue(in);
+                } else if (type == MessageType::BLOBS) {
+                    ok = receive(in);
+                } else {
+                    ok = false;
+                }
+                if (!ok) break;
+                if (!fetch_.empty() && !moreBuffered()) sendFetch();
+            }
+            ::shutdown(fd_, SHUT_RDWR);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                closing_ = true;
+            }
+            readyCondition_.notify_all();
+            for (std::thread& executor : executors) executor.join();
+        }
+
+    private:
+        bool enqueue(detail::Decoder& in) {
+            std::unique_ptr<Job> job(new Job());
+            job->id = in.u64();
+            uint32_t count = in.count(4);
+            for (uint32_t i = 0; i < count; ++i) job->argv.emplace_back(in.str());
+            count = in.count(29);
+            for (uint32_t i = 0; i < count; ++i) {
+                RemoteInput input;
+                input.path.assign(in.str());
+                input.digest = in.digest();
+                input.size = in.u64();
+                input.executable = in.u8() != 0;
+                job->inputs.push_back(std::move(input));
+            }
+            count = in.count(4);
+            for (uint32_t i = 0; i < count; ++i) job->outputs.emplace_back(in.str());
+            if (!in.ok() || job->argv.empty()) return false;
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            Job* raw = job.get();
+            for (const RemoteInput& input : raw->inputs) {
+                if (worker_.store_.has(input.digest)) continue;
+                std::vector<Job*>& waiting = waiting_[input.digest];
+                if (waiting.empty()) fetch_.push_back(input.digest);
+                waiting.push_back(raw);
+                ++raw->missing;
+            }
+            jobs_.push_back(std::move(job));
+            if (raw->missing == 0) {
+                ready_.push_back(raw);
+                readyCondition_.notify_one();
+            }
+            return true;
+        }
+
+        /**
+         * @return: True if another frame is already waiting on the socket;
+         *          FETCH requests are held back until then so that the
+         *          digests of pipelined actions go out in one batch.
+         */
+        bool moreBuffered() const {
+            pollfd entry = {fd_, POLLIN, 0};
+            return ::poll(&entry, 1, 0) > 0 && (entry.revents & POLLIN);
+        }
+
+        void sendFetch() {
+            std::string frame;
+            const size_t start = detail::beginFrame(frame, MessageType::FETCH);
+            detail::Encoder out(frame);
+            out.u32(uint32_t(fetch_.size()));
+            for (const Hash::Hash128& digest : fetch_) out.digest(digest);
+            detail::finishFrame(frame, start);
+            fetch_.clear();
+            write(frame);
+        }
+
+        bool receive(detail::Decoder& in) {
+            const uint32_t count = in.count(25);
+            for (uint32_t i = 0; i < count; ++i) {
+                const Hash::Hash128 digest = in.digest();
+                const bool present = in.u8() != 0;
+                const std::string_view data = in.blob();
+                if (!in.ok()) return false;
+                const bool stored = present && worker_.store_.put(digest, data);
+                std::lock_guard<std::mutex> lock(mutex_);
+                const auto found = waiting_.find(digest);
+                if (found == waiting_.end()) continue;
+                for (Job* job : found->second) {
+                    if (!stored) job->failed = true;
+                    if (--job->missing == 0) {
+                        ready_.push_back(job);
+                        readyCondition_.notify_one();
+                    }
+                }
+                waiting_.erase(found);
+            }
+            return in.ok();
+        }
+
+        void execute() {
+            for (;;) {
+                Job* job;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    readyCondition_.wait(lock, [this]() { return closing_ || !ready_.empty(); });
+                    if (ready_.empty()) return;
+                    job = ready_.front();
+                    ready_.pop_front();
+                }
+                std::string frame = runJob(*job);
+                write(frame);
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (auto it = jobs_.begin(); it != jobs_.end(); ++it) {
+                    if (it->get() == job) {
+                        jobs_.erase(it);
+                        break;
+                    }
+                }
+            }
+        }
+
+        std::string runJob(const Job& job) {
+            const std::string sandbox =
+                worker_.workDirectory_ + "/a" + std::to_string(serial_) + "-" + std::to_string(job.id);
+            std::string log;
+            int status = job.failed ? -1 : 0;
+            if (job.failed) log = "worker: an input could not be fetched\n";
+            FileUtils::removeTree(sandbox);
+            FileUtils::createDirectories(sandbox);
+            for (size_t i = 0; status == 0 && i < job.inputs.size(); ++i) {
+                const RemoteInput& input = job.inputs[i];
+                if (!detail::isContainedPath(input.path) || !materialize(input, sandbox + "/" + input.path)) {
+                    log = "worker: cannot place input " + input.path + "\n";
+                    status = -1;
+                }
+            }
+            for (size_t i = 0; status == 0 && i < job.outputs.size(); ++i) {
+                const std::string& output = job.outputs[i];
+                if (!detail::isContainedPath(output)) {
+                    log = "worker: output outside the sandbox: " + output + "\n";
+                    status = -1;
+                    break;
+                }
+                const size_t slash = output.find_last_of('/');
+                if (slash != std::string::npos) FileUtils::createDirectories(sandbox + "/" + output.substr(0, slash));
+            }
+            if (status == 0) status = Exec::runCommandIn(job.argv, sandbox, &log);
+
+            std::string frame;
+            const size_t start = detail::beginFrame(frame, MessageType::RESULT);
+            detail::Encoder out(frame);
+            out.u64(job.id);
+            out.u32(uint32_t(int32_t(status)));
+            out.str(log);
+            out.u32(uint32_t(job.outputs.size()));
+            std::string data;
+            for (const std::string& output : job.outputs) {
+                const std::string path = sandbox + "/" + output;
+                struct stat info;
+                const bool present = detail::isContainedPath(output) && ::stat(path.c_str(), &info) == 0 &&
+                                     S_ISREG(info.st_mode) && detail::readWholeFile(path, data);
+                out.str(output);
+                out.u8(present ? 1 : 0);
+                out.u8(present && (info.st_mode & S_IXUSR) ? 1 : 0);
+                out.blob(present ? std::string_view(data) : std::string_view());
+            }
+            detail::finishFrame(frame, start);
+            FileUtils::removeTree(sandbox);
+            return frame;
+        }
+
+        /**
+         * Places a blob at path: as a hard link into the store when possible,
+         * otherwise, and always for executables, as a copy (a reflink where
+         * the filesystem supports it).
+         */
+        bool materialize(const RemoteInput& input, const std::string& path) {
+            const size_t slash = path.find_last_of('/');
+            FileUtils::createDirectories(path.substr(0, slash));
+            const std::string blob = worker_.store_.pathOf(input.digest);
+            if (!input.executable && ::link(blob.c_str(), path.c_str()) == 0) return true;
+            if (!FileUtils::copyFile(blob, path).ok()) return false;
+            return ::chmod(path.c_str(), input.executable ? 0755 : 0644) == 0;
+        }
+
+        void write(const std::string& frame) {
+            std::lock_guard<std::mutex> lock(writeMutex_);
+            Build::detail::writeAll(fd_, frame.data(), frame.size());
+        }
+
+        Worker& worker_;  // Owner of the store
+        int fd_;  // Client socket
+        size_t serial_;  // Names this connection's sandboxes
+        std::mutex mutex_;  // Guards the job state below
+        std::mutex writeMutex_;  // Serializes frames on the socket
+        std::condition_variable readyCondition_;  // Signals ready_ and closing_
+        std::vector<std::unique_ptr<Job>> jobs_;  // Jobs not yet answered
+        std::unordered_map<Hash::Hash128, std::vector<Job*>, detail::DigestHash> waiting_;  // Jobs by missing digest
+        std::deque<Job*> ready_;  // Jobs whose inputs are all stored
+        std::vector<Hash::Hash128> fetch_;  // Digests to request; used by the reader thread only
+        bool closing_;  // Set when the client disconnected
+    };
+
+    BlobStore store_;  // Inputs by digest
+    std::string workDirectory_;  // Parent of the sandboxes
+    std::atomic<int> listenFd_;  // Listening socket, -1 when stopped; stop() may run on another thread
+    std::string unixPath_;  // Socket file to remove on stop
+    std::atomic<size_t> connections_;  // Connections accepted so far
+    std::mutex clientsMutex_;  // Guards clients_ and stopping_
+    std::condition_variable clientsIdle_;  // Signals a connection thread finishing
+    std::vector<int> clients_;  // Sockets of live connections
+    bool stopping_;  // Set by stop(); serve() accepts no more clients
+};
+
+/**
+ * Entry point of the bundled worker binary.
+ *
+ *   --listen ENDPOINT   unix:/path or tcp:host:port (default REMOTE_WORKER_ENDPOINT)
+ *   --cache DIR         blob store (default .uniquebuild-worker/cas)
+ *   --work DIR          sandboxes (default .uniquebuild-worker/work)
+ *
+ * @return: The process exit status.
+ */
+inline int runWorker(int argc, char** argv) {
+    std::string endpoint = REMOTE_WORKER_ENDPOINT;
+    std::string cache = ".uniquebuild-worker/cas";
+    std::string work = ".uniquebuild-worker/work";
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 < argc && arg == "--listen") {
+            endpoint = argv[++i];
+        } else if (i + 1 < argc && arg == "--cache") {
+            cache = argv[++i];
+        } else if (i + 1 < argc && arg == "--work") {
+            work = argv[++i];
+        } else {
+            std::fprintf(stderr, "usage: %s [--listen ENDPOINT] [--cache DIR] [--work DIR]\n", argv[0]);
+            return 2;
+        }
+    }
+    Worker worker(cache, work);
+    return worker.serve(endpoint);
+}
+
+#endif  // UNIQUEBUILD_POSIX
+
+}  // namespace Remote
+
+}  // namespace UniqueBuild
+
+#endif  // UNIQUEBUILD_REMOTE_H
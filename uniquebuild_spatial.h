@@ -0,0 +1,863 @@
+/***************************************
+ * uniquebuild_spatial.h
+ * Spatial indexes over Rectangle and Circle: a uniform grid and a packed
+ * STR bulk-loaded R-tree, with point, range and nearest-neighbour
+ * queries, batched queries and parallel builds.
+ *
+ * Part of uniquebuild; see uniquebuild.h.
+ ***************************************/
+
+#ifndef UNIQUEBUILD_SPATIAL_H
+#define UNIQUEBUILD_SPATIAL_H
+
+#include "uniquebuild_core.h"
+#include "uniquebuild_math.h"
+#include "uniquebuild_log.h"
+#include "uniquebuild_geometry.h"
+
+#include <algorithm>  // Required for std::sort, std::inplace_merge, heaps
+#include <chrono>     // Required for std::chrono::steady_clock in benchmark
+
+/***************************************
+ * SECTION: Spatial Index
+ * Both indexes copy the shapes they are built from and answer queries by
+ * shape index. Candidates are found through integer bounding boxes and
+ * then confirmed with the Geometry predicates, so results match a brute
+ * force scan exactly. Empty shapes (zero or negative size, negative
+ * radius) are never returned.
+ *
+ * GridIndex suits dense data of similar, small shapes spread evenly over
+ * the covered area; each shape is listed in every cell its box touches.
+ * RTree adapts to any distribution: shapes are packed into leaves with
+ * Sort-Tile-Recursive and all nodes sit in one array, root first and one
+ * level after another, so a query walks contiguous memory.
+ ***************************************/
+
+/**
+ * SPATIAL_GRID_ITEMS_PER_CELL: Average number of shapes per grid cell the
+ * cell size is chosen for.
+ */
+#define SPATIAL_GRID_ITEMS_PER_CELL 4
+
+/**
+ * SPATIAL_GRID_MAX_CELLS: Upper bound on the number of grid cells, which
+ * bounds the memory of a grid over sparse or elongated data.
+ */
+#define SPATIAL_GRID_MAX_CELLS (1u << 22)
+
+/**
+ * SPATIAL_RTREE_NODE_CAPACITY: Children per R-tree node. Sixteen 32-byte
+ * boxes span eight cache lines, read in order.
+ */
+#define SPATIAL_RTREE_NODE_CAPACITY 16
+
+/**
+ * SPATIAL_BATCH_MIN_CHUNK: Smallest number of queries of a batch run on
+ * one thread.
+ */
+#define SPATIAL_BATCH_MIN_CHUNK 256
+
+namespace UniqueBuild {
+
+/**
+ * @namespace Spatial
+ * GridIndex and RTree over Rectangle or Circle.
+ */
+namespace Spatial {
+
+/**
+ * @struct Box
+ * Closed integer bounding box: the points with minX <= x <= maxX and
+ * minY <= y <= maxY. 64-bit so that boxes of circles with huge radii
+ * do not overflow.
+ */
+struct Box {
+    int64_t minX;  // Smallest x inside
+    int64_t minY;  // Smallest y inside
+    int64_t maxX;  // Largest x inside
+    int64_t maxY;  // Largest y inside
+};
+
+inline bool intersects(const Box& a, const Box& b) {
+    return a.minX <= b.maxX && b.minX <= a.maxX && a.minY <= b.maxY && b.minY <= a.maxY;
+}
+
+inline bool contains(const Box& box, const Point& point) {
+    return box.minX <= point.x && point.x <= box.maxX && box.minY <= point.y && point.y <= box.maxY;
+}
+
+inline Box unite(const Box& a, const Box& b) {
+    return Box{MIN(a.minX, b.minX), MIN(a.minY, b.minY), MAX(a.maxX, b.maxX), MAX(a.maxY, b.maxY)};
+}
+
+/**
+ * Distance from a point to the nearest point of a box.
+ */
+inline double distance(const Box& box, const Point& point) {
+    const int64_t dx = MAX(MAX(box.minX - point.x, int64_t(point.x) - box.maxX), int64_t(0));
+    const int64_t dy = MAX(MAX(box.minY - point.y, int64_t(point.y) - box.maxY), int64_t(0));
+    return std::sqrt(double(dx) * double(dx) + double(dy) * double(dy));
+}
+
+/**
+ * @struct Neighbor
+ * One nearest-neighbour result.
+ */
+struct Neighbor {
+    uint32_t item;  // Index of the shape
+    double distance;  // Distance from the query point; zero when inside
+};
+
+/**
+ * @struct ShapeTraits
+ * What an index needs to know about a shape type.
+ */
+template <typename Shape>
+struct ShapeTraits;
+
+template <>
+struct ShapeTraits<Rectangle> {
+    /**
+     * @return: false for an empty rectangle.
+     */
+    static bool bounds(const Rectangle& r, Box& out) {
+        if (r.width <= 0 || r.height <= 0) return false;
+        out = Box{r.topLeft.x, r.topLeft.y, int64_t(r.topLeft.x) + r.width - 1, int64_t(r.topLeft.y) + r.height - 1};
+        return true;
+    }
+    static bool contains(const Rectangle& r, const Point& p) { return Geometry::contains(r, p); }
+    static bool overlaps(const Rectangle& r, const Rectangle& query) { return Geometry::overlaps(r, query); }
+    static double distance(const Rectangle& r, const Point& p) { return Geometry::distance(r, p); }
+};
+
+template <>
+struct ShapeTraits<Circle> {
+    /**
+     * The box reaches ceil(radius) out from the center, so it covers the
+     * whole disc and box distances never exceed distances to the disc.
+     * @return: false for a negative radius.
+     */
+    static bool bounds(const Circle& c, Box& out) {
+        if (!(c.radius >= 0)) return false;
+        const int64_t reach = int64_t(std::ceil(MIN(c.radius, 8589934592.0)));
+        out = Box{c.center.x - reach, c.center.y - reach, c.center.x + reach, c.center.y + reach};
+        return true;
+    }
+    static bool contains(const Circle& c, const Point& p) { return Geometry::contains(c, p); }
+    static bool overlaps(const Circle& c, const Rectangle& query) { return Geometry::overlaps(c, query); }
+    static double distance(const Circle& c, const Point& p) { return Geometry::distance(c, p); }
+};
+
+/**
+ * @struct BatchResults
+ * Results of a batch of queries, packed: the results of query q are
+ * values[offsets[q] .. offsets[q + 1]).
+ */
+template <typename T>
+struct BatchResults {
+    std::vector<uint32_t> offsets;  // queryCount() + 1 entries
+    std::vector<T> values;  // Results of all queries, in query order
+
+    size_t queryCount() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+    size_t count(size_t query) const { return offsets[query + 1] - offsets[query]; }
+    const T* begin(size_t query) const { return values.data() + offsets[query]; }
+    const T* end(size_t query) const { return values.data() + offsets[query + 1]; }
+};
+
+namespace detail {
+
+/**
+ * Runs fn(query, out) for every query in parallel, each chunk appending
+ * to its own buffer, then packs the buffers in query order.
+ */
+template <typename T, typename F>
+void runBatch(size_t count, BatchResults<T>& results, F&& fn) {
+    const size_t chunks = Parallel::chunkCount(count, SPATIAL_BATCH_MIN_CHUNK);
+    std::vector<std::vector<T>> buffers(chunks);
+    std::vector<size_t> firstQuery(chunks + 1, count);
+    results.offsets.assign(count + 1, 0);
+    Parallel::forChunks(count, SPATIAL_BATCH_MIN_CHUNK, [&](size_t chunk, size_t begin, size_t end) {
+        firstQuery[chunk] = begin;
+        std::vector<T>& out = buffers[chunk];
+        for (size_t q = begin; q < end; ++q) {
+            fn(q, out);
+            results.offsets[q + 1] = uint32_t(out.size());
+        }
+    });
+    size_t total = 0;
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        for (size_t q = firstQuery[chunk]; q < MIN(firstQuery[chunk + 1], count); ++q) {
+            results.offsets[q + 1] += uint32_t(total);
+        }
+        total += buffers[chunk].size();
+    }
+    results.values.clear();
+    results.values.reserve(total);
+    for (const std::vector<T>& buffer : buffers) {
+        results.values.insert(results.values.end(), buffer.begin(), buffer.end());
+    }
+}
+
+/**
+ * Bounds of every shape, computed in parallel.
+ * @param valid: Receives 1 for shapes with bounds, 0 for empty ones.
+ * @return: The union of all valid boxes; minX > maxX when there are none.
+ */
+template <typename Shape>
+Box computeBounds(const std::vector<Shape>& shapes, std::vector<Box>& boxes, std::vector<uint8_t>& valid) {
+    const size_t count = shapes.size();
+    boxes.resize(count);
+    valid.resize(count);
+    const Box none{INT64_MAX, INT64_MAX, INT64_MIN, INT64_MIN};
+    std::vector<Box> partial(Parallel::chunkCount(count, PARALLEL_MIN_CHUNK), none);
+    Parallel::forChunks(count, PARALLEL_MIN_CHUNK, [&](size_t chunk, size_t begin, size_t end) {
+        Box total = none;
+        for (size_t i = begin; i < end; ++i) {
+            valid[i] = ShapeTraits<Shape>::bounds(shapes[i], boxes[i]);
+            if (valid[i]) total = unite(total, boxes[i]);
+        }
+        partial[chunk] = total;
+    });
+    Box total = none;
+    for (const Box& box : partial) total = unite(total, box);
+    return total;
+}
+
+/**
+ * Sorts chunks of [first, last) in parallel, then merges them.
+ */
+template <typename T, typename Less>
+void parallelSort(T* first, T* last, Less less) {
+    const size_t count = size_t(last - first);
+    const size_t chunks = Parallel::chunkCount(count, PARALLEL_MIN_CHUNK);
+    std::vector<size_t> bounds(chunks + 1, count);
+    Parallel::forChunks(count, PARALLEL_MIN_CHUNK, [&](size_t chunk, size_t begin, size_t end) {
+        bounds[chunk] = begin;
+        std::sort(first + begin, first + end, less);
+    });
+    for (size_t chunk = 1; chunk < chunks; ++chunk) {
+        std::inplace_merge(first, first + bounds[chunk], first + bounds[chunk + 1], less);
+    }
+}
+
+}  // namespace detail
+
+/**
+ * @class GridIndex
+ * Uniform grid of square cells over the bounds of the shapes. Cells are
+ * stored packed: the shapes of cell c are cellItems_[cellStart_[c] ..
+ * cellStart_[c + 1]), in index order.
+ */
+template <typename Shape>
+class GridIndex {
+public:
+    GridIndex() : bounds_{0, 0, -1, -1}, cellSize_(1), cellsX_(0), cellsY_(0) {}
+
+    /**
+     * Builds the grid, replacing any previous contents.
+     * @param shapes: The shapes; copied into the index.
+     */
+    void build(const std::vector<Shape>& shapes) {
+        shapes_ = shapes;
+        std::vector<uint8_t> valid;
+        bounds_ = detail::computeBounds(shapes_, boxes_, valid);
+        cellStart_.assign(1, 0);
+        cellItems_.clear();
+        cellsX_ = cellsY_ = 0;
+        if (bounds_.minX > bounds_.maxX) return;
+
+        const double width = double(bounds_.maxX - bounds_.minX + 1);
+        const double height = double(bounds_.maxY - bounds_.minY + 1);
+        const double cells = MAX(1.0, MIN(double(SPATIAL_GRID_MAX_CELLS),
+                                          double(shapes_.size()) / SPATIAL_GRID_ITEMS_PER_CELL));
+        cellSize_ = MAX(int64_t(1), int64_t(std::ceil(std::sqrt(width * height / cells))));
+        while (double(axisCells(width)) * double(axisCells(height)) > SPATIAL_GRID_MAX_CELLS) cellSize_ *= 2;
+        cellsX_ = axisCells(width);
+        cellsY_ = axisCells(height);
+
+        // Count per chunk and cell, so each chunk fills its own slots of
+        // every cell and the order inside a cell stays the index order.
+        const size_t cellCount = cellsX_ * cellsY_;
+        const size_t count = shapes_.size();
+        const size_t chunks = Parallel::chunkCount(count, PARALLEL_MIN_CHUNK);
+        // Offsets are size_t: a shape is listed once per cell it covers, so
+        // a few thousand large shapes can list more than 2^32 entries.
+        std::vector<size_t> slots(chunks * cellCount, 0);
+        Parallel::forChunks(count, PARALLEL_MIN_CHUNK, [&](size_t chunk, size_t begin, size_t end) {
+            size_t* counts = slots.data() + chunk * cellCount;
+            for (size_t i = begin; i < end; ++i) {
+                if (valid[i]) forEachCell(boxes_[i], [counts](size_t cell) { ++counts[cell]; });
+            }
+        });
+        cellStart_.assign(cellCount + 1, 0);
+        size_t total = 0;
+        for (size_t cell = 0; cell < cellCount; ++cell) {
+            cellStart_[cell] = total;
+            for (size_t chunk = 0; chunk < chunks; ++chunk) {
+                const size_t n = slots[chunk * cellCount + cell];
+                slots[chunk * cellCount + cell] = total;
+                total += n;
+            }
+        }
+        cellStart_[cellCount] = total;
+        cellItems_.resize(total);
+        Parallel::forChunks(count, PARALLEL_MIN_CHUNK, [&](size_t chunk, size_t begin, size_t end) {
+            size_t* next = slots.data() + chunk * cellCount;
+            uint32_t* items = cellItems_.data();
+            for (size_t i = begin; i < end; ++i) {
+                if (valid[i]) forEachCell(boxes_[i], [=](size_t cell) { items[next[cell]++] = uint32_t(i); });
+            }
+        });
+    }
+
+    size_t size() const { return shapes_.size(); }
+    const Shape& shape(size_t i) const { return shapes_[i]; }
+    size_t cellsX() const { return cellsX_; }
+    size_t cellsY() const { return cellsY_; }
+
+    /**
+     * Appends the indices of the shapes that contain a point.
+     */
+    void containing(const Point& point, std::vector<uint32_t>& out) const {
+        if (cellsX_ == 0 || !Spatial::contains(bounds_, point)) return;
+        const size_t cell = cellY(point.y) * cellsX_ + cellX(point.x);
+        for (size_t i = cellStart_[cell]; i < cellStart_[cell + 1]; ++i) {
+            const uint32_t item = cellItems_[i];
+            if (ShapeTraits<Shape>::contains(shapes_[item], point)) out.push_back(item);
+        }
+    }
+
+    /**
+     * Appends the indices of the shapes that overlap a rectangle.
+     */
+    void overlapping(const Rectangle& rectangle, std::vector<uint32_t>& out) const {
+        Box query;
+        if (cellsX_ == 0 || !ShapeTraits<Rectangle>::bounds(rectangle, query) || !intersects(query, bounds_)) return;
+        const size_t x0 = cellX(MAX(query.minX, bounds_.minX)), x1 = cellX(MIN(query.maxX, bounds_.maxX));
+        const size_t y0 = cellY(MAX(query.minY, bounds_.minY)), y1 = cellY(MIN(query.maxY, bounds_.maxY));
+        for (size_t cy = y0; cy <= y1; ++cy) {
+            for (size_t cx = x0; cx <= x1; ++cx) {
+                const size_t cell = cy * cellsX_ + cx;
+                for (size_t i = cellStart_[cell]; i < cellStart_[cell + 1]; ++i) {
+                    const uint32_t item = cellItems_[i];
+                    const Box& box = boxes_[item];
+                    if (!intersects(box, query)) continue;
+                    // A shape listed in several cells is reported only from
+                    // the cell holding the low corner of its overlap.
+                    if (cellX(MAX(box.minX, query.minX)) != cx || cellY(MAX(box.minY, query.minY)) != cy) continue;
+                    if (ShapeTraits<Shape>::overlaps(shapes_[item], rectangle)) out.push_back(item);
+                }
+            }
+        }
+    }
+
+    /**
+     * Appends up to k shapes nearest to a point, closest first; ties keep
+     * the lower index. Cells are searched in square rings around the
+     * point until no unsearched shape can be closer than the k-th found.
+     */
+    void nearest(const Point& point, size_t k, std::vector<Neighbor>& out) const {
+        if (cellsX_ == 0 || k == 0) return;
+        std::vector<Neighbor> best;  // Max-heap of the k closest so far
+        best.reserve(k);
+        const int64_t px = MAX(bounds_.minX, MIN(int64_t(point.x), bounds_.maxX));
+        const int64_t py = MAX(bounds_.minY, MIN(int64_t(point.y), bounds_.maxY));
+        const int64_t cx = int64_t(cellX(px)), cy = int64_t(cellY(py));
+        const int64_t lastX = int64_t(cellsX_) - 1, lastY = int64_t(cellsY_) - 1;
+        for (int64_t ring = 0;; ++ring) {
+            for (int64_t y = MAX(cy - ring, int64_t(0)); y <= MIN(cy + ring, lastY); ++y) {
+                if (y == cy - ring || y == cy + ring) {
+                    for (int64_t x = MAX(cx - ring, int64_t(0)); x <= MIN(cx + ring, lastX); ++x) {
+                        visitNearest(size_t(x), size_t(y), point, k, best);
+                    }
+                    continue;
+                }
+                if (cx - ring >= 0) visitNearest(size_t(cx - ring), size_t(y), point, k, best);
+                if (cx + ring <= lastX) visitNearest(size_t(cx + ring), size_t(y), point, k, best);
+            }
+            // Every unsearched shape lies wholly outside the searched
+            // square of cells; its distance is at least the gap to it.
+            double gap = HUGE_VAL;
+            if (cx - ring > 0) gap = MIN(gap, double(point.x) - double(cellLeft(cx - ring) - 1));
+            if (cy - ring > 0) gap = MIN(gap, double(point.y) - double(cellTop(cy - ring) - 1));
+            if (cx + ring < lastX) gap = MIN(gap, double(cellLeft(cx + ring + 1)) - double(point.x));
+            if (cy + ring < lastY) gap = MIN(gap, double(cellTop(cy + ring + 1)) - double(point.y));
+            if (gap == HUGE_VAL) break;
+            if (best.size() == k && gap > best.front().distance) break;
+        }
+        std::sort_heap(best.begin(), best.end(), closer);
+        out.insert(out.end(), best.begin(), best.end());
+    }
+
+    void containing(const Point* points, size_t count, BatchResults<uint32_t>& results) const {
+        detail::runBatch(count, results, [&](size_t q, std::vector<uint32_t>& out) { containing(points[q], out); });
+    }
+
+    void overlapping(const Rectangle* rectangles, size_t count, BatchResults<uint32_t>& results) const {
+        detail::runBatch(count, results,
+                         [&](size_t q, std::vector<uint32_t>& out) { overlapping(rectangles[q], out); });
+    }
+
+    void nearest(const Point* points, size_t count, size_t k, BatchResults<Neighbor>& results) const {
+        detail::runBatch(count, results, [&](size_t q, std::vector<Neighbor>& out) { nearest(points[q], k, out); });
+    }
+
+private:
+    static bool closer(const Neighbor& a, const Neighbor& b) {
+        return a.distance < b.distance || (a.distance == b.distance && a.item < b.item);
+    }
+
+    size_t axisCells(double extent) const { return size_t(std::ceil(extent / double(cellSize_))); }
+    size_t cellX(int64_t x) const { return size_t((x - bounds_.minX) / cellSize_); }
+    size_t cellY(int64_t y) const { return size_t((y - bounds_.minY) / cellSize_); }
+    int64_t cellLeft(int64_t cx) const { return bounds_.minX + cx * cellSize_; }
+    int64_t cellTop(int64_t cy) const { return bounds_.minY + cy * cellSize_; }
+
+    template <typename F>
+    void forEachCell(const Box& box, F&& fn) const {
+        const size_t x0 = cellX(box.minX), x1 = cellX(box.maxX);
+        for (size_t y = cellY(box.minY); y <= cellY(box.maxY); ++y) {
+            for (size_t x = x0; x <= x1; ++x) fn(y * cellsX_ + x);
+        }
+    }
+
+    /**
+     * Offers the shapes of one cell to the heap. A shape is considered
+     * only in the cell of its box point nearest to the query, the first
+     * of its cells the ring search reaches, so none is offered twice.
+     */
+    void visitNearest(size_t x, size_t y, const Point& point, size_t k, std::vector<Neighbor>& best) const {
+        const size_t cell = y * cellsX_ + x;
+        for (size_t i = cellStart_[cell]; i < cellStart_[cell + 1]; ++i) {
+            const uint32_t item = cellItems_[i];
+            const Box& box = boxes_[item];
+            if (cellX(MAX(box.minX, MIN(int64_t(point.x), box.maxX))) != x ||
+                cellY(MAX(box.minY, MIN(int64_t(point.y), box.maxY))) != y) {
+                continue;
+            }
+            const Neighbor candidate{item, ShapeTraits<Shape>::distance(shapes_[item], point)};
+            if (best.size() < k) {
+                best.push_back(candidate);
+                std::push_heap(best.begin(), best.end(), closer);
+            } else if (closer(candidate, best.front())) {
+                std::pop_heap(best.begin(), best.end(), closer);
+                best.back() = candidate;
+                std::push_heap(best.begin(), best.end(), closer);
+            }
+        }
+    }
+
+    std::vector<Shape> shapes_;  // Indexed shapes
+    std::vector<Box> boxes_;  // Bounding box per shape
+    std::vector<size_t> cellStart_;  // Start of each cell in cellItems_, plus the end
+    std::vector<uint32_t> cellItems_;  // Shape indices, grouped by cell
+    Box bounds_;  // Union of all boxes
+    int64_t cellSize_;  // Cell side length
+    size_t cellsX_;  // Cells per row; 0 when empty
+    size_t cellsY_;  // Rows of cells
+};
+
+/**
+ * @class RTree
+ * Static R-tree packed with Sort-Tile-Recursive. nodes_ holds the root
+ * at index 0, then every level in turn; the children of an inner node
+ * are the contiguous nodes [first, first + count), the children of a
+ * leaf the contiguous entries [first, first + count).
+ */
+template <typename Shape>
+class RTree {
+public:
+    RTree() : leafBegin_(0) {}
+
+    /**
+     * Builds the tree, replacing any previous contents.
+     * @param shapes: The shapes; copied into the index.
+     */
+    void build(const std::vector<Shape>& shapes) {
+        shapes_ = shapes;
+        nodes_.clear();
+        entries_.clear();
+        entryBoxes_.clear();
+        leafBegin_ = 0;
+        std::vector<Box> boxes;
+        std::vector<uint8_t> valid;
+        detail::computeBounds(shapes_, boxes, valid);
+
+        // Entries are packed like nodes: first holds the shape index.
+        std::vector<Node> level;
+        level.reserve(shapes_.size());
+        for (size_t i = 0; i < shapes_.size(); ++i) {
+            if (valid[i]) level.push_back(Node{boxes[i], uint32_t(i), 0});
+        }
+        if (level.empty()) return;
+
+        std::vector<std::vector<Node>> levels;  // Leaves first
+        levels.push_back(pack(level));
+        entries_.resize(level.size());
+        entryBoxes_.resize(level.size());
+        for (size_t i = 0; i < level.size(); ++i) {
+            entries_[i] = level[i].first;
+            entryBoxes_[i] = level[i].box;
+        }
+        while (levels.back().size() > 1) {
+            levels.push_back(pack(levels.back()));
+        }
+
+        size_t total = 0;
+        for (const std::vector<Node>& nodes : levels) total += nodes.size();
+        nodes_.reserve(total);
+        for (size_t l = levels.size(); l-- > 0;) {
+            const uint32_t childBase = uint32_t(nodes_.size() + levels[l].size());
+            if (l == 0) leafBegin_ = nodes_.size();
+            for (Node node : levels[l]) {
+                if (l > 0) node.first += childBase;
+                nodes_.push_back(node);
+            }
+        }
+    }
+
+    size_t size() const { return shapes_.size(); }
+    const Shape& shape(size_t i) const { return shapes_[i]; }
+    size_t nodeCount() const { return nodes_.size(); }
+
+    /**
+     * Appends the indices of the shapes that contain a point.
+     */
+    void containing(const Point& point, std::vector<uint32_t>& out) const {
+        search(Box{point.x, point.y, point.x, point.y}, [&](uint32_t item) {
+            if (ShapeTraits<Shape>::contains(shapes_[item], point)) out.push_back(item);
+        });
+    }
+
+    /**
+     * Appends the indices of the shapes that overlap a rectangle.
+     */
+    void overlapping(const Rectangle& rectangle, std::vector<uint32_t>& out) const {
+        Box query;
+        if (!ShapeTraits<Rectangle>::bounds(rectangle, query)) return;
+        search(query, [&](uint32_t item) {
+            if (ShapeTraits<Shape>::overlaps(shapes_[item], rectangle)) out.push_back(item);
+        });
+    }
+
+    /**
+     * Appends up to k shapes nearest to a point, closest first; ties keep
+     * the lower index. Best-first search: nodes and shapes share one
+     * queue ordered by distance, and a shape that reaches the front is
+     * closer than anything still queued.
+     */
+    void nearest(const Point& point, size_t k, std::vector<Neighbor>& out) const {
+        if (nodes_.empty() || k == 0) return;
+        struct Pending {
+            double distance;  // Lower bound for nodes, exact for shapes
+            uint32_t index;  // Node index, or shape index
+            bool isShape;  // Whether index names a shape
+        };
+        auto later = [](const Pending& a, const Pending& b) {
+            if (a.distance != b.distance) return a.distance > b.distance;
+            if (a.isShape != b.isShape) return a.isShape;  // Expand nodes before emitting ties
+            return a.index > b.index;
+        };
+        std::vector<Pending> queue;
+        queue.push_back(Pending{distance(nodes_[0].box, point), 0, false});
+        size_t found = 0;
+        while (!queue.empty() && found < k) {
+            std::pop_heap(queue.begin(), queue.end(), later);
+            const Pending next = queue.back();
+            queue.pop_back();
+            if (next.isShape) {
+                out.push_back(Neighbor{next.index, next.distance});
+                ++found;
+                continue;
+            }
+            const Node& node = nodes_[next.index];
+            for (uint32_t c = node.first; c < node.first + node.count; ++c) {
+                if (next.index >= leafBegin_) {
+                    const uint32_t item = entries_[c];
+                    queue.push_back(Pending{ShapeTraits<Shape>::distance(shapes_[item], point), item, true});
+                } else {
+                    queue.push_back(Pending{distance(nodes_[c].box, point), c, false});
+                }
+                std::push_heap(queue.begin(), queue.end(), later);
+            }
+        }
+    }
+
+    void containing(const Point* points, size_t count, BatchResults<uint32_t>& results) const {
+        detail::runBatch(count, results, [&](size_t q, std::vector<uint32_t>& out) { containing(points[q], out); });
+    }
+
+    void overlapping(const Rectangle* rectangles, size_t count, BatchResults<uint32_t>& results) const {
+        detail::runBatch(count, results,
+                         [&](size_t q, std::vector<uint32_t>& out) { overlapping(rectangles[q], out); });
+    }
+
+    void nearest(const Point* points, size_t count, size_t k, BatchResults<Neighbor>& results) const {
+        detail::runBatch(count, results, [&](size_t q, std::vector<Neighbor>& out) { nearest(points[q], k, out); });
+    }
+
+private:
+    struct Node {
+        Box box;  // Union of the children's boxes
+        uint32_t first;  // First child node or entry
+        uint32_t count;  // Number of children
+    };
+
+    /**
+     * Sort-Tile-Recursive: sorts a level by box center x, cuts it into
+     * vertical slabs of whole parents, sorts each slab by center y and
+     * groups consecutive runs into parents.
+     * @param level: Reordered in place so every parent's children are
+     *               contiguous.
+     * @return: The parents, their first fields indexing into level.
+     */
+    static std::vector<Node> pack(std::vector<Node>& level) {
+        const size_t count = level.size();
+        const size_t parents = (count + SPATIAL_RTREE_NODE_CAPACITY - 1) / SPATIAL_RTREE_NODE_CAPACITY;
+        const size_t slabs = size_t(std::ceil(std::sqrt(double(parents))));
+        const size_t slabSize = ((parents + slabs - 1) / slabs) * SPATIAL_RTREE_NODE_CAPACITY;
+        detail::parallelSort(level.data(), level.data() + count, [](const Node& a, const Node& b) {
+            return a.box.minX + a.box.maxX < b.box.minX + b.box.maxX;
+        });
+        Node* nodes = level.data();
+        const size_t slabCount = (count + slabSize - 1) / slabSize;
+        Parallel::forChunks(slabCount, 1, [=](size_t, size_t begin, size_t end) {
+            for (size_t slab = begin; slab < end; ++slab) {
+                std::sort(nodes + slab * slabSize, nodes + MIN((slab + 1) * slabSize, count),
+                          [](const Node& a, const Node& b) { return a.box.minY + a.box.maxY < b.box.minY + b.box.maxY; });
+            }
+        });
+        std::vector<Node> result(parents);
+        Parallel::forChunks(parents, PARALLEL_MIN_CHUNK / SPATIAL_RTREE_NODE_CAPACITY,
+                            [&](size_t, size_t begin, size_t end) {
+            for (size_t p = begin; p < end; ++p) {
+                // Slabs hold whole parents, so groups never straddle two.
+                const size_t first = p * SPATIAL_RTREE_NODE_CAPACITY;
+                const size_t last = MIN(first + SPATIAL_RTREE_NODE_CAPACITY, count);
+                Box box = nodes[first].box;
+                for (size_t c = first + 1; c < last; ++c) box = unite(box, nodes[c].box);
+                result[p] = Node{box, uint32_t(first), uint32_t(last - first)};
+            }
+        });
+        return result;
+    }
+
+    /**
+     * Calls fn with every shape whose box intersects a query box.
+     */
+    template <typename F>
+    void search(const Box& query, F&& fn) const {
+        if (nodes_.empty() || !intersects(nodes_[0].box, query)) return;
+        // Depth is at most 8 for 2^32 shapes; each level adds at most
+        // one node's children to the stack.
+        uint32_t stack[8 * SPATIAL_RTREE_NODE_CAPACITY + 1];
+        size_t top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const uint32_t index = stack[--top];
+            const Node& node = nodes_[index];
+            if (index >= leafBegin_) {
+                for (uint32_t e = node.first; e < node.first + node.count; ++e) {
+                    if (intersects(entryBoxes_[e], query)) fn(entries_[e]);
+                }
+                continue;
+            }
+            for (uint32_t c = node.first + node.count; c-- > node.first;) {
+                if (intersects(nodes_[c].box, query)) stack[top++] = c;
+            }
+        }
+    }
+
+    std::vector<Shape> shapes_;  // Indexed shapes
+    std::vector<Node> nodes_;  // Root first, then each level
+    std::vector<uint32_t> entries_;  // Shape indices in leaf order
+    std::vector<Box> entryBoxes_;  // Bounding boxes in leaf order
+    size_t leafBegin_;  // Index of the first leaf in nodes_
+};
+
+}  // namespace Spatial
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: Spatial Benchmark
+ * Times both indexes against a brute force scan on random data and
+ * checks that all three agree.
+ ***************************************/
+
+namespace UniqueBuild {
+
+namespace Spatial {
+
+/**
+ * @struct BenchmarkReport
+ * Milliseconds per phase; queries are timed as one batch each.
+ */
+struct BenchmarkReport {
+    size_t shapes;  // Number of shapes indexed
+    size_t queries;  // Queries per kind
+    double gridBuildMs;  // GridIndex::build
+    double treeBuildMs;  // RTree::build
+    double bruteContainingMs, gridContainingMs, treeContainingMs;  // Point queries
+    double bruteOverlappingMs, gridOverlappingMs, treeOverlappingMs;  // Rectangle queries
+    double bruteNearestMs, gridNearestMs, treeNearestMs;  // k-nearest queries
+    bool agrees;  // Whether all three returned the same results
+};
+
+namespace detail {
+
+inline Rectangle randomShape(Random::Xoshiro256pp& engine, int world, int size, Rectangle*) {
+    return Rectangle{Point{Random::uniformInt(engine, 0, world), Random::uniformInt(engine, 0, world)},
+                     Random::uniformInt(engine, 1, size), Random::uniformInt(engine, 1, size)};
+}
+
+inline Circle randomShape(Random::Xoshiro256pp& engine, int world, int size, Circle*) {
+    return Circle{Point{Random::uniformInt(engine, 0, world), Random::uniformInt(engine, 0, world)},
+                  Random::uniformDouble(engine) * size / 2};
+}
+
+inline double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Sorts each query's results so index results compare to brute force.
+ */
+inline void sortResults(BatchResults<uint32_t>& results) {
+    for (size_t q = 0; q < results.queryCount(); ++q) {
+        std::sort(results.values.begin() + results.offsets[q], results.values.begin() + results.offsets[q + 1]);
+    }
+}
+
+inline bool sameNeighbors(const BatchResults<Neighbor>& a, const BatchResults<Neighbor>& b) {
+    if (a.offsets != b.offsets) return false;
+    for (size_t i = 0; i < a.values.size(); ++i) {
+        if (a.values[i].item != b.values[i].item || a.values[i].distance != b.values[i].distance) return false;
+    }
+    return true;
+}
+
+}  // namespace detail
+
+/**
+ * Builds both indexes over random shapes and runs point, rectangle and
+ * k-nearest batches on each and on a brute force scan.
+ * @param shapeCount: Number of random shapes.
+ * @param queryCount: Number of queries of each kind.
+ * @param k: Neighbours per nearest query.
+ * @param seed: Seed of the random data.
+ */
+template <typename Shape>
+BenchmarkReport benchmark(size_t shapeCount, size_t queryCount, size_t k = 8, uint64_t seed = 1) {
+    typedef std::chrono::steady_clock Clock;
+    const int world = 1 << 20;
+    const int size = int(MAX(4.0, 2.0 * world / std::sqrt(double(MAX(shapeCount, size_t(1))))));
+    Random::Xoshiro256pp engine(seed);
+    std::vector<Shape> shapes(shapeCount);
+    for (Shape& shape : shapes) shape = detail::randomShape(engine, world, size, static_cast<Shape*>(nullptr));
+    std::vector<Point> points(queryCount);
+    std::vector<Rectangle> rectangles(queryCount);
+    for (size_t q = 0; q < queryCount; ++q) {
+        points[q] = Point{Random::uniformInt(engine, 0, world), Random::uniformInt(engine, 0, world)};
+        rectangles[q] = detail::randomShape(engine, world, 4 * size, static_cast<Rectangle*>(nullptr));
+    }
+
+    BenchmarkReport report = {};
+    report.shapes = shapeCount;
+    report.queries = queryCount;
+    Clock::time_point start = Clock::now();
+    GridIndex<Shape> grid;
+    grid.build(shapes);
+    report.gridBuildMs = detail::elapsedMs(start);
+    start = Clock::now();
+    RTree<Shape> tree;
+    tree.build(shapes);
+    report.treeBuildMs = detail::elapsedMs(start);
+
+    BatchResults<uint32_t> brute, byGrid, byTree;
+    start = Clock::now();
+    detail::runBatch(queryCount, brute, [&](size_t q, std::vector<uint32_t>& out) {
+        for (size_t i = 0; i < shapes.size(); ++i) {
+            if (ShapeTraits<Shape>::contains(shapes[i], points[q])) out.push_back(uint32_t(i));
+        }
+    });
+    report.bruteContainingMs = detail::elapsedMs(start);
+    start = Clock::now();
+    grid.containing(points.data(), queryCount, byGrid);
+    report.gridContainingMs = detail::elapsedMs(start);
+    start = Clock::now();
+    tree.containing(points.data(), queryCount, byTree);
+    report.treeContainingMs = detail::elapsedMs(start);
+    detail::sortResults(byTree);
+    bool agrees = brute.offsets == byGrid.offsets && brute.values == byGrid.values &&
+                  brute.offsets == byTree.offsets && brute.values == byTree.values;
+
+    start = Clock::now();
+    detail::runBatch(queryCount, brute, [&](size_t q, std::vector<uint32_t>& out) {
+        for (size_t i = 0; i < shapes.size(); ++i) {
+            if (ShapeTraits<Shape>::overlaps(shapes[i], rectangles[q])) out.push_back(uint32_t(i));
+        }
+    });
+    report.bruteOverlappingMs = detail::elapsedMs(start);
+    start = Clock::now();
+    grid.overlapping(rectangles.data(), queryCount, byGrid);
+    report.gridOverlappingMs = detail::elapsedMs(start);
+    start = Clock::now();
+    tree.overlapping(rectangles.data(), queryCount, byTree);
+    report.treeOverlappingMs = detail::elapsedMs(start);
+    detail::sortResults(byGrid);
+    detail::sortResults(byTree);
+    agrees = agrees && brute.offsets == byGrid.offsets && brute.values == byGrid.values &&
+             brute.offsets == byTree.offsets && brute.values == byTree.values;
+
+    BatchResults<Neighbor> nearBrute, nearGrid, nearTree;
+    start = Clock::now();
+    detail::runBatch(queryCount, nearBrute, [&](size_t q, std::vector<Neighbor>& out) {
+        const size_t first = out.size();
+        for (size_t i = 0; i < shapes.size(); ++i) {
+            const double d = ShapeTraits<Shape>::distance(shapes[i], points[q]);
+            if (d != HUGE_VAL) out.push_back(Neighbor{uint32_t(i), d});
+        }
+        const size_t keep = MIN(k, out.size() - first);
+        std::partial_sort(out.begin() + first, out.begin() + first + keep, out.end(),
+                          [](const Neighbor& a, const Neighbor& b) {
+            return a.distance < b.distance || (a.distance == b.distance && a.item < b.item);
+        });
+        out.resize(first + keep);
+    });
+    report.bruteNearestMs = detail::elapsedMs(start);
+    start = Clock::now();
+    grid.nearest(points.data(), queryCount, k, nearGrid);
+    report.gridNearestMs = detail::elapsedMs(start);
+    start = Clock::now();
+    tree.nearest(points.data(), queryCount, k, nearTree);
+    report.treeNearestMs = detail::elapsedMs(start);
+    report.agrees = agrees && detail::sameNeighbors(nearBrute, nearGrid) && detail::sameNeighbors(nearBrute, nearTree);
+    return report;
+}
+
+/**
+ * Logs a benchmark report as one line per query kind.
+ */
+inline void logBenchmark(const BenchmarkReport& report) {
+    char line[256];
+    snprintf(line, sizeof(line), "spatial: %zu shapes, %zu queries; build grid %.1f ms, tree %.1f ms",
+             report.shapes, report.queries, report.gridBuildMs, report.treeBuildMs);
+    LOG_INFO(line);
+    snprintf(line, sizeof(line), "spatial: containing brute %.1f ms, grid %.1f ms, tree %.1f ms",
+             report.bruteContainingMs, report.gridContainingMs, report.treeContainingMs);
+    LOG_INFO(line);
+    snprintf(line, sizeof(line), "spatial: overlapping brute %.1f ms, grid %.1f ms, tree %.1f ms",
+             report.bruteOverlappingMs, report.gridOverlappingMs, report.treeOverlappingMs);
+    LOG_INFO(line);
+    snprintf(line, sizeof(line), "spatial: nearest brute %.1f ms, grid %.1f ms, tree %.1f ms",
+             report.bruteNearestMs, report.gridNearestMs, report.treeNearestMs);
+    LOG_INFO(line);
+    if (!report.agrees) LOG_ERROR("spatial: index results differ from brute force");
+}
+
+}  // namespace Spatial
+
+}  // namespace UniqueBuild
+
+#endif  // UNIQUEBUILD_SPATIAL_H
@@ -0,0 +1,593 @@
+/***************************************
+ * uniquebuild_strings.h
+ * Locale-independent number parsing and string helpers, including
+ * allocation-free variants that write into caller buffers or an Arena.
+ *
+ * Part of uniquebuild; see uniquebuild.h.
+ ***************************************/
+
+#ifndef UNIQUEBUILD_STRINGS_H
+#define UNIQUEBUILD_STRINGS_H
+
+#include "uniquebuild_core.h"
+
+#include <algorithm>    // Required for std::reverse_copy
+#include <charconv>     // Required for std::from_chars
+
+/***************************************
+ * SECTION: Number Parsing
+ * Locale-independent, non-throwing parsers in the style of std::from_chars.
+ * They take a std::string_view, report a status and the number of
+ * characters consumed, and never allocate. Runs of eight digits are
+ * validated and converted at once with SWAR (SIMD within a register).
+ ***************************************/
+
+namespace UniqueBuild {
+
+/**
+ * @namespace Parse
+ * Integer and floating-point parsing plus bulk extraction from buffers.
+ */
+namespace Parse {
+
+/**
+ * @enum ParseStatus
+ * Outcome of a parse call.
+ */
+enum class ParseStatus {
+    PARSE_OK,  // A number was parsed and stored
+    PARSE_INVALID,  // The input does not start with a number; nothing consumed
+    PARSE_OUT_OF_RANGE  // The number does not fit the target type; value left unchanged
+};
+
+/**
+ * @struct ParseResult
+ * Status of a parse and how many characters of the input it consumed.
+ * On PARSE_OUT_OF_RANGE, consumed still covers the whole number.
+ */
+struct ParseResult {
+    ParseStatus status;  // Outcome of the parse
+    size_t consumed;  // Number of characters that form the number
+
+    bool ok() const { return status == ParseStatus::PARSE_OK; }
+};
+
+namespace detail {
+
+inline bool isDigit(char c) {
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ || defined(_WIN32)
+#define UNIQUEBUILD_PARSE_SWAR 1
+#endif
+
+#ifdef UNIQUEBUILD_PARSE_SWAR
+inline uint64_t load8(const char* p) {
+    uint64_t chunk;
+    std::memcpy(&chunk, p, sizeof(chunk));
+    return chunk;
+}
+
+/**
+ * True if all eight bytes of chunk are ASCII digits.
+ */
+inline bool isEightDigits(uint64_t chunk) {
+    return ((chunk & 0xF0F0F0F0F0F0F0F0ull) |
+            (((chunk + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) == 0x3333333333333333ull;
+}
+
+/**
+ * Converts eight ASCII digits (first digit in the lowest byte) to their value.
+ */
+inline uint32_t parseEightDigits(uint64_t chunk) {
+    chunk -= 0x3030303030303030ull;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & 0x000000FF000000FFull) * (100 + (1000000ull << 32))) +
+             (((chunk >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32;
+    return static_cast<uint32_t>(chunk);
+}
+#endif
+
+/**
+ * Accumulates the digit run starting at p into value.
+ * The first sixteen digits go through the eight-at-a-time path, which
+ * cannot overflow; the rest are checked one at a time.
+ * @return: Pointer past the last digit.
+ */
+inline const char* parseDigits(const char* p, const char* end, uint64_t& value, bool& overflow) {
+    uint64_t v = 0;
+#ifdef UNIQUEBUILD_PARSE_SWAR
+    for (int block = 0; block < 2 && end - p >= 8; ++block) {
+        const uint64_t chunk = load8(p);
+        if (!isEightDigits(chunk)) break;
+        v = v * 100000000ull + parseEightDigits(chunk);
+        p += 8;
+    }
+#endif
+    for (; p < end && isDigit(*p); ++p) {
+        const uint64_t digit = static_cast<uint64_t>(*p - '0');
+        if (v > (~uint64_t(0) - digit) / 10) {
+            overflow = true;
+        } else {
+            v = v * 10 + digit;
+        }
+    }
+    value = v;
+    return p;
+}
+
+template<typename T>
+ParseResult parseSigned(std::string_view text, T& value) {
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+    const char* p = begin;
+    const bool negative = p < end && *p == '-';
+    if (negative) ++p;
+    if (p == end || !isDigit(*p)) return {ParseStatus::PARSE_INVALID, 0};
+    uint64_t magnitude = 0;
+    bool overflow = false;
+    p = parseDigits(p, end, magnitude, overflow);
+    const uint64_t limit = static_cast<uint64_t>(std::numeric_limits<T>::max()) + (negative ? 1u : 0u);
+    if (overflow || magnitude > limit) return {ParseStatus::PARSE_OUT_OF_RANGE, size_t(p - begin)};
+    value = negative ? static_cast<T>(0 - magnitude) : static_cast<T>(magnitude);
+    return {ParseStatus::PARSE_OK, size_t(p - begin)};
+}
+
+}  // namespace detail
+
+/**
+ * Parses a 32-bit signed integer: an optional '-' followed by decimal digits.
+ * No whitespace or '+' is accepted, matching std::from_chars.
+ * @param text: The input; parsing stops at the first non-digit.
+ * @param value: Receives the number on PARSE_OK, untouched otherwise.
+ * @return: Status and characters consumed.
+ */
+inline ParseResult parseInt32(std::string_view text, int32_t& value) {
+    return detail::parseSigned(text, value);
+}
+
+/**
+ * Parses a 64-bit signed integer. See parseInt32.
+ */
+inline ParseResult parseInt64(std::string_view text, int64_t& value) {
+    return detail::parseSigned(text, value);
+}
+
+/**
+ * Parses a 64-bit unsigned integer; a leading '-' is invalid. See parseInt32.
+ */
+inline ParseResult parseUint64(std::string_view text, uint64_t& value) {
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+    if (begin == end || !detail::isDigit(*begin)) return {ParseStatus::PARSE_INVALID, 0};
+    uint64_t result = 0;
+    bool overflow = false;
+    const char* p = detail::parseDigits(begin, end, result, overflow);
+    if (overflow) return {ParseStatus::PARSE_OUT_OF_RANGE, size_t(p - begin)};
+    value = result;
+    return {ParseStatus::PARSE_OK, size_t(p - begin)};
+}
+
+/**
+ * Parses a double: [-]digits[.digits][(e|E)[+|-]digits], plus "inf" and
+ * "nan" where std::from_chars supports floating point.
+ * Values with at most 19 significant digits whose mantissa fits in 53 bits
+ * and whose decimal exponent is within +-22 are computed exactly with one
+ * multiply or divide; everything else is handed to std::from_chars, which
+ * is also locale-independent.
+ * @param text: The input.
+ * @param value: Receives the number on PARSE_OK, untouched otherwise.
+ * @return: Status and characters consumed.
+ */
+inline ParseResult parseDouble(std::string_view text, double& value) {
+    static const double powersOfTen[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+    const char* p = begin;
+    const bool negative = p < end && *p == '-';
+    if (negative) ++p;
+
+    uint64_t mantissa = 0;
+    bool overflow = false;
+    const char* intStart = p;
+    p = detail::parseDigits(p, end, mantissa, overflow);
+    size_t digits = size_t(p - intStart);
+    int64_t exponent = 0;
+    if (p < end && *p == '.') {
+        const char* fracStart = ++p;
+        uint64_t fraction = 0;
+        p = detail::parseDigits(p, end, fraction, overflow);
+        const size_t fracDigits = size_t(p - fracStart);
+        if (digits + fracDigits <= 19) {
+            uint64_t scale = 1;
+            for (size_t i = 0; i < fracDigits; ++i) scale *= 10;
+            mantissa = mantissa * scale + fraction;
+        } else {
+            overflow = true;  // Too many digits to combine exactly; from_chars handles it below
+        }
+        exponent -= static_cast<int64_t>(fracDigits);
+        digits += fracDigits;
+    }
+    if (digits == 0) {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        double parsed;
+        const auto r = std::from_chars(begin, end, parsed);
+        if (r.ec != std::errc()) return {ParseStatus::PARSE_INVALID, 0};
+        value = parsed;
+        return {ParseStatus::PARSE_OK, size_t(r.ptr - begin)};
+#else
+        return {ParseStatus::PARSE_INVALID, 0};
+#endif
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        bool negativeExponent = false;
+        if (q < end && (*q == '+' || *q == '-')) negativeExponent = (*q++ == '-');
+        if (q < end && detail::isDigit(*q)) {
+            int64_t e = 0;
+            for (; q < end && detail::isDigit(*q); ++q) {
+                if (e < 100000) e = e * 10 + (*q - '0');
+            }
+            exponent += negativeExponent ? -e : e;
+            p = q;
+        }
+    }
+    const size_t consumed = size_t(p - begin);
+    if (!overflow && digits <= 19 && mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+        double result = static_cast<double>(mantissa);
+        result = exponent < 0 ? result / powersOfTen[-exponent] : result * powersOfTen[exponent];
+        value = negative ? -result : result;
+        return {ParseStatus::PARSE_OK, consumed};
+    }
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    double parsed;
+    const auto r = std::from_chars(begin, end, parsed);
+    if (r.ec == std::errc::result_out_of_range) return {ParseStatus::PARSE_OUT_OF_RANGE, consumed};
+    if (r.ec != std::errc()) return {ParseStatus::PARSE_INVALID, 0};
+    value = parsed;
+    return {ParseStatus::PARSE_OK, size_t(r.ptr - begin)};
+#else
+    char buffer[BUFFER_SIZE_512];
+    if (consumed >= sizeof(buffer)) return {ParseStatus::PARSE_OUT_OF_RANGE, consumed};
+    std::memcpy(buffer, begin, consumed);
+    buffer[consumed] = '\0';
+    const double parsed = std::strtod(buffer, nullptr);  // Assumes the "C" locale
+    if (std::isinf(parsed)) return {ParseStatus::PARSE_OUT_OF_RANGE, consumed};
+    value = parsed;
+    return {ParseStatus::PARSE_OK, consumed};
+#endif
+}
+
+/**
+ * Extracts every integer from a buffer in one pass.
+ * Anything that is not a digit, or a '-' directly followed by a digit,
+ * is treated as a delimiter. Numbers that overflow int64_t are skipped.
+ * @param buffer: The text to scan, e.g. a whole log file.
+ * @param out: Receives the numbers in order of appearance (appended).
+ * @return: Number of values appended.
+ */
+inline size_t extractNumbers(std::string_view buffer, std::vector<int64_t>& out) {
+    const size_t before = out.size();
+    const char* p = buffer.data();
+    const char* end = p + buffer.size();
+    while (p < end) {
+        if (!detail::isDigit(*p) && !(*p == '-' && p + 1 < end && detail::isDigit(p[1]))) {
+            ++p;
+            continue;
+        }
+        int64_t value;
+        const ParseResult r = parseInt64(std::string_view(p, size_t(end - p)), value);
+        if (r.ok()) out.push_back(value);
+        p += r.consumed;
+    }
+    return out.size() - before;
+}
+
+/**
+ * Extracts every decimal number, including fractions and exponents,
+ * from a buffer in one pass. See the int64_t overload for the delimiter rules.
+ * @param buffer: The text to scan.
+ * @param out: Receives the numbers in order of appearance (appended).
+ * @return: Number of values appended.
+ */
+inline size_t extractNumbers(std::string_view buffer, std::vector<double>& out) {
+    const size_t before = out.size();
+    const char* p = buffer.data();
+    const char* end = p + buffer.size();
+    while (p < end) {
+        if (!detail::isDigit(*p) && !(*p == '-' && p + 1 < end && detail::isDigit(p[1]))) {
+            ++p;
+            continue;
+        }
+        double value;
+        const ParseResult r = parseDouble(std::string_view(p, size_t(end - p)), value);
+        if (r.ok()) out.push_back(value);
+        p += r.consumed ? r.consumed : 1;
+    }
+    return out.size() - before;
+}
+
+}  // namespace Parse
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: Function Declarations
+ * This section contains declarations for various functions
+ * used throughout the project.
+ ***************************************/
+
+/**
+ * Converts a string to uppercase.
+ * @param str: The input string.
+ * @return: The converted uppercase string.
+ */
+std::string toUpperCase(const std::string& str);
+
+/***************************************
+ * SECTION: Helper Functions
+ * These functions assist in performing smaller, modular tasks
+ * that are often reused across the application.
+ ***************************************/
+
+/**
+ * Helper function to check if a string is a palindrome.
+ * @param str: The input string.
+ * @return: True if the string is a palindrome, false otherwise.
+ */
+bool isPalindrome(const std::string& str);
+
+/**
+ * Helper function to convert a string to an integer without throwing.
+ * Locale-independent; see UniqueBuild::Parse::parseInt32.
+ * @param str: The input string; it must be a complete number.
+ * @param value: Receives the integer on success.
+ * @return: True if the whole string is a valid int, false otherwise.
+ */
+inline bool stringToInt(std::string_view str, int& value) {
+    int32_t parsed;
+    const UniqueBuild::Parse::ParseResult r = UniqueBuild::Parse::parseInt32(str, parsed);
+    if (!r.ok() || r.consumed != str.size()) return false;
+    value = parsed;
+    return true;
+}
+
+/**
+ * Helper function to convert a string to an integer.
+ * Accepts the same input as std::stoi (leading whitespace, an optional sign,
+ * trailing characters ignored) but parses without the locale.
+ * @param str: The input string.
+ * @return: The integer representation of the string.
+ * @throws std::invalid_argument if no number is found, std::out_of_range if it does not fit in an int.
+ */
+int stringToInt(const std::string& str);
+
+/***************************************
+ * SECTION: Utility Functions
+ * These functions are general-purpose utilities that are commonly
+ * used across various parts of the program.
+ ***************************************/
+
+/**
+ * Utility function to trim whitespace from both ends of a string.
+ * @param str: The input string.
+ * @return: The trimmed string.
+ */
+std::string trim(const std::string& str);
+
+/**
+ * Allocation-free variant of trim: returns a view into the input.
+ * @param str: The input string; the result is valid as long as it is.
+ * @return: The trimmed view.
+ */
+inline std::string_view trimView(std::string_view str) {
+    const auto strBegin = str.find_first_not_of(' ');
+    const auto strEnd = str.find_last_not_of(' ');
+    return (strBegin == std::string_view::npos) ? std::string_view() : str.substr(strBegin, strEnd - strBegin + 1);
+}
+
+/**
+ * Utility function to convert a string to lowercase.
+ * @param str: The input string.
+ * @return: The lowercase string.
+ */
+std::string toLowerCase(const std::string& str);
+
+/**
+ * Variant of toLowerCase that writes into a caller buffer.
+ * @param str: The input string.
+ * @param out: Destination with room for str.size() characters.
+ * @return: A view of the str.size() characters written to out.
+ */
+inline std::string_view toLowerCase(std::string_view str, char* out) {
+    for (size_t i = 0; i < str.size(); ++i) {
+        out[i] = static_cast<char>(TO_LOWER(str[i]));
+    }
+    return std::string_view(out, str.size());
+}
+
+/**
+ * Variant of toLowerCase that writes into arena memory.
+ * @param str: The input string.
+ * @param arena: The arena to allocate the result from.
+ * @return: A NUL-terminated view of the result, owned by the arena.
+ */
+inline std::string_view toLowerCase(std::string_view str, UniqueBuild::Arena& arena) {
+    char* out = arena.allocateArray<char>(str.size() + 1);
+    out[str.size()] = '\0';
+    return toLowerCase(str, out);
+}
+
+/**
+ * Utility function to convert a string to uppercase.
+ * @param str: The input string.
+ * @return: The uppercase string.
+ */
+std::string toUpperCase(const std::string& str);
+
+/**
+ * Variant of toUpperCase that writes into a caller buffer.
+ * @param str: The input string.
+ * @param out: Destination with room for str.size() characters.
+ * @return: A view of the str.size() characters written to out.
+ */
+inline std::string_view toUpperCase(std::string_view str, char* out) {
+    for (size_t i = 0; i < str.size(); ++i) {
+        out[i] = static_cast<char>(TO_UPPER(str[i]));
+    }
+    return std::string_view(out, str.size());
+}
+
+/**
+ * Variant of toUpperCase that writes into arena memory.
+ * @param str: The input string.
+ * @param arena: The arena to allocate the result from.
+ * @return: A NUL-terminated view of the result, owned by the arena.
+ */
+inline std::string_view toUpperCase(std::string_view str, UniqueBuild::Arena& arena) {
+    char* out = arena.allocateArray<char>(str.size() + 1);
+    out[str.size()] = '\0';
+    return toUpperCase(str, out);
+}
+
+/**
+ * Utility function to reverse a string.
+ * @param str: The input string.
+ * @return: The reversed string.
+ */
+std::string reverseString(const std::string& str);
+
+/**
+ * Variant of reverseString that writes into a caller buffer.
+ * @param str: The input string.
+ * @param out: Destination with room for str.size() characters; must not overlap str.
+ * @return: A view of the str.size() characters written to out.
+ */
+inline std::string_view reverseString(std::string_view str, char* out) {
+    std::reverse_copy(str.begin(), str.end(), out);
+    return std::string_view(out, str.size());
+}
+
+/**
+ * Variant of reverseString that writes into arena memory.
+ * @param str: The input string.
+ * @param arena: The arena to allocate the result from.
+ * @return: A NUL-terminated view of the result, owned by the arena.
+ */
+inline std::string_view reverseString(std::string_view str, UniqueBuild::Arena& arena) {
+    char* out = arena.allocateArray<char>(str.size() + 1);
+    out[str.size()] = '\0';
+    return reverseString(str, out);
+}
+
+/**
+ * Utility function to split a string by a delimiter.
+ * @param str: The input string.
+ * @param delimiter: The delimiter character.
+ * @return: A vector of split strings.
+ */
+std::vector<std::string> splitString(const std::string& str, char delimiter);
+
+/**
+ * Allocation-free variant of splitString: the pieces are views into the
+ * input, and out keeps its capacity between calls. Produces the same
+ * pieces as the std::string version.
+ * @param str: The input string; the views are valid as long as it is.
+ * @param delimiter: The delimiter character.
+ * @param out: Cleared, then filled with the pieces.
+ * @return: Number of pieces.
+ */
+inline size_t splitString(std::string_view str, char delimiter, std::vector<std::string_view>& out) {
+    out.clear();
+    size_t start = 0;
+    while (start < str.size()) {
+        const size_t end = str.find(delimiter, start);
+        if (end == std::string_view::npos) {
+            out.push_back(str.substr(start));
+            break;
+        }
+        out.push_back(str.substr(start, end - start));
+        start = end + 1;
+    }
+    return out.size();
+}
+
+#endif  // UNIQUEBUILD_STRINGS_H
+
+
+/***************************************
+ * Out-of-line definitions, compiled in the one translation unit that
+ * defines UNIQUEBUILD_IMPLEMENTATION before including this header.
+ ***************************************/
+
+#if defined(UNIQUEBUILD_IMPLEMENTATION) && !defined(UNIQUEBUILD_STRINGS_IMPLEMENTED)
+#define UNIQUEBUILD_STRINGS_IMPLEMENTED
+
+#include <cctype>       // Required for std::isspace, ::tolower, ::toupper
+#include <stdexcept>    // Required for std::invalid_argument, std::out_of_range
+#include <sstream>      // Required for std::stringstream
+
+bool isPalindrome(const std::string& str) {
+    int length = str.length();
+    for (int i = 0; i < length / 2; ++i) {
+        if (str[i] != str[length - i - 1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int stringToInt(const std::string& str) {
+    std::string_view text(str);
+    size_t start = 0;
+    while (start < text.size() && std::isspace(static_cast<unsigned char>(text[start]))) ++start;
+    if (start < text.size() && text[start] == '+') {
+        ++start;
+        // parseInt32 takes its own '-', which must not follow a '+'.
+        if (start < text.size() && text[start] == '-') throw std::invalid_argument("stringToInt");
+    }
+    int32_t value;
+    const UniqueBuild::Parse::ParseResult r = UniqueBuild::Parse::parseInt32(text.substr(start), value);
+    if (r.status == UniqueBuild::Parse::ParseStatus::PARSE_INVALID) throw std::invalid_argument("stringToInt");
+    if (r.status == UniqueBuild::Parse::ParseStatus::PARSE_OUT_OF_RANGE) throw std::out_of_range("stringToInt");
+    return value;
+}
+
+std::string trim(const std::string& str) {
+    const auto strBegin = str.find_first_not_of(' ');
+    const auto strEnd = str.find_last_not_of(' ');
+    return (strBegin == std::string::npos) ? "" : str.substr(strBegin, strEnd - strBegin + 1);
+}
+
+std::string toLowerCase(const std::string& str) {
+    std::string result = str;
+    std::transform(result.begin(), result.end(), result.begin(), ::tolower);
+    return result;
+}
+
+std::string toUpperCase(const std::string& str) {
+    std::string result = str;
+    std::transform(result.begin(), result.end(), result.begin(), ::toupper);
+    return result;
+}
+
+std::string reverseString(const std::string& str) {
+    std::string result = str;
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+
+std::vector<std::string> splitString(const std::string& str, char delimiter) {
+    std::vector<std::string> result;
+    std::stringstream ss(str);
+    std::string token;
+    while (std::getline(ss, token, delimiter)) {
+        result.push_back(token);
+    }
+    return result;
+}
+
+#endif  // UNIQUEBUILD_IMPLEMENTATION
@@ -0,0 +1,580 @@
+/***************************************
+ * uniquebuild_table.h
+ * Columnar storage for User records: one contiguous array per field,
+ * vectorized predicate scans into selection bitmaps, and aggregations.
+ *
+ * Part of uniquebuild; see uniquebuild.h.
+ ***************************************/
+
+#ifndef UNIQUEBUILD_TABLE_H
+#define UNIQUEBUILD_TABLE_H
+
+#include "uniquebuild_core.h"
+#include "uniquebuild_cpu.h"
+#include "uniquebuild_math.h"
+#include "uniquebuild_memory.h"
+#include "uniquebuild_records.h"
+
+#include <array>  // Required for std::array
+
+/**
+ * USER_ROLE_COUNT: Number of UserRole values; roles are stored as bytes.
+ */
+#define USER_ROLE_COUNT (ROLE_VIEWER + 1)
+
+/***************************************
+ * SECTION: Selection Bitmaps
+ * One bit per row, 64 rows per word. Bits past the last row are always
+ * zero, so counts and combinations need no masking.
+ ***************************************/
+
+namespace UniqueBuild {
+
+/**
+ * @namespace Columnar
+ * Structure-of-arrays tables and scans over them.
+ */
+namespace Columnar {
+
+namespace detail {
+
+inline size_t popCount64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return size_t(__builtin_popcountll(x));
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return size_t((x * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+}  // namespace detail
+
+/**
+ * @class SelectionBitmap
+ * The rows a predicate selected.
+ */
+class SelectionBitmap {
+public:
+    SelectionBitmap() : size_(0) {}
+
+    /**
+     * @param size: Number of rows.
+     * @param value: Initial state of every bit.
+     */
+    explicit SelectionBitmap(size_t size, bool value = false) : size_(size), words_((size + 63) / 64, value ? ~0ull : 0) {
+        trim();
+    }
+
+    size_t size() const { return size_; }
+    size_t wordCount() const { return words_.size(); }
+    uint64_t* words() { return words_.data(); }
+    const uint64_t* words() const { return words_.data(); }
+
+    bool test(size_t row) const { return (words_[row >> 6] >> (row & 63)) & 1; }
+    void set(size_t row) { words_[row >> 6] |= 1ull << (row & 63); }
+    void reset(size_t row) { words_[row >> 6] &= ~(1ull << (row & 63)); }
+
+    /**
+     * @return: Number of selected rows.
+     */
+    size_t count() const {
+        size_t total = 0;
+        for (uint64_t word : words_) total += detail::popCount64(word);
+        return total;
+    }
+
+    SelectionBitmap& operator&=(const SelectionBitmap& other) {
+        for (size_t i = 0; i < words_.size(); ++i) words_[i] &= other.words_[i];
+        return *this;
+    }
+
+    SelectionBitmap& operator|=(const SelectionBitmap& other) {
+        for (size_t i = 0; i < words_.size(); ++i) words_[i] |= other.words_[i];
+        return *this;
+    }
+
+    /**
+     * Removes the rows selected in other.
+     */
+    SelectionBitmap& subtract(const SelectionBitmap& other) {
+        for (size_t i = 0; i < words_.size(); ++i) words_[i] &= ~other.words_[i];
+        return *this;
+    }
+
+    /**
+     * Selects exactly the rows that were not selected.
+     */
+    SelectionBitmap& invert() {
+        for (uint64_t& word : words_) word = ~word;
+        trim();
+        return *this;
+    }
+
+    /**
+     * Calls fn(row) for every selected row in ascending order.
+     */
+    template <typename F>
+    void forEach(F&& fn) const {
+        for (size_t w = 0; w < words_.size(); ++w) {
+            for (uint64_t word = words_[w]; word; word &= word - 1) {
+                fn(w * 64 + size_t(MathUtils::detail::countTrailingZeros64(word)));
+            }
+        }
+    }
+
+    /**
+     * @return: The selected rows in ascending order.
+     */
+    std::vector<uint32_t> indices() const {
+        std::vector<uint32_t> out;
+        out.reserve(count());
+        forEach([&out](size_t row) { out.push_back(uint32_t(row)); });
+        return out;
+    }
+
+    /**
+     * Clears the bits past the last row.
+     */
+    void trim() {
+        if (size_ & 63) words_.back() &= (1ull << (size_ & 63)) - 1;
+    }
+
+private:
+    size_t size_;  // Number of rows
+    Memory::AlignedVector<uint64_t> words_;  // 64 rows per word
+};
+
+inline SelectionBitmap operator&(SelectionBitmap a, const SelectionBitmap& b) { return a &= b; }
+inline SelectionBitmap operator|(SelectionBitmap a, const SelectionBitmap& b) { return a |= b; }
+
+}  // namespace Columnar
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: Scan Kernels
+ * Each kernel fills whole bitmap words [firstWord, lastWord) from a
+ * column. Tables split large scans into word ranges and run them with
+ * Parallel::forChunks.
+ ***************************************/
+
+namespace UniqueBuild {
+
+namespace Columnar {
+
+namespace detail {
+
+/**
+ * Rows with lo <= value <= hi, as (uint32)(value - lo) <= (uint32)(hi - lo).
+ */
+inline void scanRangeScalar(const int32_t* values, size_t count, int32_t lo, int32_t hi, uint64_t* words,
+                            size_t firstWord, size_t lastWord) {
+    const uint32_t span = uint32_t(hi) - uint32_t(lo);
+    for (size_t w = firstWord; w < lastWord; ++w) {
+        const size_t begin = w * 64;
+        const size_t end = MIN(begin + 64, count);
+        uint64_t word = 0;
+        for (size_t i = begin; i < end; ++i) {
+            word |= uint64_t(uint32_t(values[i]) - uint32_t(lo) <= span) << (i - begin);
+        }
+        words[w] = word;
+    }
+}
+
+inline void scanEqualScalar(const uint8_t* values, size_t count, uint8_t key, uint64_t* words, size_t firstWord,
+                            size_t lastWord) {
+    for (size_t w = firstWord; w < lastWord; ++w) {
+        const size_t begin = w * 64;
+        const size_t end = MIN(begin + 64, count);
+        uint64_t word = 0;
+        for (size_t i = begin; i < end; ++i) {
+            word |= uint64_t(values[i] == key) << (i - begin);
+        }
+        words[w] = word;
+    }
+}
+
+inline int64_t sumSelectedScalar(const int32_t* values, const uint64_t* words, size_t firstWord, size_t lastWord) {
+    int64_t sum = 0;
+    for (size_t w = firstWord; w < lastWord; ++w) {
+        for (uint64_t word = words[w]; word; word &= word - 1) {
+            sum += values[w * 64 + size_t(MathUtils::detail::countTrailingZeros64(word))];
+        }
+    }
+    return sum;
+}
+
+#ifdef UNIQUEBUILD_X86_DISPATCH
+UNIQUEBUILD_TARGET("avx2")
+inline void scanRangeAvx2(const int32_t* values, size_t count, int32_t lo, int32_t hi, uint64_t* words,
+                          size_t firstWord, size_t lastWord) {
+    const __m256i bias = _mm256_set1_epi32(int32_t(0x80000000u));
+    const __m256i low = _mm256_set1_epi32(lo);
+    const __m256i limit = _mm256_set1_epi32(int32_t((uint32_t(hi) - uint32_t(lo)) ^ 0x80000000u));
+    const size_t fullWords = MIN(lastWord, count / 64);
+    size_t w = firstWord;
+    for (; w < fullWords; ++w) {
+        const int32_t* p = values + w * 64;
+        uint64_t word = 0;
+        for (int k = 0; k < 8; ++k) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 8 * k));
+            const __m256i shifted = _mm256_xor_si256(_mm256_sub_epi32(v, low), bias);
+            const __m256i outside = _mm256_cmpgt_epi32(shifted, limit);
+            const uint32_t bits = ~uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(outside))) & 0xFFu;
+            word |= uint64_t(bits) << (8 * k);
+        }
+        words[w] = word;
+    }
+    if (w < lastWord) scanRangeScalar(values, count, lo, hi, words, w, lastWord);
+}
+
+UNIQUEBUILD_TARGET("avx2")
+inline void scanEqualAvx2(const uint8_t* values, size_t count, uint8_t key, uint64_t* words, size_t firstWord,
+                          size_t lastWord) {
+    const __m256i needle = _mm256_set1_epi8(char(key));
+    const size_t fullWords = MIN(lastWord, count / 64);
+    size_t w = firstWord;
+    for (; w < fullWords; ++w) {
+        const uint8_t* p = values + w * 64;
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+        const uint32_t lowBits = uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, needle)));
+        const uint32_t highBits = uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(b, needle)));
+        words[w] = uint64_t(lowBits) | (uint64_t(highBits) << 32);
+    }
+    if (w < lastWord) scanEqualScalar(values, count, key, words, w, lastWord);
+}
+
+/**
+ * Sums the selected values, expanding each byte of a bitmap word into an
+ * eight-lane mask. Sparse words fall back to visiting the set bits.
+ */
+UNIQUEBUILD_TARGET("avx2")
+inline int64_t sumSelectedAvx2(const int32_t* values, size_t count, const uint64_t* words, size_t firstWord,
+                               size_t lastWord) {
+    const __m256i laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    __m256i sum = _mm256_setzero_si256();
+    int64_t tail = 0;
+    const size_t fullWords = MIN(lastWord, count / 64);
+    size_t w = firstWord;
+    for (; w < fullWords; ++w) {
+        const uint64_t word = words[w];
+        if (word == 0) continue;
+        if (detail::popCount64(word) < 8) {
+            tail += sumSelectedScalar(values, words, w, w + 1);
+            continue;
+        }
+        const int32_t* p = values + w * 64;
+        for (int k = 0; k < 8; ++k) {
+            const __m256i byte = _mm256_set1_epi32(int32_t((word >> (8 * k)) & 0xFF));
+            const __m256i mask = _mm256_cmpeq_epi32(_mm256_and_si256(byte, laneBits), laneBits);
+            const __m256i v = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 8 * k)), mask);
+            sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+            sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+        }
+    }
+    alignas(32) int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), sum);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + tail + sumSelectedScalar(values, words, w, lastWord);
+}
+#endif
+
+#ifdef UNIQUEBUILD_NEON
+inline void scanRangeNeon(const int32_t* values, size_t count, int32_t lo, int32_t hi, uint64_t* words,
+                          size_t firstWord, size_t lastWord) {
+    const int32x4_t low = vdupq_n_s32(lo);
+    const uint32x4_t span = vdupq_n_u32(uint32_t(hi) - uint32_t(lo));
+    const uint32_t weightValues[4] = {1, 2, 4, 8};
+    const uint32x4_t weights = vld1q_u32(weightValues);
+    const size_t fullWords = MIN(lastWord, count / 64);
+    size_t w = firstWord;
+    for (; w < fullWords; ++w) {
+        const int32_t* p = values + w * 64;
+        uint64_t word = 0;
+        for (int k = 0; k < 16; ++k) {
+            const uint32x4_t offset = vreinterpretq_u32_s32(vsubq_s32(vld1q_s32(p + 4 * k), low));
+            const uint32x4_t inside = vandq_u32(vcleq_u32(offset, span), weights);
+            word |= uint64_t(vaddvq_u32(inside)) << (4 * k);
+        }
+        words[w] = word;
+    }
+    if (w < lastWord) scanRangeScalar(values, count, lo, hi, words, w, lastWord);
+}
+#endif
+
+inline void scanRange(const int32_t* values, size_t count, int32_t lo, int32_t hi, uint64_t* words,
+                      size_t firstWord, size_t lastWord) {
+#ifdef UNIQUEBUILD_X86_DISPATCH
+    if (Cpu::hasAvx2()) return scanRangeAvx2(values, count, lo, hi, words, firstWord, lastWord);
+#endif
+#ifdef UNIQUEBUILD_NEON
+    return scanRangeNeon(values, count, lo, hi, words, firstWord, lastWord);
+#else
+    scanRangeScalar(values, count, lo, hi, words, firstWord, lastWord);
+#endif
+}
+
+inline void scanEqual(const uint8_t* values, size_t count, uint8_t key, uint64_t* words, size_t firstWord,
+                      size_t lastWord) {
+#ifdef UNIQUEBUILD_X86_DISPATCH
+    if (Cpu::hasAvx2()) return scanEqualAvx2(values, count, key, words, firstWord, lastWord);
+#endif
+    scanEqualScalar(values, count, key, words, firstWord, lastWord);
+}
+
+inline int64_t sumSelected(const int32_t* values, size_t count, const uint64_t* words, size_t firstWord,
+                           size_t lastWord) {
+#ifdef UNIQUEBUILD_X86_DISPATCH
+    if (Cpu::hasAvx2()) return sumSelectedAvx2(values, count, words, firstWord, lastWord);
+#else
+    (void)count;
+#endif
+    return sumSelectedScalar(values, words, firstWord, lastWord);
+}
+
+/**
+ * Histogram of the byte values in rows [begin, end).
+ */
+inline void countValues(const uint8_t* values, size_t begin, size_t end, size_t* bins) {
+    for (size_t i = begin; i < end; ++i) ++bins[values[i]];
+}
+
+/**
+ * Histogram of the byte values in the rows selected by words [firstWord, lastWord).
+ */
+inline void countSelected(const uint8_t* values, const uint64_t* words, size_t firstWord, size_t lastWord,
+                          size_t* bins) {
+    for (size_t w = firstWord; w < lastWord; ++w) {
+        for (uint64_t word = words[w]; word; word &= word - 1) {
+            ++bins[values[w * 64 + size_t(MathUtils::detail::countTrailingZeros64(word))]];
+        }
+    }
+}
+
+}  // namespace detail
+
+}  // namespace Columnar
+
+}  // namespace UniqueBuild
+
+/***************************************
+ * SECTION: User Table
+ * Users as columns: ids, ages and roles in contiguous arrays and names
+ * in one string heap, so a filter on age or role reads four or one
+ * bytes per user instead of a whole struct with its std::string.
+ ***************************************/
+
+namespace UniqueBuild {
+
+namespace Columnar {
+
+/**
+ * @enum AgeCompare
+ * Comparisons accepted by UserTable::whereAge.
+ */
+enum class AgeCompare {
+    LESS,
+    LESS_EQUAL,
+    EQUAL,
+    NOT_EQUAL,
+    GREATER_EQUAL,
+    GREATER
+};
+
+/**
+ * @class UserTable
+ * A column store of users and their roles.
+ */
+class UserTable {
+public:
+    UserTable() : nameOffsets_(1, 0) {}
+
+    size_t size() const { return ids_.size(); }
+
+    void reserve(size_t rows, size_t nameBytes = 0) {
+        ids_.reserve(rows);
+        ages_.reserve(rows);
+        roles_.reserve(rows);
+        nameOffsets_.reserve(rows + 1);
+        names_.reserve(nameBytes);
+    }
+
+    void clear() {
+        ids_.clear();
+        ages_.clear();
+        roles_.clear();
+        nameOffsets_.assign(1, 0);
+        names_.clear();
+    }
+
+    /**
+     * Appends a row.
+     */
+    void add(int id, std::string_view name, int age, UserRole role) {
+        ids_.push_back(int32_t(id));
+        ages_.push_back(int32_t(age));
+        roles_.push_back(uint8_t(role));
+        names_.append(name.data(), name.size());
+        nameOffsets_.push_back(names_.size());
+    }
+
+    void add(const User& user, UserRole role) { add(user.id, user.name, user.age, role); }
+
+    /**
+     * Appends every user of a record file without building User structs.
+     * @param records: An open record file.
+     * @param role: Role of the appended users; record files do not store one.
+     */
+    void append(const Records::RecordReader<User>& records, UserRole role) {
+        reserve(size() + records.size());
+        for (size_t i = 0; i < records.size(); ++i) {
+            const Records::RecordSchema<User>::View view = records.view(i);
+            add(view.id(), view.name, view.age(), role);
+        }
+    }
+
+    int32_t id(size_t row) const { return ids_[row]; }
+    int32_t age(size_t row) const { return ages_[row]; }
+    UserRole role(size_t row) const { return UserRole(roles_[row]); }
+
+    std::string_view name(size_t row) const {
+        return std::string_view(names_.data() + nameOffsets_[row], size_t(nameOffsets_[row + 1] - nameOffsets_[row]));
+    }
+
+    User user(size_t row) const { return User{ids_[row], std::string(name(row)), ages_[row]}; }
+
+    void setRole(size_t row, UserRole role) { roles_[row] = uint8_t(role); }
+
+    const int32_t* ids() const { return ids_.data(); }
+    const int32_t* ages() const { return ages_.data(); }
+    const uint8_t* roles() const { return roles_.data(); }
+
+    /**
+     * @return: Rows with lo <= age <= hi.
+     */
+    SelectionBitmap whereAgeBetween(int32_t lo, int32_t hi) const {
+        SelectionBitmap out(size());
+        if (lo > hi) return out;
+        const int32_t* ages = ages_.data();
+        const size_t count = size();
+        uint64_t* words = out.words();
+        Parallel::forChunks(out.wordCount(), PARALLEL_MIN_CHUNK / 64, [=](size_t, size_t begin, size_t end) {
+            detail::scanRange(ages, count, lo, hi, words, begin, end);
+        });
+        return out;
+    }
+
+    /**
+     * @return: Rows whose age compares to value as requested.
+     */
+    SelectionBitmap whereAge(AgeCompare compare, int32_t value) const {
+        const int32_t lowest = INT32_MIN;
+        const int32_t highest = INT32_MAX;
+        switch (compare) {
+            case AgeCompare::LESS:
+                return value == lowest ? SelectionBitmap(size()) : whereAgeBetween(lowest, value - 1);
+            case AgeCompare::LESS_EQUAL:
+                return whereAgeBetween(lowest, value);
+            case AgeCompare::EQUAL:
+                return whereAgeBetween(value, value);
+            case AgeCompare::NOT_EQUAL:
+                return whereAgeBetween(value, value).invert();
+            case AgeCompare::GREATER_EQUAL:
+                return whereAgeBetween(value, highest);
+            case AgeCompare::GREATER:
+                return value == highest ? SelectionBitmap(size()) : whereAgeBetween(value + 1, highest);
+        }
+        return SelectionBitmap(size());
+    }
+
+    /**
+     * @return: Rows with the given role.
+     */
+    SelectionBitmap whereRole(UserRole role) const {
+        SelectionBitmap out(size());
+        const uint8_t* roles = roles_.data();
+        const size_t count = size();
+        uint64_t* words = out.words();
+        Parallel::forChunks(out.wordCount(), PARALLEL_MIN_CHUNK / 64, [=](size_t, size_t begin, size_t end) {
+            detail::scanEqual(roles, count, uint8_t(role), words, begin, end);
+        });
+        return out;
+    }
+
+    /**
+     * Counts users per role.
+     * @param selection: Optional; only selected rows are counted.
+     * @return: Counts indexed by UserRole.
+     */
+    std::array<size_t, USER_ROLE_COUNT> countByRole(const SelectionBitmap* selection = nullptr) const {
+        // One pass over the role bytes; bins cover every byte value, so the
+        // loop needs no range check.
+        const uint8_t* roles = roles_.data();
+        std::array<std::array<size_t, 256>, THREAD_POOL_SIZE> partial = {};
+        if (selection) {
+            const uint64_t* words = selection->words();
+            Parallel::forChunks(selection->wordCount(), PARALLEL_MIN_CHUNK / 64,
+                                [&partial, roles, words](size_t chunk, size_t begin, size_t end) {
+                detail::countSelected(roles, words, begin, end, partial[chunk].data());
+            });
+        } else {
+            Parallel::forChunks(size(), PARALLEL_MIN_CHUNK, [&partial, roles](size_t chunk, size_t begin, size_t end) {
+                detail::countValues(roles, begin, end, partial[chunk].data());
+            });
+        }
+        std::array<size_t, USER_ROLE_COUNT> counts = {};
+        for (const std::array<size_t, 256>& bins : partial) {
+            for (size_t role = 0; role < USER_ROLE_COUNT; ++role) counts[role] += bins[role];
+        }
+        return counts;
+    }
+
+    /**
+     * @param selection: Optional; only selected rows are summed.
+     */
+    int64_t sumAge(const SelectionBitmap* selection = nullptr) const {
+        const int32_t* ages = ages_.data();
+        const size_t count = size();
+        std::array<int64_t, THREAD_POOL_SIZE> partial = {};
+        if (selection) {
+            const uint64_t* words = selection->words();
+            Parallel::forChunks(selection->wordCount(), PARALLEL_MIN_CHUNK / 64,
+                                [&partial, ages, count, words](size_t chunk, size_t begin, size_t end) {
+                partial[chunk] = detail::sumSelected(ages, count, words, begin, end);
+            });
+        } else {
+            Parallel::forChunks(count, PARALLEL_MIN_CHUNK, [&partial, ages](size_t chunk, size_t begin, size_t end) {
+                int64_t sum = 0;
+                for (size_t i = begin; i < end; ++i) sum += ages[i];
+                partial[chunk] = sum;
+            });
+        }
+        int64_t total = 0;
+        for (int64_t sum : partial) total += sum;
+        return total;
+    }
+
+    /**
+     * @param selection: Optional; only selected rows are averaged.
+     * @return: The mean age, or 0 if no rows are selected.
+     */
+    double averageAge(const SelectionBitmap* selection = nullptr) const {
+        const size_t rows = selection ? selection->count() : size();
+        return rows == 0 ? 0.0 : double(sumAge(selection)) / double(rows);
+    }
+
+private:
+    Memory::AlignedVector<int32_t> ids_;  // User ids
+    Memory::AlignedVector<int32_t> ages_;  // User ages
+    Memory::AlignedVector<uint8_t> roles_;  // UserRole per row
+    std::vector<uint64_t> nameOffsets_;  // Start of each name in names_, plus the end
+    std::string names_;  // All names back to back
+};
+
+}  // namespace Columnar
+
+}  // namespace UniqueBuild
+
+#endif  // UNIQUEBUILD_TABLE_H
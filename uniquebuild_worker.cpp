@@ -0,0 +1,20 @@
+/***************************************
+ * uniquebuild_worker.cpp
+ * The bundled remote-execution worker. Runs the actions a build sends
+ * it; start one next to a build to exercise the protocol on a single
+ * machine:
+ *
+ *   $ c++ -std=c++17 -pthread uniquebuild_worker.cpp -o uniquebuild-worker
+ *   $ ./uniquebuild-worker --listen tcp:127.0.0.1:7070
+ *
+ * Warning: the worker runs any command a client sends, as the user that
+ * started it, and does not authenticate clients. Listen on a Unix socket
+ * or on 127.0.0.1 only; never bind it to a public interface.
+ ***************************************/
+
+#define UNIQUEBUILD_IMPLEMENTATION
+#include "uniquebuild_remote.h"
+
+int main(int argc, char** argv) {
+    return UniqueBuild::Remote::runWorker(argc, argv);
+}